@@ -0,0 +1,587 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+
+#include <vtkActor.h>
+#include <vtkLookupTable.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkSMPTools.h>
+#include <vtkVersion.h>
+#include <vtkXMLUnstructuredGridReader.h>
+
+#ifdef _WIN32
+#include <windows.h>
+// windows.h must come first
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+#include "ArrayRangeCache.h"
+#include "ColorBufferCache.h"
+#include "DecodedModelCache.h"
+#include "PerfTrace.h"
+#include "SurfaceColoring.h"
+#include "SyntheticVtuGenerator.h"
+#include "VtuAppendedReader.h"
+#include "VtuHeaderScanner.h"
+#include "VtuModelLoader.h"
+
+namespace {
+// Phases in the order they run and are reported
+const QStringList phaseNames = {"scan",
+                                "readerUpdate",
+                                "ranges",
+                                "histogram",
+                                "load",
+                                "surfaceExtraction",
+                                "firstArrayDecode",
+                                "recolor",
+                                "recolorCached",
+                                "firstFrame",
+                                "cacheStore",
+                                "cacheOpen"};
+
+qint64 peakResidentSetBytes() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                            sizeof(counters))) {
+    return -1;
+  }
+  return static_cast<qint64>(counters.PeakWorkingSetSize);
+#else
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return -1;
+  }
+#ifdef __APPLE__
+  return static_cast<qint64>(usage.ru_maxrss); // Bytes
+#else
+  return static_cast<qint64>(usage.ru_maxrss) * 1024; // KiB
+#endif
+#endif
+}
+
+QJsonObject buildInfo() {
+  QJsonObject info;
+  info["vtkVersion"] = vtkVersion::GetVTKVersion();
+  info["qtVersion"] = qVersion();
+#if defined(__clang__)
+  info["compiler"] = QString("clang %1").arg(__clang_version__);
+#elif defined(__GNUC__)
+  info["compiler"] = QString("gcc %1").arg(__VERSION__);
+#elif defined(_MSC_VER)
+  info["compiler"] = QString("msvc %1").arg(_MSC_VER);
+#endif
+#ifdef NDEBUG
+  info["buildType"] = "release";
+#else
+  info["buildType"] = "debug";
+#endif
+  info["smpBackend"] = vtkSMPTools::GetBackend();
+  info["smpThreads"] = vtkSMPTools::GetEstimatedNumberOfThreads();
+  info["idealThreadCount"] = QThread::idealThreadCount();
+  info["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+  return info;
+}
+
+double elapsedMilliseconds(const QElapsedTimer &timer) {
+  return timer.nsecsElapsed() / 1.0e6;
+}
+
+// Runs every phase once on the file; phase times are in milliseconds
+bool runPhases(const QString &filePath, bool render, QJsonObject &phases,
+               QJsonObject &caseInfo, QString &errorMessage) {
+  const std::atomic_bool notCancelled(false);
+  const VtuModelLoader::ProgressCallback noProgress;
+  QElapsedTimer timer;
+
+  LoadedVtuModel model;
+  model.filePath = filePath;
+
+  timer.start();
+  if (!VtuHeaderScanner::scan(filePath, model.header, errorMessage)) {
+    return false;
+  }
+  phases["scan"] = elapsedMilliseconds(timer);
+
+  // The reader the loader would pick for this file
+  const bool appended = VtuAppendedReader::canRead(model.header);
+  timer.start();
+  if (appended) {
+    VtuAppendedReader appendedReader(filePath, model.header);
+    if (!appendedReader.open(errorMessage)) {
+      return false;
+    }
+    model.grid = appendedReader.readGrid(noProgress, notCancelled,
+                                         errorMessage);
+  } else {
+    vtkNew<vtkXMLUnstructuredGridReader> reader;
+    reader->SetFileName(filePath.toStdString().c_str());
+    reader->Update();
+    model.grid = reader->GetOutput();
+  }
+  if (model.grid == nullptr || model.grid->GetNumberOfPoints() == 0) {
+    if (errorMessage.isEmpty()) {
+      errorMessage = "Failed to read " + filePath;
+    }
+    return false;
+  }
+  phases["readerUpdate"] = elapsedMilliseconds(timer);
+  caseInfo["reader"] = appended ? "appended" : "xml";
+  caseInfo["points"] = static_cast<double>(model.grid->GetNumberOfPoints());
+  caseInfo["cells"] = static_cast<double>(model.grid->GetNumberOfCells());
+
+  vtkPointData *pointData = model.grid->GetPointData();
+  timer.start();
+  for (int i = 0; i < pointData->GetNumberOfArrays(); ++i) {
+    model.pointArrayRanges.compute(pointData->GetArray(i));
+  }
+  phases["ranges"] = elapsedMilliseconds(timer);
+
+  // Histogram of the first array, as for percentile clipping on selection
+  if (vtkDataArray *array = pointData->GetArray(0)) {
+    const int histogramComponent =
+        (array->GetNumberOfComponents() > 1) ? -1 : 0;
+    double histogramRange[2] = {0.0, 1.0};
+    model.pointArrayRanges.getRange(array, histogramComponent, histogramRange);
+    timer.start();
+    model.pointArrayHistograms.histogram(array, histogramComponent,
+                                         histogramRange);
+    phases["histogram"] = elapsedMilliseconds(timer);
+  }
+  model.grid = nullptr; // Freed before the loader reads its own
+
+  // End to end through the loader, lazily as the viewer loads: header,
+  // mesh and surface, but no point array yet
+  VtuLoadOptions loadOptions;
+  loadOptions.lazyPointArrays = true;
+  VtuModelLoader loader;
+  loader.setLoadOptions(loadOptions);
+  QScopedPointer<LoadedVtuModel> loadedModel;
+  QObject::connect(&loader, &VtuModelLoader::modelLoaded,
+                   [&loadedModel](LoadedVtuModel *loaded, const QString &) {
+                     loadedModel.reset(loaded);
+                   });
+  QObject::connect(&loader, &VtuModelLoader::modelLoadingErrorOccured,
+                   [&errorMessage](const QString &loadingErrorMessage) {
+                     errorMessage = loadingErrorMessage;
+                   });
+  PerfTrace::setEnabled(true);
+  PerfTrace::clear();
+  timer.start();
+  loader.load(filePath);
+  if (loadedModel == nullptr) {
+    return false;
+  }
+  phases["load"] = elapsedMilliseconds(timer);
+
+  // The loader's own trace times the surface extraction within the load
+  const QVector<PerfTraceEvent> surfaceEvents =
+      PerfTrace::recentEvents(1, [](const PerfTraceEvent &event) {
+        return std::strcmp(event.name, "Extract surface") == 0;
+      });
+  if (!surfaceEvents.isEmpty()) {
+    phases["surfaceExtraction"] = surfaceEvents.first().durationNs / 1.0e6;
+  }
+  caseInfo["surfacePoints"] =
+      static_cast<double>(loadedModel->surface->GetNumberOfPoints());
+
+  // The first selection decodes its array
+  if (loadedModel->pointArraysInfo.isEmpty()) {
+    errorMessage = "Benchmark file has no point arrays: " + filePath;
+    return false;
+  }
+  timer.start();
+  if (!VtuModelLoader::ensurePointArrayLoaded(*loadedModel, 0,
+                                              errorMessage)) {
+    return false;
+  }
+  phases["firstArrayDecode"] = elapsedMilliseconds(timer);
+
+  // Recolor by the first array, as the viewer does right after loading
+  const int componentIndex =
+      VtuModelLoader::hasMagnitudeOption(loadedModel->pointArraysInfo[0])
+          ? -1
+          : 0;
+  vtkNew<vtkLookupTable> lookupTable;
+  lookupTable->Build();
+  ColorBufferCache colorBufferCache;
+  vtkNew<vtkPolyData> coloredSurface;
+  coloredSurface->CopyStructure(loadedModel->surface);
+  double range[2] = {0.0, 1.0};
+  timer.start();
+  if (!SurfaceColoring::apply(*loadedModel, 0, componentIndex, lookupTable,
+                              "default", colorBufferCache, coloredSurface,
+                              PercentileRange(), range, errorMessage)) {
+    return false;
+  }
+  phases["recolor"] = elapsedMilliseconds(timer);
+  timer.start();
+  SurfaceColoring::apply(*loadedModel, 0, componentIndex, lookupTable,
+                         "default", colorBufferCache, coloredSurface,
+                         PercentileRange(), range, errorMessage);
+  phases["recolorCached"] = elapsedMilliseconds(timer);
+
+  if (render) {
+    vtkNew<vtkPolyDataMapper> mapper;
+    mapper->SetInputData(coloredSurface);
+    mapper->SetScalarModeToUsePointData();
+    mapper->SetColorModeToDirectScalars();
+    vtkNew<vtkActor> actor;
+    actor->SetMapper(mapper);
+    vtkNew<vtkRenderer> renderer;
+    renderer->AddActor(actor);
+    renderer->ResetCamera();
+    vtkNew<vtkRenderWindow> renderWindow;
+    renderWindow->SetOffScreenRendering(1);
+    renderWindow->SetSize(1280, 720);
+    renderWindow->AddRenderer(renderer);
+    timer.start();
+    renderWindow->Render();
+    phases["firstFrame"] = elapsedMilliseconds(timer);
+  }
+
+  // Decoded model cache round trip in a scratch directory; the entry holds
+  // the arrays decoded so far, as the viewer's would
+  QTemporaryDir cacheDirectory;
+  if (!cacheDirectory.isValid()) {
+    errorMessage = "Cannot create a scratch cache directory";
+    return false;
+  }
+  DecodedModelCache cache(cacheDirectory.path());
+  timer.start();
+  if (!cache.store(DecodedModelCache::snapshot(*loadedModel), notCancelled,
+                   errorMessage)) {
+    return false;
+  }
+  phases["cacheStore"] = elapsedMilliseconds(timer);
+  timer.start();
+  QScopedPointer<LoadedVtuModel> cachedModel(
+      cache.open(filePath, loadOptions, errorMessage));
+  if (cachedModel == nullptr) {
+    if (errorMessage.isEmpty()) {
+      errorMessage = "Decoded model cache entry was not found";
+    }
+    return false;
+  }
+  phases["cacheOpen"] = elapsedMilliseconds(timer);
+  return true;
+}
+
+// Runs the phases repeats times in this process and keeps the fastest time
+// of every phase
+int runCase(const QString &filePath, int repeats, bool render) {
+  QTextStream standardOutput(stdout);
+  QTextStream standardError(stderr);
+
+  QJsonObject bestPhases;
+  QJsonObject caseInfo;
+  for (int r = 0; r < repeats; ++r) {
+    QJsonObject phases;
+    QString errorMessage;
+    if (!runPhases(filePath, render, phases, caseInfo, errorMessage)) {
+      standardError << errorMessage << Qt::endl;
+      return 1;
+    }
+    for (auto it = phases.constBegin(); it != phases.constEnd(); ++it) {
+      const double best =
+          bestPhases.value(it.key()).toDouble(
+              std::numeric_limits<double>::max());
+      bestPhases[it.key()] = std::min(best, it.value().toDouble());
+    }
+  }
+  caseInfo["phasesMs"] = bestPhases;
+  caseInfo["peakRssBytes"] = static_cast<double>(peakResidentSetBytes());
+  standardOutput << QJsonDocument(caseInfo).toJson(QJsonDocument::Compact)
+                 << Qt::endl;
+  return 0;
+}
+
+QString csvLine(const QStringList &fields) {
+  QStringList quoted;
+  for (QString field : fields) {
+    if (field.contains(',') || field.contains('"')) {
+      field = '"' + field.replace("\"", "\"\"") + '"';
+    }
+    quoted.push_back(field);
+  }
+  return quoted.join(',');
+}
+
+bool writeResults(const QString &filePath, const QJsonObject &results,
+                  QString &errorMessage) {
+  QFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    errorMessage = "Cannot write results: " + filePath;
+    return false;
+  }
+  if (QFileInfo(filePath).suffix().compare("csv", Qt::CaseInsensitive) != 0) {
+    file.write(QJsonDocument(results).toJson(QJsonDocument::Indented));
+    return true;
+  }
+
+  // One row per case; build information is repeated so rows stand alone
+  QTextStream stream(&file);
+  const QJsonObject build = results["build"].toObject();
+  QStringList header = {"requestedCells", "arrays",     "components",
+                        "encoding",       "precision",  "fileBytes",
+                        "reader",         "points",     "cells",
+                        "surfacePoints",  "peakRssBytes"};
+  for (const QString &phaseName : phaseNames) {
+    header.push_back(phaseName + "Ms");
+  }
+  header << "vtkVersion" << "compiler" << "buildType" << "smpBackend"
+         << "smpThreads";
+  stream << csvLine(header) << '\n';
+  for (const QJsonValue &value : results["cases"].toArray()) {
+    const QJsonObject result = value.toObject();
+    const QJsonObject phases = result["phasesMs"].toObject();
+    QStringList row;
+    for (const QString &key :
+         {"requestedCells", "arrays", "components", "encoding", "precision",
+          "fileBytes", "reader", "points", "cells", "surfacePoints",
+          "peakRssBytes"}) {
+      row.push_back(result[key].toVariant().toString());
+    }
+    for (const QString &phaseName : phaseNames) {
+      row.push_back(phases.contains(phaseName)
+                        ? QString::number(phases[phaseName].toDouble(), 'f', 3)
+                        : QString());
+    }
+    for (const QString &key : {"vtkVersion", "compiler", "buildType",
+                               "smpBackend", "smpThreads"}) {
+      row.push_back(build[key].toVariant().toString());
+    }
+    stream << csvLine(row) << '\n';
+  }
+  return true;
+}
+
+QVector<int> parseIntegerList(const QString &text, bool &ok) {
+  QVector<int> values;
+  ok = true;
+  for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+    bool partOk = false;
+    values.push_back(part.trimmed().toInt(&partOk));
+    ok = ok && partOk && values.back() > 0;
+  }
+  ok = ok && !values.isEmpty();
+  return values;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  app.setApplicationName("VtkRendererBenchmark");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Times loading, coloring and rendering of synthetic VTU files.");
+  parser.addHelpOption();
+  QCommandLineOption cellsOption(
+      "cells", "Comma-separated cell counts (suffixes K and M allowed).",
+      "list", "10K,100K,1M");
+  QCommandLineOption arraysOption("arrays", "Point arrays per file.", "n",
+                                  "3");
+  QCommandLineOption componentsOption(
+      "components", "Comma-separated component counts, cycled over arrays.",
+      "list", "1,3");
+  QCommandLineOption encodingsOption(
+      "encodings", "Comma-separated encodings: ascii, binary, appended, zlib.",
+      "list", "appended,zlib");
+  QCommandLineOption precisionsOption(
+      "precisions", "Comma-separated value types: float32, float64.", "list",
+      "float64");
+  QCommandLineOption repeatOption("repeat",
+                                  "Runs per case; the fastest is kept.", "n",
+                                  "3");
+  QCommandLineOption workDirOption(
+      "work-dir", "Directory for generated files (reused across runs).", "dir",
+      QDir(QDir::tempPath()).filePath("VtkRendererBenchmark"));
+  QCommandLineOption outputOption(
+      {"o", "output"}, "Results file (.json or .csv).", "file",
+      "benchmark-results.json");
+  QCommandLineOption noRenderOption("no-render",
+                                    "Skip the offscreen first-frame phase.");
+  QCommandLineOption runCaseOption("run-case", "Benchmark one file.", "file");
+  runCaseOption.setFlags(QCommandLineOption::HiddenFromHelp);
+  parser.addOptions({cellsOption, arraysOption, componentsOption,
+                     encodingsOption, precisionsOption, repeatOption,
+                     workDirOption, outputOption, noRenderOption,
+                     runCaseOption});
+  parser.process(app);
+
+  QTextStream standardOutput(stdout);
+  QTextStream standardError(stderr);
+
+  bool repeatOk = false;
+  const int repeats = parser.value(repeatOption).toInt(&repeatOk);
+  if (!repeatOk || repeats <= 0) {
+    standardError << "Invalid repeat count" << Qt::endl;
+    return 2;
+  }
+  const bool render = !parser.isSet(noRenderOption);
+
+  // Child process: every case runs in a fresh process so its peak RSS is
+  // its own
+  if (parser.isSet(runCaseOption)) {
+    return runCase(parser.value(runCaseOption), repeats, render);
+  }
+
+  QVector<qint64> cellCounts;
+  for (QString part : parser.value(cellsOption).split(',', Qt::SkipEmptyParts)) {
+    part = part.trimmed().toUpper();
+    qint64 multiplier = 1;
+    if (part.endsWith('K')) {
+      multiplier = 1000;
+      part.chop(1);
+    } else if (part.endsWith('M')) {
+      multiplier = 1000 * 1000;
+      part.chop(1);
+    }
+    bool ok = false;
+    const qint64 cells = part.toLongLong(&ok) * multiplier;
+    if (!ok || cells <= 0) {
+      standardError << "Invalid cell count: " << part << Qt::endl;
+      return 2;
+    }
+    cellCounts.push_back(cells);
+  }
+  bool arraysOk = false;
+  const int numberOfArrays = parser.value(arraysOption).toInt(&arraysOk);
+  bool componentsOk = false;
+  const QVector<int> componentCounts =
+      parseIntegerList(parser.value(componentsOption), componentsOk);
+  if (!arraysOk || numberOfArrays <= 0 || !componentsOk) {
+    standardError << "Invalid array or component counts" << Qt::endl;
+    return 2;
+  }
+  const QStringList encodings =
+      parser.value(encodingsOption).split(',', Qt::SkipEmptyParts);
+  for (const QString &encoding : encodings) {
+    if (!SyntheticVtuGenerator::isValidEncoding(encoding)) {
+      standardError << "Unknown encoding: " << encoding << Qt::endl;
+      return 2;
+    }
+  }
+  const QStringList precisions =
+      parser.value(precisionsOption).split(',', Qt::SkipEmptyParts);
+  for (const QString &precision : precisions) {
+    if (precision != "float32" && precision != "float64") {
+      standardError << "Unknown precision: " << precision << Qt::endl;
+      return 2;
+    }
+  }
+  const QString workDirectory = parser.value(workDirOption);
+  if (!QDir().mkpath(workDirectory)) {
+    standardError << "Cannot create work directory: " << workDirectory
+                  << Qt::endl;
+    return 2;
+  }
+
+  QJsonArray cases;
+  int failedCases = 0;
+  for (qint64 cells : cellCounts) {
+    for (const QString &encoding : encodings) {
+      for (const QString &precision : precisions) {
+        SyntheticVtuOptions options;
+        options.numberOfCells = cells;
+        options.numberOfArrays = numberOfArrays;
+        options.componentCounts = componentCounts;
+        options.encoding = encoding;
+        options.doublePrecision = (precision == "float64");
+
+        // Generated files are kept; large ones take long to write
+        const QString filePath =
+            QDir(workDirectory).filePath(options.fileName());
+        if (!QFileInfo::exists(filePath)) {
+          standardOutput << "Generating " << filePath << Qt::endl;
+          QString errorMessage;
+          if (!SyntheticVtuGenerator::write(options, filePath, errorMessage)) {
+            standardError << errorMessage << Qt::endl;
+            ++failedCases;
+            continue;
+          }
+        }
+
+        QStringList arguments = {"--run-case", filePath, "--repeat",
+                                 QString::number(repeats)};
+        if (!render) {
+          arguments.push_back("--no-render");
+        }
+        QProcess caseProcess;
+        caseProcess.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        caseProcess.start(app.applicationFilePath(), arguments);
+        caseProcess.waitForFinished(-1);
+        const QJsonDocument caseDocument =
+            QJsonDocument::fromJson(caseProcess.readAllStandardOutput());
+        if (caseProcess.exitStatus() != QProcess::NormalExit ||
+            caseProcess.exitCode() != 0 || !caseDocument.isObject()) {
+          standardError << "Case failed: " << filePath << Qt::endl;
+          ++failedCases;
+          continue;
+        }
+
+        QJsonObject result = caseDocument.object();
+        result["requestedCells"] = static_cast<double>(cells);
+        result["arrays"] = numberOfArrays;
+        result["components"] = parser.value(componentsOption);
+        result["encoding"] = encoding;
+        result["precision"] = precision;
+        result["fileBytes"] = static_cast<double>(QFileInfo(filePath).size());
+        result["file"] = filePath;
+        cases.push_back(result);
+
+        const QJsonObject phases = result["phasesMs"].toObject();
+        QStringList summary;
+        for (const QString &phaseName : phaseNames) {
+          if (phases.contains(phaseName)) {
+            summary.push_back(QString("%1 %2 ms")
+                                  .arg(phaseName)
+                                  .arg(phases[phaseName].toDouble(), 0, 'f',
+                                       1));
+          }
+        }
+        standardOutput << options.fileName() << ": " << summary.join(", ")
+                       << ", peak RSS "
+                       << result["peakRssBytes"].toDouble() / (1024 * 1024)
+                       << " MiB" << Qt::endl;
+      }
+    }
+  }
+
+  QJsonObject results;
+  results["build"] = buildInfo();
+  results["cases"] = cases;
+  QString errorMessage;
+  if (!writeResults(parser.value(outputOption), results, errorMessage)) {
+    standardError << errorMessage << Qt::endl;
+    return 1;
+  }
+  standardOutput << "Results written to " << parser.value(outputOption)
+                 << Qt::endl;
+  return (failedCases == 0) ? 0 : 1;
+}
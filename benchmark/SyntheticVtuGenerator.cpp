@@ -0,0 +1,210 @@
+#include "SyntheticVtuGenerator.h"
+
+#include <QStringList>
+
+#include <vtkAOSDataArrayTemplate.h>
+#include <vtkCellArray.h>
+#include <vtkCellType.h>
+#include <vtkIdTypeArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkXMLUnstructuredGridWriter.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+struct Lattice {
+  vtkIdType cellsX = 1;
+  vtkIdType cellsY = 1;
+  vtkIdType cellsZ = 1;
+
+  vtkIdType pointsX() const { return cellsX + 1; }
+  vtkIdType pointsY() const { return cellsY + 1; }
+  vtkIdType pointsZ() const { return cellsZ + 1; }
+  vtkIdType numberOfPoints() const {
+    return pointsX() * pointsY() * pointsZ();
+  }
+  vtkIdType numberOfCells() const { return cellsX * cellsY * cellsZ; }
+};
+
+// Near-cubic lattice with at least the requested number of cells
+Lattice makeLattice(qint64 numberOfCells) {
+  Lattice lattice;
+  const double cubeRoot = std::cbrt(static_cast<double>(numberOfCells));
+  const vtkIdType side =
+      std::max<vtkIdType>(1, static_cast<vtkIdType>(cubeRoot));
+  lattice.cellsX = side;
+  lattice.cellsY = side;
+  lattice.cellsZ = std::max<vtkIdType>(
+      1, (numberOfCells + side * side - 1) / (side * side));
+  return lattice;
+}
+
+template <typename ValueT>
+vtkSmartPointer<vtkDataArray> makePoints(const Lattice &lattice) {
+  auto coordinates = vtkSmartPointer<vtkAOSDataArrayTemplate<ValueT>>::New();
+  coordinates->SetNumberOfComponents(3);
+  coordinates->SetNumberOfTuples(lattice.numberOfPoints());
+  ValueT *values = coordinates->GetPointer(0);
+  const vtkIdType pointsX = lattice.pointsX();
+  const vtkIdType pointsXY = pointsX * lattice.pointsY();
+  vtkSMPTools::For(0, lattice.numberOfPoints(),
+                   [&](vtkIdType begin, vtkIdType end) {
+                     for (vtkIdType p = begin; p < end; ++p) {
+                       values[3 * p] = static_cast<ValueT>(p % pointsX);
+                       values[3 * p + 1] =
+                           static_cast<ValueT>((p % pointsXY) / pointsX);
+                       values[3 * p + 2] = static_cast<ValueT>(p / pointsXY);
+                     }
+                   });
+  return coordinates;
+}
+
+template <typename ValueT>
+vtkSmartPointer<vtkDataArray> makeField(const QString &name,
+                                        int numberOfComponents,
+                                        int arrayIndex, vtkDataArray *points) {
+  auto field = vtkSmartPointer<vtkAOSDataArrayTemplate<ValueT>>::New();
+  field->SetName(name.toStdString().c_str());
+  field->SetNumberOfComponents(numberOfComponents);
+  field->SetNumberOfTuples(points->GetNumberOfTuples());
+  ValueT *values = field->GetPointer(0);
+  const double frequency = 0.05 * (arrayIndex + 1);
+  vtkSMPTools::For(
+      0, points->GetNumberOfTuples(), [&](vtkIdType begin, vtkIdType end) {
+        double xyz[3];
+        for (vtkIdType p = begin; p < end; ++p) {
+          points->GetTuple(p, xyz);
+          for (int c = 0; c < numberOfComponents; ++c) {
+            const double value =
+                std::sin(frequency * xyz[0] + c) *
+                    std::cos(frequency * xyz[1]) +
+                0.01 * (c + 1) * xyz[2];
+            values[p * numberOfComponents + c] = static_cast<ValueT>(value);
+          }
+        }
+      });
+  return field;
+}
+} // namespace
+
+QString SyntheticVtuOptions::fileName() const {
+  QStringList components;
+  for (int componentCount : componentCounts) {
+    components.push_back(QString::number(componentCount));
+  }
+  return QString("synthetic_%1cells_%2arrays_c%3_%4_%5.vtu")
+      .arg(numberOfCells)
+      .arg(numberOfArrays)
+      .arg(components.join('-'))
+      .arg(encoding)
+      .arg(doublePrecision ? "float64" : "float32");
+}
+
+bool SyntheticVtuGenerator::isValidEncoding(const QString &encoding) {
+  return encoding == "ascii" || encoding == "binary" ||
+         encoding == "appended" || encoding == "zlib";
+}
+
+vtkSmartPointer<vtkUnstructuredGrid>
+SyntheticVtuGenerator::generateGrid(const SyntheticVtuOptions &options) {
+  const Lattice lattice = makeLattice(options.numberOfCells);
+
+  vtkSmartPointer<vtkDataArray> coordinates =
+      options.doublePrecision ? makePoints<double>(lattice)
+                              : makePoints<float>(lattice);
+  vtkNew<vtkPoints> points;
+  points->SetData(coordinates);
+
+  // Hexahedra in VTK corner order
+  const vtkIdType numberOfCells = lattice.numberOfCells();
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfTuples(numberOfCells + 1);
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfTuples(8 * numberOfCells);
+  vtkNew<vtkUnsignedCharArray> cellTypes;
+  cellTypes->SetNumberOfTuples(numberOfCells);
+
+  vtkIdType *offsetValues = offsets->GetPointer(0);
+  vtkIdType *connectivityValues = connectivity->GetPointer(0);
+  unsigned char *typeValues = cellTypes->GetPointer(0);
+  const vtkIdType cellsX = lattice.cellsX;
+  const vtkIdType cellsXY = cellsX * lattice.cellsY;
+  const vtkIdType pointsX = lattice.pointsX();
+  const vtkIdType pointsXY = pointsX * lattice.pointsY();
+  vtkSMPTools::For(0, numberOfCells, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType cell = begin; cell < end; ++cell) {
+      const vtkIdType i = cell % cellsX;
+      const vtkIdType j = (cell % cellsXY) / cellsX;
+      const vtkIdType k = cell / cellsXY;
+      const vtkIdType base = i + j * pointsX + k * pointsXY;
+      vtkIdType *ids = connectivityValues + 8 * cell;
+      ids[0] = base;
+      ids[1] = base + 1;
+      ids[2] = base + 1 + pointsX;
+      ids[3] = base + pointsX;
+      ids[4] = base + pointsXY;
+      ids[5] = base + 1 + pointsXY;
+      ids[6] = base + 1 + pointsX + pointsXY;
+      ids[7] = base + pointsX + pointsXY;
+      offsetValues[cell] = 8 * cell;
+      typeValues[cell] = VTK_HEXAHEDRON;
+    }
+  });
+  offsetValues[numberOfCells] = 8 * numberOfCells;
+
+  vtkNew<vtkCellArray> cells;
+  cells->SetData(offsets, connectivity);
+
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+      vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points);
+  grid->SetCells(cellTypes, cells);
+
+  for (int a = 0; a < options.numberOfArrays; ++a) {
+    const QVector<int> &counts = options.componentCounts;
+    const int numberOfComponents =
+        counts.isEmpty() ? 1 : std::max(1, counts[a % counts.size()]);
+    const QString name = QString("Field%1").arg(a);
+    grid->GetPointData()->AddArray(
+        options.doublePrecision
+            ? makeField<double>(name, numberOfComponents, a, coordinates)
+            : makeField<float>(name, numberOfComponents, a, coordinates));
+  }
+  return grid;
+}
+
+bool SyntheticVtuGenerator::write(const SyntheticVtuOptions &options,
+                                  const QString &filePath,
+                                  QString &errorMessage) {
+  if (!isValidEncoding(options.encoding)) {
+    errorMessage = "Unknown encoding: " + options.encoding;
+    return false;
+  }
+  vtkSmartPointer<vtkUnstructuredGrid> grid = generateGrid(options);
+
+  vtkNew<vtkXMLUnstructuredGridWriter> writer;
+  writer->SetFileName(filePath.toStdString().c_str());
+  writer->SetInputData(grid);
+  writer->SetCompressorTypeToNone();
+  if (options.encoding == "ascii") {
+    writer->SetDataModeToAscii();
+  } else if (options.encoding == "binary") {
+    writer->SetDataModeToBinary();
+  } else {
+    writer->SetDataModeToAppended();
+    writer->EncodeAppendedDataOff();
+    if (options.encoding == "zlib") {
+      writer->SetCompressorTypeToZLib();
+    }
+  }
+  if (writer->Write() == 0) {
+    errorMessage = "Failed to write synthetic VTU file:\n" + filePath;
+    return false;
+  }
+  return true;
+}
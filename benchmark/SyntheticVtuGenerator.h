@@ -0,0 +1,36 @@
+#ifndef SYNTHETIC_VTU_GENERATOR_H
+#define SYNTHETIC_VTU_GENERATOR_H
+
+#include <QString>
+#include <QVector>
+
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+
+struct SyntheticVtuOptions {
+  qint64 numberOfCells = 10000; // Rounded to a hexahedral lattice
+  int numberOfArrays = 3;
+  // Point array i gets componentCounts[i % size] components
+  QVector<int> componentCounts = {1, 3};
+  // "ascii", "binary" (inline base64), "appended" (raw) or "zlib" (appended
+  // raw, zlib compressed)
+  QString encoding = "appended";
+  bool doublePrecision = true;
+
+  // Stable file name describing the options, e.g. for reusing large files
+  QString fileName() const;
+};
+
+// Writes hexahedral lattices with smooth point fields for benchmarking
+class SyntheticVtuGenerator {
+public:
+  static bool isValidEncoding(const QString &encoding);
+
+  static vtkSmartPointer<vtkUnstructuredGrid>
+  generateGrid(const SyntheticVtuOptions &options);
+
+  static bool write(const SyntheticVtuOptions &options,
+                    const QString &filePath, QString &errorMessage);
+};
+
+#endif // SYNTHETIC_VTU_GENERATOR_H
@@ -0,0 +1,371 @@
+#include "ArrayHistogram.h"
+
+#include <vtkArrayDispatch.h>
+#include <vtkDataArray.h>
+#include <vtkDataArrayRange.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace {
+// Tuples gathered before binning; the block buffer and the per-thread bins
+// (8 KiB at 1024 bins) stay in L1 while the block is binned
+const vtkIdType tuplesPerBlock = 2048;
+
+// Bins per unit of the range; a degenerate range puts every value into the
+// first bin
+double binScale(const double range[2], int numberOfBins) {
+  return range[1] > range[0] ? numberOfBins / (range[1] - range[0]) : 0.0;
+}
+
+// Out of range (and infinite) values clamp to the outer bins. Counting and
+// selection bin with this same arithmetic, so they always agree.
+inline int binOf(double value, double minimum, double scale,
+                 int numberOfBins) {
+  const double position = (value - minimum) * scale;
+  return !(position > 0.0)                ? 0
+         : position >= numberOfBins - 1.0 ? numberOfBins - 1
+                                          : static_cast<int>(position);
+}
+
+// Selected component, or the magnitude for componentIndex -1
+template <typename TupleT>
+inline double tupleValue(const TupleT &tuple, int componentIndex,
+                         int components) {
+  if (componentIndex >= 0) {
+    return static_cast<double>(tuple[componentIndex]);
+  }
+  double squaredMagnitude = 0.0;
+  for (int c = 0; c < components; ++c) {
+    const double value = static_cast<double>(tuple[c]);
+    squaredMagnitude += value * value;
+  }
+  return std::sqrt(squaredMagnitude);
+}
+
+template <typename ArrayT> class HistogramFunctor {
+public:
+  HistogramFunctor(ArrayT *array, int componentIndex, const double range[2],
+                   int numberOfBins)
+      : array(array), componentIndex(componentIndex), minimum(range[0]),
+        scale(binScale(range, numberOfBins)), numberOfBins(numberOfBins) {}
+
+  void Initialize() { localCounts.Local().assign(numberOfBins, 0); }
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    qint64 *counts = localCounts.Local().data();
+    std::array<double, tuplesPerBlock> values;
+    const int components = array->GetNumberOfComponents();
+
+    const auto tuples = vtk::DataArrayTupleRange(array, begin, end);
+    auto tuple = tuples.cbegin();
+    for (vtkIdType blockBegin = begin; blockBegin < end;
+         blockBegin += tuplesPerBlock) {
+      const vtkIdType blockSize = std::min(tuplesPerBlock, end - blockBegin);
+
+      // Gather the selected component or the magnitude of the block
+      for (vtkIdType i = 0; i < blockSize; ++i, ++tuple) {
+        values[i] = tupleValue(*tuple, componentIndex, components);
+      }
+
+      // Bin it
+      for (vtkIdType i = 0; i < blockSize; ++i) {
+        const double value = values[i];
+        if (!std::isnan(value)) {
+          ++counts[binOf(value, minimum, scale, numberOfBins)];
+        }
+      }
+    }
+  }
+
+  void Reduce() {
+    result.assign(numberOfBins, 0);
+    for (const std::vector<qint64> &counts : localCounts) {
+      for (int b = 0; b < numberOfBins; ++b) {
+        result[b] += counts[b];
+      }
+    }
+  }
+
+  std::vector<qint64> result;
+
+private:
+  ArrayT *array;
+  int componentIndex;
+  double minimum;
+  double scale;
+  int numberOfBins;
+  vtkSMPThreadLocal<std::vector<qint64>> localCounts;
+};
+
+struct ComputeHistogramWorker {
+  template <typename ArrayT>
+  void operator()(ArrayT *array, int componentIndex, const double *range,
+                  int numberOfBins, std::vector<qint64> &counts) const {
+    HistogramFunctor<ArrayT> functor(array, componentIndex, range,
+                                     numberOfBins);
+    vtkSMPTools::For(0, array->GetNumberOfTuples(), functor);
+    counts = functor.result;
+  }
+};
+
+// Copies the values of the selected bins; binSlots maps a bin to its slot
+// in the result, or -1
+template <typename ArrayT> class BinValuesFunctor {
+public:
+  BinValuesFunctor(ArrayT *array, int componentIndex, const double range[2],
+                   int numberOfBins, const std::vector<int> &binSlots,
+                   int numberOfSlots)
+      : array(array), componentIndex(componentIndex), minimum(range[0]),
+        scale(binScale(range, numberOfBins)), numberOfBins(numberOfBins),
+        binSlots(binSlots), numberOfSlots(numberOfSlots) {}
+
+  void Initialize() { localValues.Local().resize(numberOfSlots); }
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    std::vector<std::vector<double>> &slotValues = localValues.Local();
+    const int components = array->GetNumberOfComponents();
+    for (const auto tuple : vtk::DataArrayTupleRange(array, begin, end)) {
+      const double value = tupleValue(tuple, componentIndex, components);
+      if (std::isnan(value)) {
+        continue;
+      }
+      const int slot = binSlots[binOf(value, minimum, scale, numberOfBins)];
+      if (slot >= 0) {
+        slotValues[slot].push_back(value);
+      }
+    }
+  }
+
+  void Reduce() {
+    result.assign(numberOfSlots, std::vector<double>());
+    for (const std::vector<std::vector<double>> &slotValues : localValues) {
+      for (int s = 0; s < numberOfSlots; ++s) {
+        result[s].insert(result[s].end(), slotValues[s].begin(),
+                         slotValues[s].end());
+      }
+    }
+  }
+
+  std::vector<std::vector<double>> result;
+
+private:
+  ArrayT *array;
+  int componentIndex;
+  double minimum;
+  double scale;
+  int numberOfBins;
+  const std::vector<int> &binSlots;
+  int numberOfSlots;
+  vtkSMPThreadLocal<std::vector<std::vector<double>>> localValues;
+};
+
+struct CollectBinValuesWorker {
+  template <typename ArrayT>
+  void operator()(ArrayT *array, int componentIndex, const double *range,
+                  int numberOfBins, const std::vector<int> &binSlots,
+                  int numberOfSlots,
+                  std::vector<std::vector<double>> &values) const {
+    BinValuesFunctor<ArrayT> functor(array, componentIndex, range,
+                                     numberOfBins, binSlots, numberOfSlots);
+    vtkSMPTools::For(0, array->GetNumberOfTuples(), functor);
+    values = std::move(functor.result);
+  }
+};
+} // namespace
+
+double ArrayHistogram::percentileValue(double percentage) const {
+  if (totalCount == 0 || binCounts.isEmpty()) {
+    return min;
+  }
+  const double target =
+      std::clamp(percentage, 0.0, 100.0) / 100.0 * totalCount;
+  const double binWidth = (max - min) / binCounts.size();
+  qint64 cumulativeCount = 0;
+  for (int b = 0; b < binCounts.size(); ++b) {
+    const qint64 count = binCounts[b];
+    if (count > 0 && cumulativeCount + count >= target) {
+      const double fraction = (target - cumulativeCount) / count;
+      return min + (b + fraction) * binWidth;
+    }
+    cumulativeCount += count;
+  }
+  return max;
+}
+
+QVector<double> ArrayHistogram::computeExactPercentileValues(
+    vtkDataArray *array, int componentIndex,
+    const QVector<double> &percentages) const {
+  QVector<double> values;
+  const int numberOfBins = binCounts.size();
+  if (array == nullptr || totalCount == 0 || numberOfBins == 0 ||
+      componentIndex >= array->GetNumberOfComponents()) {
+    for (const double percentage : percentages) {
+      values.push_back(percentileValue(percentage));
+    }
+    return values;
+  }
+
+  // Rank of the first value of every bin
+  std::vector<qint64> firstRanks(numberOfBins + 1, 0);
+  for (int b = 0; b < numberOfBins; ++b) {
+    firstRanks[b + 1] = firstRanks[b] + binCounts[b];
+  }
+  const auto binOfRank = [&firstRanks](qint64 rank) {
+    return static_cast<int>(std::upper_bound(firstRanks.begin(),
+                                             firstRanks.end(), rank) -
+                            firstRanks.begin()) -
+           1;
+  };
+
+  // The percentile at rank position p/100 * (n - 1) lies between the order
+  // statistics at the ranks around it (linear interpolation, as NumPy does)
+  struct Target {
+    qint64 lowerRank;
+    qint64 upperRank;
+    double fraction;
+  };
+  QVector<Target> targets;
+  std::vector<int> binSlots(numberOfBins, -1);
+  std::vector<int> slotBins;
+  for (const double percentage : percentages) {
+    const double position =
+        std::clamp(percentage, 0.0, 100.0) / 100.0 * (totalCount - 1);
+    Target target;
+    target.lowerRank = static_cast<qint64>(std::floor(position));
+    target.upperRank = std::min(target.lowerRank + 1, totalCount - 1);
+    target.fraction = position - target.lowerRank;
+    targets.push_back(target);
+    for (const qint64 rank : {target.lowerRank, target.upperRank}) {
+      const int bin = binOfRank(rank);
+      if (binSlots[bin] < 0) {
+        binSlots[bin] = static_cast<int>(slotBins.size());
+        slotBins.push_back(bin);
+      }
+    }
+  }
+
+  const double range[2] = {min, max};
+  std::vector<std::vector<double>> slotValues;
+  CollectBinValuesWorker worker;
+  if (!vtkArrayDispatch::Dispatch::Execute(
+          array, worker, componentIndex, range, numberOfBins, binSlots,
+          static_cast<int>(slotBins.size()), slotValues)) {
+    // Generic vtkDataArray fallback
+    worker(array, componentIndex, range, numberOfBins, binSlots,
+           static_cast<int>(slotBins.size()), slotValues);
+  }
+  for (size_t s = 0; s < slotBins.size(); ++s) {
+    if (static_cast<qint64>(slotValues[s].size()) != binCounts[slotBins[s]]) {
+      // Not the array the histogram was computed from
+      return computeExactPercentileValues(nullptr, componentIndex,
+                                          percentages);
+    }
+  }
+
+  // Reordering a bin by one selection keeps it valid for the next one
+  const auto orderStatistic = [&](qint64 rank) {
+    const int bin = binOfRank(rank);
+    std::vector<double> &binValues = slotValues[binSlots[bin]];
+    const auto nth = binValues.begin() + (rank - firstRanks[bin]);
+    std::nth_element(binValues.begin(), nth, binValues.end());
+    return *nth;
+  };
+  for (const Target &target : targets) {
+    const double lower = orderStatistic(target.lowerRank);
+    const double upper = orderStatistic(target.upperRank);
+    values.push_back(lower + target.fraction * (upper - lower));
+  }
+  return values;
+}
+
+const ArrayHistogram *ArrayHistogramCache::histogram(vtkDataArray *array,
+                                                     int componentIndex,
+                                                     const double range[2]) {
+  if (array == nullptr || array->GetName() == nullptr) {
+    return nullptr;
+  }
+  const QPair<QString, int> key(QString::fromStdString(array->GetName()),
+                                componentIndex);
+  const auto it = entries.constFind(key);
+  if (it != entries.constEnd() && it->min == range[0] &&
+      it->max == range[1]) {
+    return &it.value();
+  }
+  return &entries.insert(key, compute(array, componentIndex, range,
+                                      numberOfBins))
+              .value();
+}
+
+ArrayHistogram ArrayHistogramCache::compute(vtkDataArray *array,
+                                            int componentIndex,
+                                            const double range[2],
+                                            int numberOfBins) {
+  ArrayHistogram histogram;
+  histogram.min = range[0];
+  histogram.max = range[1];
+  if (array == nullptr || numberOfBins <= 0 ||
+      componentIndex >= array->GetNumberOfComponents()) {
+    return histogram;
+  }
+
+  std::vector<qint64> counts;
+  ComputeHistogramWorker worker;
+  if (!vtkArrayDispatch::Dispatch::Execute(array, worker, componentIndex,
+                                           range, numberOfBins, counts)) {
+    // Generic vtkDataArray fallback
+    worker(array, componentIndex, range, numberOfBins, counts);
+  }
+
+  histogram.binCounts = QVector<qint64>(counts.begin(), counts.end());
+  for (const qint64 count : counts) {
+    histogram.totalCount += count;
+  }
+  return histogram;
+}
+
+void ArrayHistogramCache::clipRange(vtkDataArray *array, int componentIndex,
+                                    const PercentileRange &percentiles,
+                                    double range[2]) {
+  if (percentiles.isFull() || histogram(array, componentIndex, range) ==
+                                  nullptr) {
+    return;
+  }
+  ArrayHistogram &entry = entries[QPair<QString, int>(
+      QString::fromStdString(array->GetName()), componentIndex)];
+  QVector<double> missingPercentages;
+  for (const double percentage : {percentiles.lower, percentiles.upper}) {
+    if (!entry.exactPercentileValues.contains(percentage)) {
+      missingPercentages.push_back(percentage);
+    }
+  }
+  if (!missingPercentages.isEmpty()) {
+    const QVector<double> values = entry.computeExactPercentileValues(
+        array, componentIndex, missingPercentages);
+    for (int i = 0; i < missingPercentages.size(); ++i) {
+      entry.exactPercentileValues.insert(missingPercentages[i], values[i]);
+    }
+  }
+  const double lower = entry.exactPercentileValues.value(percentiles.lower);
+  const double upper = entry.exactPercentileValues.value(percentiles.upper);
+  if (lower < upper) {
+    range[0] = lower;
+    range[1] = upper;
+  }
+}
+
+void ArrayHistogramCache::remove(const QString &arrayName) {
+  for (auto it = entries.begin(); it != entries.end();) {
+    if (it.key().first == arrayName) {
+      it = entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ArrayHistogramCache::clear() { entries.clear(); }
@@ -0,0 +1,73 @@
+#ifndef ARRAY_HISTOGRAM_H
+#define ARRAY_HISTOGRAM_H
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+class vtkDataArray;
+
+// Part of the value distribution the color map spans, in percent; 0-100
+// keeps the full min/max range
+struct PercentileRange {
+  double lower = 0.0;
+  double upper = 100.0;
+
+  bool isFull() const { return lower <= 0.0 && upper >= 100.0; }
+};
+
+// Distribution of one component (or the magnitude) of an array over its
+// range. Values outside the range count towards the first or last bin, NaN
+// is skipped.
+struct ArrayHistogram {
+  double min = 0.0;
+  double max = 0.0;
+  QVector<qint64> binCounts;
+  qint64 totalCount = 0;
+  // Exact values per percentage, filled by ArrayHistogramCache::clipRange
+  QHash<double, double> exactPercentileValues;
+
+  // Value below which the given percentage (0-100) of the values lie,
+  // interpolated linearly within its bin
+  double percentileValue(double percentage) const;
+
+  // Exact values of the percentages for the array the histogram was
+  // computed from: the order statistics around each percentile are selected
+  // among the values of the bins they fall in (one pass over the array that
+  // copies only those bins) and interpolated linearly between their ranks.
+  // Falls back to percentileValue if the array does not match.
+  QVector<double> computeExactPercentileValues(
+      vtkDataArray *array, int componentIndex,
+      const QVector<double> &percentages) const;
+};
+
+// Histograms of named arrays per component, computed on first use with one
+// multithreaded pass over the array
+class ArrayHistogramCache {
+public:
+  static const int numberOfBins = 1024;
+
+  // componentIndex -1 selects the magnitude. Looks the histogram over range
+  // up, computing it from the array on a miss. The pointer stays valid until
+  // the next call that modifies the cache.
+  const ArrayHistogram *histogram(vtkDataArray *array, int componentIndex,
+                                  const double range[2]);
+
+  static ArrayHistogram compute(vtkDataArray *array, int componentIndex,
+                                const double range[2], int numberOfBins);
+
+  // Clips range (the full range of the component) to the exact percentiles
+  // of the values; leaves it unchanged for the full range or when the
+  // clipped range would be empty. Values are cached with the histogram.
+  void clipRange(vtkDataArray *array, int componentIndex,
+                 const PercentileRange &percentiles, double range[2]);
+
+  void remove(const QString &arrayName);
+  void clear();
+
+private:
+  QHash<QPair<QString, int>, ArrayHistogram> entries;
+};
+
+#endif // ARRAY_HISTOGRAM_H
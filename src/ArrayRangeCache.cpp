@@ -0,0 +1,217 @@
+#include "ArrayRangeCache.h"
+
+#include <QDataStream>
+
+#include <vtkArrayDispatch.h>
+#include <vtkDataArray.h>
+#include <vtkDataArrayRange.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+// Partial results hold [min, max] per component followed by [min, max] of the
+// squared magnitude
+template <typename ArrayT> class RangeFunctor {
+public:
+  explicit RangeFunctor(ArrayT *array)
+      : array(array), numberOfComponents(array->GetNumberOfComponents()) {}
+
+  void Initialize() { resetRanges(localRanges.Local()); }
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    std::vector<double> &ranges = localRanges.Local();
+    double *componentRanges = ranges.data();
+    double *squaredMagnitudeRange = componentRanges + 2 * numberOfComponents;
+    const int components = numberOfComponents;
+
+    for (const auto tuple : vtk::DataArrayTupleRange(array, begin, end)) {
+      double squaredMagnitude = 0.0;
+      for (int c = 0; c < components; ++c) {
+        const double value = static_cast<double>(tuple[c]);
+        // NaN fails both comparisons and is skipped, as in vtkDataArray
+        if (value < componentRanges[2 * c]) {
+          componentRanges[2 * c] = value;
+        }
+        if (value > componentRanges[2 * c + 1]) {
+          componentRanges[2 * c + 1] = value;
+        }
+        squaredMagnitude += value * value;
+      }
+      if (squaredMagnitude < squaredMagnitudeRange[0]) {
+        squaredMagnitudeRange[0] = squaredMagnitude;
+      }
+      if (squaredMagnitude > squaredMagnitudeRange[1]) {
+        squaredMagnitudeRange[1] = squaredMagnitude;
+      }
+    }
+  }
+
+  void Reduce() {
+    resetRanges(result);
+    for (const std::vector<double> &ranges : localRanges) {
+      for (size_t i = 0; i < result.size(); i += 2) {
+        result[i] = std::min(result[i], ranges[i]);
+        result[i + 1] = std::max(result[i + 1], ranges[i + 1]);
+      }
+    }
+  }
+
+  std::vector<double> result;
+
+private:
+  void resetRanges(std::vector<double> &ranges) const {
+    ranges.resize(2 * (numberOfComponents + 1));
+    for (size_t i = 0; i < ranges.size(); i += 2) {
+      ranges[i] = std::numeric_limits<double>::max();
+      ranges[i + 1] = std::numeric_limits<double>::lowest();
+    }
+  }
+
+  ArrayT *array;
+  int numberOfComponents;
+  vtkSMPThreadLocal<std::vector<double>> localRanges;
+};
+
+struct ComputeRangesWorker {
+  template <typename ArrayT>
+  void operator()(ArrayT *array, std::vector<double> &ranges) const {
+    RangeFunctor<ArrayT> functor(array);
+    vtkSMPTools::For(0, array->GetNumberOfTuples(), functor);
+    ranges = functor.result;
+  }
+};
+} // namespace
+
+void ArrayRangeCache::seedFromHeader(
+    const QVector<VtuDataArrayDescriptor> &descriptors) {
+  for (const VtuDataArrayDescriptor &descriptor : descriptors) {
+    if (!descriptor.hasDeclaredRange || !descriptor.isNumeric() ||
+        entries.contains(descriptor.name)) {
+      continue;
+    }
+    Entry entry;
+    const Range declaredRange{descriptor.rangeMin, descriptor.rangeMax, true};
+    if (descriptor.numberOfComponents == 1) {
+      entry.components.push_back(declaredRange);
+    } else {
+      entry.components.resize(descriptor.numberOfComponents);
+      entry.magnitude = declaredRange;
+    }
+    entries.insert(descriptor.name, entry);
+  }
+}
+
+void ArrayRangeCache::compute(vtkDataArray *array) {
+  if (array == nullptr || array->GetName() == nullptr) {
+    return;
+  }
+
+  std::vector<double> ranges;
+  ComputeRangesWorker worker;
+  if (!vtkArrayDispatch::Dispatch::Execute(array, worker, ranges)) {
+    worker(array, ranges); // Generic vtkDataArray fallback
+  }
+
+  const int numberOfComponents = array->GetNumberOfComponents();
+  Entry entry;
+  entry.components.resize(numberOfComponents);
+  for (int c = 0; c < numberOfComponents; ++c) {
+    Range &range = entry.components[c];
+    range.min = ranges[2 * c];
+    range.max = ranges[2 * c + 1];
+    range.valid = range.min <= range.max;
+  }
+  const double *squaredMagnitudeRange = ranges.data() + 2 * numberOfComponents;
+  entry.magnitude.valid = squaredMagnitudeRange[0] <= squaredMagnitudeRange[1];
+  if (entry.magnitude.valid) {
+    entry.magnitude.min = std::sqrt(squaredMagnitudeRange[0]);
+    entry.magnitude.max = std::sqrt(squaredMagnitudeRange[1]);
+  }
+  entries.insert(QString::fromStdString(array->GetName()), entry);
+}
+
+bool ArrayRangeCache::lookup(const QString &arrayName, int componentIndex,
+                             double range[2]) const {
+  const auto it = entries.constFind(arrayName);
+  if (it == entries.constEnd()) {
+    return false;
+  }
+  const Entry &entry = it.value();
+  Range cachedRange;
+  if (componentIndex == -1) {
+    cachedRange = entry.magnitude;
+  } else if (componentIndex >= 0 && componentIndex < entry.components.size()) {
+    cachedRange = entry.components[componentIndex];
+  }
+  if (!cachedRange.valid) {
+    return false;
+  }
+  range[0] = cachedRange.min;
+  range[1] = cachedRange.max;
+  return true;
+}
+
+void ArrayRangeCache::getRange(vtkDataArray *array, int componentIndex,
+                               double range[2]) {
+  if (array == nullptr || array->GetName() == nullptr) {
+    return;
+  }
+  const QString arrayName = QString::fromStdString(array->GetName());
+  if (lookup(arrayName, componentIndex, range)) {
+    return;
+  }
+  compute(array);
+  if (!lookup(arrayName, componentIndex, range)) {
+    array->GetRange(range, componentIndex);
+  }
+}
+
+void ArrayRangeCache::remove(const QString &arrayName) {
+  entries.remove(arrayName);
+}
+
+void ArrayRangeCache::clear() { entries.clear(); }
+
+void ArrayRangeCache::writeTo(QDataStream &stream) const {
+  auto writeRange = [&stream](const Range &range) {
+    stream << range.min << range.max << range.valid;
+  };
+  stream << static_cast<qint32>(entries.size());
+  for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+    stream << it.key() << static_cast<qint32>(it->components.size());
+    for (const Range &range : it->components) {
+      writeRange(range);
+    }
+    writeRange(it->magnitude);
+  }
+}
+
+bool ArrayRangeCache::readFrom(QDataStream &stream) {
+  auto readRange = [&stream](Range &range) {
+    stream >> range.min >> range.max >> range.valid;
+  };
+  qint32 numberOfEntries = 0;
+  stream >> numberOfEntries;
+  for (qint32 i = 0; i < numberOfEntries && stream.status() == QDataStream::Ok;
+       ++i) {
+    QString arrayName;
+    qint32 numberOfComponents = 0;
+    stream >> arrayName >> numberOfComponents;
+    if (numberOfComponents < 0 || numberOfComponents > (1 << 20)) {
+      return false; // Damaged stream
+    }
+    Entry entry;
+    entry.components.resize(numberOfComponents);
+    for (Range &range : entry.components) {
+      readRange(range);
+    }
+    readRange(entry.magnitude);
+    entries.insert(arrayName, entry);
+  }
+  return stream.status() == QDataStream::Ok;
+}
@@ -0,0 +1,54 @@
+#ifndef ARRAY_RANGE_CACHE_H
+#define ARRAY_RANGE_CACHE_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "VtuHeaderScanner.h"
+
+class QDataStream;
+class vtkDataArray;
+
+// Min/max of every component and of the magnitude of named arrays, so that
+// color switches look ranges up instead of rescanning the data
+class ArrayRangeCache {
+public:
+  // Seeds the ranges declared by RangeMin/RangeMax in the VTU header. VTK
+  // writes the component range for scalars and the magnitude range for
+  // multi-component arrays.
+  void seedFromHeader(const QVector<VtuDataArrayDescriptor> &descriptors);
+
+  // Computes the ranges of all components and of the magnitude in a single
+  // multithreaded pass over the array
+  void compute(vtkDataArray *array);
+
+  // componentIndex -1 selects the magnitude. Returns false on a cache miss.
+  bool lookup(const QString &arrayName, int componentIndex,
+              double range[2]) const;
+
+  // Looks the range up, computing it from the array on a miss
+  void getRange(vtkDataArray *array, int componentIndex, double range[2]);
+
+  void remove(const QString &arrayName);
+  void clear();
+
+  // Serializes every cached range (e.g. into a decoded model cache entry)
+  void writeTo(QDataStream &stream) const;
+  bool readFrom(QDataStream &stream);
+
+private:
+  struct Range {
+    double min = 0.0;
+    double max = 0.0;
+    bool valid = false;
+  };
+  struct Entry {
+    QVector<Range> components;
+    Range magnitude;
+  };
+
+  QHash<QString, Entry> entries;
+};
+
+#endif // ARRAY_RANGE_CACHE_H
@@ -0,0 +1,133 @@
+#include "ArrayStatistics.h"
+
+#include <QString>
+
+#include <vtkArrayDispatch.h>
+#include <vtkDataArray.h>
+#include <vtkDataArrayRange.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "ArrayHistogram.h"
+#include "ArrayRangeCache.h"
+
+namespace {
+// Partial results hold [sum, count] per component followed by [sum, count]
+// of the magnitude
+template <typename ArrayT> class SumFunctor {
+public:
+  explicit SumFunctor(ArrayT *array)
+      : array(array), numberOfComponents(array->GetNumberOfComponents()) {}
+
+  void Initialize() {
+    localSums.Local().assign(2 * (numberOfComponents + 1), 0.0);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    std::vector<double> &sums = localSums.Local();
+    double *magnitudeSum = sums.data() + 2 * numberOfComponents;
+    const int components = numberOfComponents;
+
+    for (const auto tuple : vtk::DataArrayTupleRange(array, begin, end)) {
+      double squaredMagnitude = 0.0;
+      for (int c = 0; c < components; ++c) {
+        const double value = static_cast<double>(tuple[c]);
+        squaredMagnitude += value * value;
+        if (!std::isnan(value)) {
+          sums[2 * c] += value;
+          sums[2 * c + 1] += 1.0;
+        }
+      }
+      if (!std::isnan(squaredMagnitude)) {
+        magnitudeSum[0] += std::sqrt(squaredMagnitude);
+        magnitudeSum[1] += 1.0;
+      }
+    }
+  }
+
+  void Reduce() {
+    result.assign(2 * (numberOfComponents + 1), 0.0);
+    for (const std::vector<double> &sums : localSums) {
+      for (size_t i = 0; i < result.size(); ++i) {
+        result[i] += sums[i];
+      }
+    }
+  }
+
+  std::vector<double> result;
+
+private:
+  ArrayT *array;
+  int numberOfComponents;
+  vtkSMPThreadLocal<std::vector<double>> localSums;
+};
+
+struct ComputeSumsWorker {
+  template <typename ArrayT>
+  void operator()(ArrayT *array, std::vector<double> &sums) const {
+    SumFunctor<ArrayT> functor(array);
+    vtkSMPTools::For(0, array->GetNumberOfTuples(), functor);
+    sums = functor.result;
+  }
+};
+} // namespace
+
+QVector<ComponentStatistics>
+ArrayStatistics::compute(vtkDataArray *array,
+                         const QVector<int> &componentIndices,
+                         const QVector<double> &percentages,
+                         int numberOfBins) {
+  QVector<ComponentStatistics> statistics;
+  if (array == nullptr || array->GetName() == nullptr) {
+    return statistics;
+  }
+  const int numberOfComponents = array->GetNumberOfComponents();
+
+  ArrayRangeCache ranges;
+  ranges.compute(array);
+  std::vector<double> sums;
+  ComputeSumsWorker worker;
+  if (!vtkArrayDispatch::Dispatch::Execute(array, worker, sums)) {
+    worker(array, sums); // Generic vtkDataArray fallback
+  }
+
+  const QString arrayName = QString::fromStdString(array->GetName());
+  for (const int componentIndex : componentIndices) {
+    if (componentIndex < -1 || componentIndex >= numberOfComponents) {
+      continue;
+    }
+    ComponentStatistics componentStatistics;
+    componentStatistics.componentIndex = componentIndex;
+    const int sumIndex =
+        2 * ((componentIndex >= 0) ? componentIndex : numberOfComponents);
+    componentStatistics.count = static_cast<qint64>(sums[sumIndex + 1]);
+
+    double range[2] = {0.0, 0.0};
+    if (componentStatistics.count > 0 &&
+        ranges.lookup(arrayName, componentIndex, range)) {
+      componentStatistics.min = range[0];
+      componentStatistics.max = range[1];
+      componentStatistics.mean =
+          sums[sumIndex] / static_cast<double>(componentStatistics.count);
+      const ArrayHistogram histogram = ArrayHistogramCache::compute(
+          array, componentIndex, range, numberOfBins);
+      componentStatistics.percentileValues =
+          histogram.computeExactPercentileValues(array, componentIndex,
+                                                 percentages);
+    } else {
+      // Empty or only NaN: nothing to summarize
+      const double nan = std::numeric_limits<double>::quiet_NaN();
+      componentStatistics.count = 0;
+      componentStatistics.min = nan;
+      componentStatistics.max = nan;
+      componentStatistics.mean = nan;
+      componentStatistics.percentileValues.fill(nan, percentages.size());
+    }
+    statistics.push_back(componentStatistics);
+  }
+  return statistics;
+}
@@ -0,0 +1,31 @@
+#ifndef ARRAY_STATISTICS_H
+#define ARRAY_STATISTICS_H
+
+#include <QVector>
+
+class vtkDataArray;
+
+// Summary of one component (or the magnitude) of an array. NaN is skipped.
+struct ComponentStatistics {
+  int componentIndex = 0; // -1 for the magnitude
+  qint64 count = 0;       // Values that are not NaN
+  double min = 0.0;
+  double max = 0.0;
+  double mean = 0.0;
+  // Exact values of the requested percentages, located with a histogram
+  // over [min, max] and selected among the values of their bins
+  QVector<double> percentileValues;
+};
+
+class ArrayStatistics {
+public:
+  // Statistics of the given components (-1 selects the magnitude) from
+  // multithreaded passes over the array: one for the ranges, one for the
+  // means and, per component, one for the histogram and one copying the
+  // values of the bins the percentiles fall in.
+  static QVector<ComponentStatistics>
+  compute(vtkDataArray *array, const QVector<int> &componentIndices,
+          const QVector<double> &percentages, int numberOfBins);
+};
+
+#endif // ARRAY_STATISTICS_H
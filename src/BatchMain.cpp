@@ -0,0 +1,244 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+
+#include "BatchRenderer.h"
+#include "BatchStatistics.h"
+#include "VtuTimeSeries.h"
+
+int main(int argc, char *argv[]) {
+  // Render with Mesa's software rasterizer unless told otherwise, so build
+  // nodes without a GPU produce the same images
+  if (!qEnvironmentVariableIsSet("LIBGL_ALWAYS_SOFTWARE")) {
+    qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+  }
+
+  QCoreApplication app(argc, argv);
+  app.setApplicationName("VtkRendererBatch");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Renders point arrays of VTU files to PNG images offscreen, or writes "
+      "their statistics to a table.");
+  parser.addHelpOption();
+  QCommandLineOption outputOption({"o", "output"},
+                                  "Directory for the PNG images.", "dir", ".");
+  QCommandLineOption arrayOption(
+      {"a", "array"}, "Point array to render (repeatable; default: all).",
+      "name");
+  QCommandLineOption componentOption(
+      {"c", "component"},
+      "Component to render: index, 'magnitude' or 'all' (repeatable; "
+      "default: magnitude for vectors).",
+      "component");
+  QCommandLineOption sizeOption({"s", "size"}, "Image size.", "WxH",
+                                "1600x1200");
+  QCommandLineOption jobsOption(
+      {"j", "jobs"}, "Number of worker processes (default: one per core).",
+      "n", QString::number(QThread::idealThreadCount()));
+  QCommandLineOption float32Option(
+      "float32", "Convert Float64 coordinates and point arrays to Float32.");
+  QCommandLineOption percentilesOption(
+      {"p", "percentiles"},
+      "Clip the color range to percentiles, e.g. 1-99 (default: 0-100).",
+      "low-high", "0-100");
+  QCommandLineOption statisticsOption(
+      "statistics",
+      "Write min/max/mean/percentiles of the point arrays to a .csv or "
+      ".json table instead of rendering (components default to all). "
+      "Points shared by the pieces of a .pvtu file count once per piece.",
+      "file");
+  QCommandLineOption statisticsPercentilesOption(
+      "statistics-percentiles", "Percentiles of the statistics table.",
+      "list", "1,5,25,50,75,95,99");
+  QCommandLineOption statisticsBinsOption(
+      "statistics-bins",
+      "Histogram bins that locate the percentiles; more bins copy fewer "
+      "values for their exact selection.", "n",
+      QString::number(ArrayHistogramCache::numberOfBins));
+  QCommandLineOption workerOption("worker");
+  workerOption.setFlags(QCommandLineOption::HiddenFromHelp);
+  QCommandLineOption inputDirectoryOption("input-directory", "", "dir");
+  inputDirectoryOption.setFlags(QCommandLineOption::HiddenFromHelp);
+  parser.addOptions({outputOption, arrayOption, componentOption, sizeOption,
+                     jobsOption, float32Option, percentilesOption,
+                     statisticsOption, statisticsPercentilesOption,
+                     statisticsBinsOption, workerOption,
+                     inputDirectoryOption});
+  parser.addPositionalArgument(
+      "files", "VTU or PVTU files or .pvd collections.", "files...");
+  parser.process(app);
+
+  QTextStream standardError(stderr);
+  QTextStream standardOutput(stdout);
+
+  BatchRenderOptions options;
+  options.outputDirectory = parser.value(outputOption);
+  options.arrayNames = parser.values(arrayOption);
+  options.componentSpecs = parser.values(componentOption);
+  options.float32 = parser.isSet(float32Option);
+  const QStringList size = parser.value(sizeOption).split('x');
+  bool widthOk = false;
+  bool heightOk = false;
+  if (size.size() == 2) {
+    options.width = size[0].toInt(&widthOk);
+    options.height = size[1].toInt(&heightOk);
+  }
+  if (!widthOk || !heightOk || options.width <= 0 || options.height <= 0) {
+    standardError << "Invalid image size: " << parser.value(sizeOption)
+                  << Qt::endl;
+    return 2;
+  }
+  const QStringList percentiles = parser.value(percentilesOption).split('-');
+  bool lowerOk = false;
+  bool upperOk = false;
+  if (percentiles.size() == 2) {
+    options.colorRange.lower = percentiles[0].toDouble(&lowerOk);
+    options.colorRange.upper = percentiles[1].toDouble(&upperOk);
+  }
+  if (!lowerOk || !upperOk || options.colorRange.lower < 0.0 ||
+      options.colorRange.upper > 100.0 ||
+      options.colorRange.lower >= options.colorRange.upper) {
+    standardError << "Invalid percentiles: " << parser.value(percentilesOption)
+                  << Qt::endl;
+    return 2;
+  }
+  bool jobsOk = false;
+  const int jobs = parser.value(jobsOption).toInt(&jobsOk);
+  if (!jobsOk || jobs <= 0) {
+    standardError << "Invalid number of jobs: " << parser.value(jobsOption)
+                  << Qt::endl;
+    return 2;
+  }
+  if (!parser.isSet(statisticsOption) &&
+      !QDir().mkpath(options.outputDirectory)) {
+    standardError << "Cannot create output directory: "
+                  << options.outputDirectory << Qt::endl;
+    return 2;
+  }
+
+  // Collections expand to their steps
+  QStringList filePaths;
+  for (const QString &argument : parser.positionalArguments()) {
+    if (QFileInfo(argument).suffix().compare("pvd", Qt::CaseInsensitive) ==
+        0) {
+      VtuTimeSeries series;
+      QString errorMessage;
+      if (!VtuTimeSeries::open(argument, series, errorMessage)) {
+        standardError << errorMessage << Qt::endl;
+        return 2;
+      }
+      filePaths += series.filePaths;
+    } else {
+      filePaths.push_back(argument);
+    }
+  }
+  if (filePaths.isEmpty()) {
+    parser.showHelp(2);
+  }
+  // Workers get the directory of all files, not just of their share
+  options.inputDirectory = parser.isSet(inputDirectoryOption)
+                               ? parser.value(inputDirectoryOption)
+                               : BatchRenderer::commonDirectory(filePaths);
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // Statistics need no rendering; files are summarized on a thread pool
+  if (parser.isSet(statisticsOption)) {
+    BatchStatisticsOptions statisticsOptions;
+    statisticsOptions.arrayNames = options.arrayNames;
+    statisticsOptions.componentSpecs = options.componentSpecs;
+    statisticsOptions.jobs = jobs;
+    statisticsOptions.percentages.clear();
+    for (const QString &text :
+         parser.value(statisticsPercentilesOption).split(',')) {
+      bool ok = false;
+      const double percentage = text.trimmed().toDouble(&ok);
+      if (!ok || percentage < 0.0 || percentage > 100.0) {
+        standardError << "Invalid statistics percentile: " << text
+                      << Qt::endl;
+        return 2;
+      }
+      statisticsOptions.percentages.push_back(percentage);
+    }
+    bool binsOk = false;
+    statisticsOptions.numberOfBins =
+        parser.value(statisticsBinsOption).toInt(&binsOk);
+    if (!binsOk || statisticsOptions.numberOfBins <= 0) {
+      standardError << "Invalid number of bins: "
+                    << parser.value(statisticsBinsOption) << Qt::endl;
+      return 2;
+    }
+
+    BatchStatistics statistics(statisticsOptions);
+    QVector<StatisticsRow> rows;
+    const int failedFiles = statistics.computeFiles(filePaths, rows);
+    QString errorMessage;
+    if (!statistics.writeTable(parser.value(statisticsOption), rows,
+                               errorMessage)) {
+      standardError << errorMessage << Qt::endl;
+      return 2;
+    }
+    const double seconds = std::max(timer.elapsed() / 1000.0, 0.001);
+    standardOutput << QString("Summarized %1 files (%2 rows) in %3 s with "
+                              "%4 thread(s)")
+                          .arg(filePaths.size() - failedFiles)
+                          .arg(rows.size())
+                          .arg(seconds, 0, 'f', 1)
+                          .arg(std::min<int>(jobs, filePaths.size()))
+                   << Qt::endl;
+    return (failedFiles == 0) ? 0 : 1;
+  }
+
+  auto printSummary = [&](int imagesWritten, int workers) {
+    const double seconds = std::max(timer.elapsed() / 1000.0, 0.001);
+    standardOutput << QString("Rendered %1 images from %2 files in %3 s with "
+                              "%4 worker(s) (%5 images/min)")
+                          .arg(imagesWritten)
+                          .arg(filePaths.size())
+                          .arg(seconds, 0, 'f', 1)
+                          .arg(workers)
+                          .arg(imagesWritten * 60.0 / seconds, 0, 'f', 1)
+                   << Qt::endl;
+  };
+
+  // Workers render their share in-process; the parent only distributes
+  int imagesWritten = 0;
+  if (parser.isSet(workerOption) || jobs == 1 || filePaths.size() == 1) {
+    BatchRenderer renderer(options);
+    const int failedFiles = renderer.renderFiles(filePaths, imagesWritten);
+    if (!parser.isSet(workerOption)) {
+      printSummary(imagesWritten, 1);
+    }
+    return (failedFiles == 0) ? 0 : 1;
+  }
+
+  QStringList workerArguments = {"--worker", "--output",
+                                 options.outputDirectory, "--size",
+                                 parser.value(sizeOption), "--percentiles",
+                                 parser.value(percentilesOption),
+                                 "--input-directory", options.inputDirectory};
+  for (const QString &arrayName : options.arrayNames) {
+    workerArguments << "--array" << arrayName;
+  }
+  for (const QString &componentSpec : options.componentSpecs) {
+    workerArguments << "--component" << componentSpec;
+  }
+  if (options.float32) {
+    workerArguments << "--float32";
+  }
+  workerArguments << "--";
+
+  const int failedWorkers = BatchRenderer::renderInWorkerProcesses(
+      filePaths, jobs, app.applicationFilePath(), workerArguments,
+      imagesWritten);
+  printSummary(imagesWritten, std::min<int>(jobs, filePaths.size()));
+  return (failedWorkers == 0) ? 0 : 1;
+}
@@ -0,0 +1,358 @@
+#include "BatchRenderer.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QScopedPointer>
+#include <QTextStream>
+#include <QThread>
+
+#include <vtkActor.h>
+#include <vtkLookupTable.h>
+#include <vtkNew.h>
+#include <vtkPNGWriter.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkScalarBarActor.h>
+#include <vtkWindowToImageFilter.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "ColorBufferCache.h"
+#include "SurfaceColoring.h"
+#include "VtuModelLoader.h"
+
+namespace {
+// Prefix of the progress line printed for every written image; the parent
+// process counts these lines in its workers' output
+const QString imageWrittenPrefix = "Wrote ";
+
+QTextStream &standardOutput() {
+  static QTextStream stream(stdout);
+  return stream;
+}
+
+QTextStream &standardError() {
+  static QTextStream stream(stderr);
+  return stream;
+}
+
+QString sanitizeFileNamePart(const QString &text) {
+  static const QRegularExpression unsafeCharacters("[^A-Za-z0-9_.-]+");
+  QString sanitized = text;
+  sanitized.replace(unsafeCharacters, "_");
+  return sanitized;
+}
+} // namespace
+
+BatchRenderer::BatchRenderer(const BatchRenderOptions &options)
+    : options(options) {}
+
+int BatchRenderer::renderFiles(const QStringList &filePaths,
+                               int &imagesWritten) {
+  imagesWritten = 0;
+  int failedFiles = 0;
+  for (const QString &filePath : filePaths) {
+    if (!renderFile(filePath, imagesWritten)) {
+      ++failedFiles;
+    }
+  }
+  return failedFiles;
+}
+
+int BatchRenderer::renderInWorkerProcesses(const QStringList &filePaths,
+                                           int jobs,
+                                           const QString &workerExecutable,
+                                           const QStringList &workerArguments,
+                                           int &imagesWritten) {
+  imagesWritten = 0;
+  jobs = std::clamp(jobs, 1, std::max<int>(filePaths.size(), 1));
+
+  // Round-robin keeps similarly sized neighbouring files on different workers
+  QVector<QStringList> shares(jobs);
+  for (int i = 0; i < filePaths.size(); ++i) {
+    shares[i % jobs].push_back(filePaths[i]);
+  }
+
+  // Split the cores between the workers' SMP thread pools
+  QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+  if (!environment.contains("VTK_SMP_MAX_THREADS")) {
+    environment.insert(
+        "VTK_SMP_MAX_THREADS",
+        QString::number(std::max(1, QThread::idealThreadCount() / jobs)));
+  }
+
+  std::vector<std::unique_ptr<QProcess>> workers;
+  for (const QStringList &share : shares) {
+    auto worker = std::make_unique<QProcess>();
+    worker->setProcessEnvironment(environment);
+    worker->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    worker->start(workerExecutable, workerArguments + share);
+    workers.push_back(std::move(worker));
+  }
+
+  // Drain every worker's output in turn so no worker blocks on a full pipe
+  auto forwardOutput = [&imagesWritten](QProcess &worker) {
+    while (worker.canReadLine()) {
+      const QString line = QString::fromLocal8Bit(worker.readLine());
+      if (line.startsWith(imageWrittenPrefix)) {
+        ++imagesWritten;
+      }
+      standardOutput() << line;
+    }
+    standardOutput().flush();
+  };
+  bool anyRunning = true;
+  while (anyRunning) {
+    anyRunning = false;
+    for (const std::unique_ptr<QProcess> &worker : workers) {
+      if (worker->state() != QProcess::NotRunning) {
+        worker->waitForReadyRead(50);
+        anyRunning = true;
+      }
+      forwardOutput(*worker);
+    }
+  }
+
+  int failedWorkers = 0;
+  for (const std::unique_ptr<QProcess> &worker : workers) {
+    worker->waitForFinished(-1);
+    forwardOutput(*worker);
+    const QByteArray rest = worker->readAllStandardOutput();
+    if (!rest.isEmpty()) {
+      standardOutput() << QString::fromLocal8Bit(rest) << Qt::endl;
+    }
+    if (worker->error() == QProcess::FailedToStart ||
+        worker->exitStatus() != QProcess::NormalExit ||
+        worker->exitCode() != 0) {
+      ++failedWorkers;
+    }
+  }
+  return failedWorkers;
+}
+
+bool BatchRenderer::renderFile(const QString &filePath, int &imagesWritten) {
+  // Only the requested arrays are decoded
+  VtuModelLoader loader;
+  VtuLoadOptions loadOptions;
+  loadOptions.lazyPointArrays = true;
+  if (options.float32) {
+    loadOptions.float32.points = true;
+    loadOptions.float32.pointArrays = QStringList{"*"};
+  }
+  loader.setLoadOptions(loadOptions);
+
+  QScopedPointer<LoadedVtuModel> model;
+  QString loadingErrorMessage;
+  QObject::connect(&loader, &VtuModelLoader::modelLoaded,
+                   [&model](LoadedVtuModel *loadedModel, const QString &) {
+                     model.reset(loadedModel);
+                   });
+  QObject::connect(&loader, &VtuModelLoader::modelLoadingErrorOccured,
+                   [&loadingErrorMessage](const QString &errorMessage) {
+                     loadingErrorMessage = errorMessage;
+                   });
+  loader.load(filePath);
+  if (model == nullptr || model->surface == nullptr) {
+    standardError() << "Failed to load " << filePath << ": "
+                    << loadingErrorMessage << Qt::endl;
+    return false;
+  }
+
+  // Same scene as the viewer, drawn into an offscreen window
+  vtkNew<vtkLookupTable> lookupTable;
+  lookupTable->Build();
+  ColorBufferCache colorBufferCache;
+
+  vtkNew<vtkPolyData> coloredSurface;
+  coloredSurface->CopyStructure(model->surface);
+  vtkNew<vtkPolyDataMapper> mapper;
+  mapper->SetInputData(coloredSurface);
+  mapper->SetScalarModeToUsePointData();
+  mapper->SetColorModeToDirectScalars();
+  mapper->ScalarVisibilityOn();
+  vtkNew<vtkActor> actor;
+  actor->SetMapper(mapper);
+
+  vtkNew<vtkScalarBarActor> scalarBar;
+  scalarBar->SetLookupTable(lookupTable);
+  scalarBar->SetNumberOfLabels(6);
+  scalarBar->SetWidth(0.08);
+  scalarBar->SetHeight(0.8);
+  scalarBar->SetPosition(0.90, 0.10);
+  scalarBar->SetVerticalTitleSeparation(18);
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->SetBackground(0.12, 0.16, 0.20);
+  renderer->AddActor(actor);
+  renderer->AddActor2D(scalarBar);
+  renderer->ResetCamera();
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetOffScreenRendering(1);
+  renderWindow->SetSize(options.width, options.height);
+  renderWindow->AddRenderer(renderer);
+
+  // Select arrays by name, keeping the order of the file
+  QVector<int> arrayIndices;
+  for (int i = 0; i < model->pointArraysInfo.size(); ++i) {
+    if (options.arrayNames.isEmpty() ||
+        options.arrayNames.contains(model->pointArraysInfo[i].name)) {
+      arrayIndices.push_back(i);
+    }
+  }
+  for (const QString &arrayName : options.arrayNames) {
+    const bool found = std::any_of(
+        model->pointArraysInfo.cbegin(), model->pointArraysInfo.cend(),
+        [&arrayName](const PointArrayInfo &info) {
+          return info.name == arrayName;
+        });
+    if (!found) {
+      standardError() << "Array '" << arrayName << "' not found in "
+                      << filePath << Qt::endl;
+    }
+  }
+
+  bool ok = true;
+  for (int arrayIndex : arrayIndices) {
+    const PointArrayInfo &arrayInfo = model->pointArraysInfo[arrayIndex];
+    for (int componentIndex :
+         selectComponents(arrayInfo, options.componentSpecs)) {
+      double range[2] = {0.0, 1.0};
+      QString coloringErrorMessage;
+      if (!SurfaceColoring::apply(*model, arrayIndex, componentIndex,
+                                  lookupTable, "default", colorBufferCache,
+                                  coloredSurface, options.colorRange, range,
+                                  coloringErrorMessage)) {
+        standardError() << "Failed to color " << filePath << ": "
+                        << coloringErrorMessage << Qt::endl;
+        ok = false;
+        continue;
+      }
+      const QString componentName =
+          VtuModelLoader::getDisplayNameForVtkIndex(arrayInfo, componentIndex);
+      const QString title = arrayInfo.name + "\n" + componentName;
+      scalarBar->SetTitle(title.toLocal8Bit().constData());
+      renderWindow->Render();
+
+      vtkNew<vtkWindowToImageFilter> windowToImage;
+      windowToImage->SetInput(renderWindow);
+      windowToImage->SetInputBufferTypeToRGB();
+      windowToImage->ReadFrontBufferOff();
+      const QString outputPath =
+          imageFilePath(filePath, arrayInfo.name, componentName);
+      if (!QDir().mkpath(QFileInfo(outputPath).absolutePath())) {
+        standardError() << "Cannot create output directory: "
+                        << QFileInfo(outputPath).absolutePath() << Qt::endl;
+        ok = false;
+        continue;
+      }
+      vtkNew<vtkPNGWriter> writer;
+      writer->SetFileName(QFile::encodeName(outputPath).constData());
+      writer->SetInputConnection(windowToImage->GetOutputPort());
+      writer->Write();
+      if (writer->GetErrorCode() != 0) {
+        standardError() << "Failed to write " << outputPath << Qt::endl;
+        ok = false;
+        continue;
+      }
+      ++imagesWritten;
+      standardOutput() << imageWrittenPrefix << outputPath << Qt::endl;
+    }
+  }
+  return ok;
+}
+
+QVector<int>
+BatchRenderer::selectComponents(const PointArrayInfo &arrayInfo,
+                                const QStringList &componentSpecs) {
+  const bool hasMagnitude = VtuModelLoader::hasMagnitudeOption(arrayInfo);
+  const int numberOfComponents =
+      arrayInfo.componentNames.size() - (hasMagnitude ? 1 : 0);
+
+  // Same default selection as the viewer
+  QVector<int> components;
+  if (componentSpecs.isEmpty()) {
+    components.push_back(hasMagnitude ? -1 : 0);
+    return components;
+  }
+
+  auto addComponent = [&components](int componentIndex) {
+    if (!components.contains(componentIndex)) {
+      components.push_back(componentIndex);
+    }
+  };
+  for (const QString &spec : componentSpecs) {
+    const QString normalizedSpec = spec.trimmed().toLower();
+    bool isIndex = false;
+    const int componentIndex = normalizedSpec.toInt(&isIndex);
+    if (normalizedSpec == "all") {
+      for (int i = 0; i < arrayInfo.componentNames.size(); ++i) {
+        addComponent(VtuModelLoader::comboIndexToVtkIndex(arrayInfo, i));
+      }
+    } else if (normalizedSpec == "magnitude") {
+      addComponent(hasMagnitude ? -1 : 0);
+    } else if (isIndex && componentIndex >= 0 &&
+               componentIndex < numberOfComponents) {
+      addComponent(componentIndex);
+    } else if (!isIndex) {
+      standardError() << "Unknown component '" << spec << "'" << Qt::endl;
+    }
+  }
+  return components;
+}
+
+QString BatchRenderer::commonDirectory(const QStringList &filePaths) {
+  QStringList commonParts;
+  for (int i = 0; i < filePaths.size(); ++i) {
+    const QStringList parts =
+        QDir::cleanPath(QFileInfo(filePaths[i]).absolutePath()).split('/');
+    if (i == 0) {
+      commonParts = parts;
+      continue;
+    }
+    int commonSize = 0;
+    while (commonSize < commonParts.size() && commonSize < parts.size() &&
+           commonParts[commonSize] == parts[commonSize]) {
+      ++commonSize;
+    }
+    commonParts = commonParts.mid(0, commonSize);
+  }
+  if (commonParts.isEmpty()) {
+    return QString();
+  }
+  // Absolute paths split into a leading empty part on Unix
+  return (commonParts == QStringList{QString()}) ? QString("/")
+                                                 : commonParts.join('/');
+}
+
+QString BatchRenderer::imageFilePath(const QString &filePath,
+                                     const QString &arrayName,
+                                     const QString &componentName) const {
+  const QFileInfo fileInfo(filePath);
+  const QString fileName =
+      QString("%1_%2_%3.png")
+          .arg(sanitizeFileNamePart(fileInfo.completeBaseName()),
+               sanitizeFileNamePart(arrayName),
+               sanitizeFileNamePart(componentName));
+
+  // Mirror the file's directory below the input directory
+  QString relativeDirectory;
+  if (!options.inputDirectory.isEmpty()) {
+    relativeDirectory = QDir(options.inputDirectory)
+                            .relativeFilePath(fileInfo.absolutePath());
+  }
+  if (relativeDirectory.isEmpty() || relativeDirectory == "." ||
+      relativeDirectory.startsWith("..") ||
+      QDir::isAbsolutePath(relativeDirectory)) {
+    return QDir(options.outputDirectory).filePath(fileName);
+  }
+  return QDir(QDir(options.outputDirectory).filePath(relativeDirectory))
+      .filePath(fileName);
+}
@@ -0,0 +1,68 @@
+#ifndef BATCH_RENDERER_H
+#define BATCH_RENDERER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "ArrayHistogram.h"
+
+struct PointArrayInfo;
+
+struct BatchRenderOptions {
+  QString outputDirectory = ".";
+  // Point arrays to render; empty renders every point array
+  QStringList arrayNames;
+  // "magnitude", "all" or a component index; empty renders the default
+  // component the viewer would select (magnitude for vectors)
+  QStringList componentSpecs;
+  int width = 1600;
+  int height = 1200;
+  // Decode Float64 coordinates and point arrays to Float32
+  bool float32 = false;
+  // Part of the value distribution the color map spans (e.g. 1-99 %)
+  PercentileRange colorRange;
+  // Common directory of the input files; images of files in its
+  // subdirectories go to the same subdirectories of outputDirectory, so
+  // same-named files of different directories keep their own images
+  QString inputDirectory;
+};
+
+// Renders files x arrays x components to PNG images offscreen with the same
+// surface coloring pipeline as the viewer
+class BatchRenderer {
+public:
+  explicit BatchRenderer(const BatchRenderOptions &options);
+
+  // Renders the files one after another in this process. Returns the number
+  // of files that failed; imagesWritten counts the written images.
+  int renderFiles(const QStringList &filePaths, int &imagesWritten);
+
+  // Splits the files over jobs worker processes that run workerExecutable
+  // with workerArguments followed by their share of the files. Returns the
+  // number of workers that failed.
+  static int renderInWorkerProcesses(const QStringList &filePaths, int jobs,
+                                     const QString &workerExecutable,
+                                     const QStringList &workerArguments,
+                                     int &imagesWritten);
+
+  // Components of the array selected by "magnitude", "all" or index specs
+  // (-1 is the magnitude); no specs select the default component the viewer
+  // would show (magnitude for vectors)
+  static QVector<int> selectComponents(const PointArrayInfo &arrayInfo,
+                                       const QStringList &componentSpecs);
+
+  // Deepest directory that contains every file; empty when there is none
+  // (files on different drives)
+  static QString commonDirectory(const QStringList &filePaths);
+
+private:
+  bool renderFile(const QString &filePath, int &imagesWritten);
+  QString imageFilePath(const QString &filePath, const QString &arrayName,
+                        const QString &componentName) const;
+
+private:
+  BatchRenderOptions options;
+};
+
+#endif // BATCH_RENDERER_H
@@ -0,0 +1,238 @@
+#include "BatchStatistics.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+#include <vtkDataArray.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "BatchRenderer.h"
+#include "PointArrayInfo.h"
+#include "VtuHeaderScanner.h"
+#include "VtuModelLoader.h"
+
+namespace {
+QTextStream &standardOutput() {
+  static QTextStream stream(stdout);
+  return stream;
+}
+
+QTextStream &standardError() {
+  static QTextStream stream(stderr);
+  return stream;
+}
+
+QString csvLine(const QStringList &fields) {
+  QStringList quoted;
+  for (QString field : fields) {
+    if (field.contains(',') || field.contains('"')) {
+      field = '"' + field.replace("\"", "\"\"") + '"';
+    }
+    quoted.push_back(field);
+  }
+  return quoted.join(',');
+}
+
+// Round-trips doubles exactly, so nightly runs can be diffed
+QString csvNumber(double value) { return QString::number(value, 'g', 17); }
+
+// Column of a percentile, e.g. "p95" or "p99.9"
+QString percentileKey(double percentage) {
+  return QString("p%1").arg(percentage);
+}
+} // namespace
+
+BatchStatistics::BatchStatistics(const BatchStatisticsOptions &options)
+    : options(options) {}
+
+int BatchStatistics::computeFiles(const QStringList &filePaths,
+                                  QVector<StatisticsRow> &rows) {
+  rows.clear();
+  const int jobs =
+      std::clamp(options.jobs, 1, std::max<int>(filePaths.size(), 1));
+
+  // Split the cores between the files summarized concurrently; every
+  // reduction runs on the SMP thread pool
+  if (!qEnvironmentVariableIsSet("VTK_SMP_MAX_THREADS")) {
+    vtkSMPTools::Initialize(std::max(1, QThread::idealThreadCount() / jobs));
+  }
+
+  QVector<QVector<StatisticsRow>> fileRows(filePaths.size());
+  std::atomic_int failedFiles(0);
+  QThreadPool threadPool;
+  threadPool.setMaxThreadCount(jobs);
+  for (int i = 0; i < filePaths.size(); ++i) {
+    threadPool.start([this, &filePaths, &fileRows, &failedFiles, i]() {
+      QString errorMessage;
+      const bool ok = computeFile(filePaths[i], fileRows[i], errorMessage);
+      QMutexLocker locker(&outputMutex);
+      if (ok) {
+        standardOutput() << "Summarized " << filePaths[i] << Qt::endl;
+      } else {
+        ++failedFiles;
+        standardError() << "Failed to summarize " << filePaths[i] << ": "
+                        << errorMessage << Qt::endl;
+      }
+    });
+  }
+  threadPool.waitForDone();
+
+  for (const QVector<StatisticsRow> &file : fileRows) {
+    rows += file;
+  }
+  return failedFiles.load();
+}
+
+bool BatchStatistics::computeFile(const QString &filePath,
+                                  QVector<StatisticsRow> &rows,
+                                  QString &errorMessage) {
+  VtuHeader header;
+  if (!VtuHeaderScanner::scan(filePath, header, errorMessage)) {
+    return false;
+  }
+  const QVector<PointArrayInfo> pointArraysInfo =
+      VtuModelLoader::catalogPointArrays(header);
+  for (const QString &arrayName : options.arrayNames) {
+    const bool found = std::any_of(
+        pointArraysInfo.cbegin(), pointArraysInfo.cend(),
+        [&arrayName](const PointArrayInfo &info) {
+          return info.name == arrayName;
+        });
+    if (!found) {
+      QMutexLocker locker(&outputMutex);
+      standardError() << "Array '" << arrayName << "' not found in "
+                      << filePath << Qt::endl;
+    }
+  }
+
+  QVector<PointArrayInfo> selectedArraysInfo;
+  QStringList selectedArrayNames;
+  for (const PointArrayInfo &arrayInfo : pointArraysInfo) {
+    if (options.arrayNames.isEmpty() ||
+        options.arrayNames.contains(arrayInfo.name)) {
+      selectedArraysInfo.push_back(arrayInfo);
+      selectedArrayNames.push_back(arrayInfo.name);
+    }
+  }
+
+  // The XML reader parses the whole file for any array, so such files are
+  // read once for all of them
+  if (!VtuModelLoader::readsPointArraysDirectly(header, selectedArrayNames)) {
+    const std::atomic_bool notCancelled(false);
+    QVector<vtkSmartPointer<vtkDataArray>> arrays;
+    if (!VtuModelLoader::readPointArrays(filePath, header, selectedArrayNames,
+                                         nullptr, notCancelled, arrays,
+                                         errorMessage)) {
+      return false;
+    }
+    for (int i = 0; i < selectedArraysInfo.size(); ++i) {
+      appendRows(filePath, selectedArraysInfo[i], arrays[i], rows);
+    }
+    return true;
+  }
+
+  // The array is released before the next one is decoded
+  for (const PointArrayInfo &arrayInfo : selectedArraysInfo) {
+    vtkSmartPointer<vtkDataArray> array = VtuModelLoader::readPointArray(
+        filePath, header, arrayInfo.name, errorMessage);
+    if (array == nullptr) {
+      rows.clear();
+      return false;
+    }
+    appendRows(filePath, arrayInfo, array, rows);
+  }
+  return true;
+}
+
+void BatchStatistics::appendRows(const QString &filePath,
+                                 const PointArrayInfo &arrayInfo,
+                                 vtkDataArray *array,
+                                 QVector<StatisticsRow> &rows) {
+  const QStringList componentSpecs = options.componentSpecs.isEmpty()
+                                         ? QStringList{"all"}
+                                         : options.componentSpecs;
+  QVector<int> componentIndices;
+  {
+    // Unknown specs are reported on the console
+    QMutexLocker locker(&outputMutex);
+    componentIndices =
+        BatchRenderer::selectComponents(arrayInfo, componentSpecs);
+  }
+  for (const ComponentStatistics &statistics :
+       ArrayStatistics::compute(array, componentIndices, options.percentages,
+                                options.numberOfBins)) {
+    rows.push_back(StatisticsRow{filePath, arrayInfo.name,
+                                 VtuModelLoader::getDisplayNameForVtkIndex(
+                                     arrayInfo, statistics.componentIndex),
+                                 statistics});
+  }
+}
+
+bool BatchStatistics::writeTable(const QString &filePath,
+                                 const QVector<StatisticsRow> &rows,
+                                 QString &errorMessage) const {
+  QFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    errorMessage = "Cannot write statistics: " + filePath;
+    return false;
+  }
+
+  if (QFileInfo(filePath).suffix().compare("csv", Qt::CaseInsensitive) != 0) {
+    // NaN (arrays without values) is written as null
+    QJsonArray jsonRows;
+    for (const StatisticsRow &row : rows) {
+      const ComponentStatistics &statistics = row.statistics;
+      QJsonObject jsonRow;
+      jsonRow["file"] = row.filePath;
+      jsonRow["array"] = row.arrayName;
+      jsonRow["component"] = row.componentName;
+      jsonRow["count"] = statistics.count;
+      jsonRow["min"] = statistics.min;
+      jsonRow["max"] = statistics.max;
+      jsonRow["mean"] = statistics.mean;
+      for (int i = 0; i < options.percentages.size(); ++i) {
+        jsonRow[percentileKey(options.percentages[i])] =
+            statistics.percentileValues.value(i);
+      }
+      jsonRows.push_back(jsonRow);
+    }
+    QJsonObject table;
+    table["rows"] = jsonRows;
+    file.write(QJsonDocument(table).toJson(QJsonDocument::Indented));
+    return true;
+  }
+
+  QTextStream stream(&file);
+  QStringList header = {"file", "array", "component", "count",
+                        "min",  "max",   "mean"};
+  for (const double percentage : options.percentages) {
+    header.push_back(percentileKey(percentage));
+  }
+  stream << csvLine(header) << '\n';
+  for (const StatisticsRow &row : rows) {
+    const ComponentStatistics &statistics = row.statistics;
+    QStringList fields = {row.filePath,
+                          row.arrayName,
+                          row.componentName,
+                          QString::number(statistics.count),
+                          csvNumber(statistics.min),
+                          csvNumber(statistics.max),
+                          csvNumber(statistics.mean)};
+    for (int i = 0; i < options.percentages.size(); ++i) {
+      fields.push_back(csvNumber(statistics.percentileValues.value(i)));
+    }
+    stream << csvLine(fields) << '\n';
+  }
+  return true;
+}
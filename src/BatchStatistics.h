@@ -0,0 +1,65 @@
+#ifndef BATCH_STATISTICS_H
+#define BATCH_STATISTICS_H
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "ArrayHistogram.h"
+#include "ArrayStatistics.h"
+#include "PointArrayInfo.h"
+
+class vtkDataArray;
+
+struct BatchStatisticsOptions {
+  // Point arrays to summarize; empty summarizes every point array
+  QStringList arrayNames;
+  // "magnitude", "all" or a component index; empty summarizes every
+  // component and the magnitude
+  QStringList componentSpecs;
+  QVector<double> percentages = {1.0, 5.0, 25.0, 50.0, 75.0, 95.0, 99.0};
+  int numberOfBins = ArrayHistogramCache::numberOfBins;
+  int jobs = 1; // Files summarized concurrently
+};
+
+// One row of the statistics table
+struct StatisticsRow {
+  QString filePath;
+  QString arrayName;
+  QString componentName;
+  ComponentStatistics statistics;
+};
+
+// Min/max/mean/percentiles of point arrays over many files, without
+// rendering. Appended and partitioned files are read by offset, one array
+// at a time, so neither their mesh nor a whole model is held. Files left to
+// the XML reader are parsed once for all selected arrays, mesh included.
+// Points on the interfaces of a .pvtu file are stored by every piece that
+// shares them and count once per piece.
+class BatchStatistics {
+public:
+  explicit BatchStatistics(const BatchStatisticsOptions &options);
+
+  // Summarizes the files on a pool of options.jobs threads, so at most that
+  // many arrays are resident at once. Rows are ordered by file, array and
+  // component. Returns the number of files that failed.
+  int computeFiles(const QStringList &filePaths, QVector<StatisticsRow> &rows);
+
+  // Writes JSON, or CSV when the path ends in .csv
+  bool writeTable(const QString &filePath, const QVector<StatisticsRow> &rows,
+                  QString &errorMessage) const;
+
+private:
+  // rows is left empty on failure
+  bool computeFile(const QString &filePath, QVector<StatisticsRow> &rows,
+                   QString &errorMessage);
+  void appendRows(const QString &filePath, const PointArrayInfo &arrayInfo,
+                  vtkDataArray *array, QVector<StatisticsRow> &rows);
+
+private:
+  BatchStatisticsOptions options;
+  QMutex outputMutex; // Serializes console output of the pool threads
+};
+
+#endif // BATCH_STATISTICS_H
@@ -0,0 +1,123 @@
+#include "CellToPointCache.h"
+
+#include <vtkArrayDispatch.h>
+#include <vtkDataArrayRange.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkSMPTools.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ModelMemoryUsage.h"
+#include "PerfTrace.h"
+
+namespace {
+struct InterpolateWorker {
+  template <typename CellArrayT, typename PointArrayT>
+  void operator()(CellArrayT *cellArray, PointArrayT *pointArray,
+                  vtkStaticCellLinks *links) const {
+    using ValueT = vtk::GetAPIType<PointArrayT>;
+    const int components = cellArray->GetNumberOfComponents();
+    const auto cellValues = vtk::DataArrayTupleRange(cellArray);
+    auto pointValues = vtk::DataArrayTupleRange(pointArray);
+    vtkSMPTools::For(0, pointValues.size(), [&](vtkIdType begin,
+                                                vtkIdType end) {
+      std::vector<double> sums(components);
+      for (vtkIdType p = begin; p < end; ++p) {
+        const vtkIdType numberOfCells = links->GetNcells(p);
+        const vtkIdType *cells = links->GetCells(p);
+        std::fill(sums.begin(), sums.end(), 0.0);
+        for (vtkIdType i = 0; i < numberOfCells; ++i) {
+          const auto cellTuple = cellValues[cells[i]];
+          for (int c = 0; c < components; ++c) {
+            sums[c] += static_cast<double>(cellTuple[c]);
+          }
+        }
+        // Points used by no cell get zero
+        const double weight = (numberOfCells > 0) ? 1.0 / numberOfCells : 0.0;
+        auto pointTuple = pointValues[p];
+        for (int c = 0; c < components; ++c) {
+          pointTuple[c] = static_cast<ValueT>(sums[c] * weight);
+        }
+      }
+    });
+  }
+};
+} // namespace
+
+vtkDataArray *CellToPointCache::interpolate(vtkUnstructuredGrid *grid,
+                                            vtkDataArray *cellArray) {
+  if (grid == nullptr || cellArray == nullptr ||
+      cellArray->GetName() == nullptr ||
+      cellArray->GetNumberOfTuples() != grid->GetNumberOfCells()) {
+    return nullptr;
+  }
+  const QString arrayName = QString::fromStdString(cellArray->GetName());
+  const auto it = arrays.constFind(arrayName);
+  if (it != arrays.constEnd()) {
+    return it.value();
+  }
+
+  // The links serve every array of the mesh
+  if (links == nullptr) {
+    PerfTrace::Scope scope("color", "Build point-to-cell links");
+    links = vtkSmartPointer<vtkStaticCellLinks>::New();
+    links->BuildLinks(grid);
+  }
+  PerfTrace::Scope scope("color", "Interpolate cell data to points");
+  vtkSmartPointer<vtkDataArray> pointArray =
+      interpolate(cellArray, grid->GetNumberOfPoints(), links);
+  arrays.insert(arrayName, pointArray);
+  return pointArray;
+}
+
+vtkSmartPointer<vtkDataArray>
+CellToPointCache::interpolate(vtkDataArray *cellArray,
+                              vtkIdType numberOfPoints,
+                              vtkStaticCellLinks *links) {
+  vtkSmartPointer<vtkDataArray> pointArray;
+  if (vtkFloatArray::SafeDownCast(cellArray) != nullptr) {
+    pointArray = vtkSmartPointer<vtkFloatArray>::New();
+  } else {
+    pointArray = vtkSmartPointer<vtkDoubleArray>::New();
+  }
+  pointArray->SetName(cellArray->GetName());
+  pointArray->SetNumberOfComponents(cellArray->GetNumberOfComponents());
+  for (int c = 0; c < cellArray->GetNumberOfComponents(); ++c) {
+    if (cellArray->GetComponentName(c) != nullptr) {
+      pointArray->SetComponentName(c, cellArray->GetComponentName(c));
+    }
+  }
+  pointArray->SetNumberOfTuples(numberOfPoints);
+
+  InterpolateWorker worker;
+  using Dispatcher =
+      vtkArrayDispatch::Dispatch2ByValueType<vtkArrayDispatch::Reals,
+                                             vtkArrayDispatch::Reals>;
+  if (!Dispatcher::Execute(cellArray, pointArray.GetPointer(), worker,
+                           links)) {
+    // Generic vtkDataArray fallback (e.g. integer cell arrays)
+    worker(cellArray, pointArray.GetPointer(), links);
+  }
+  return pointArray;
+}
+
+void CellToPointCache::remove(const QString &arrayName) {
+  arrays.remove(arrayName);
+}
+
+void CellToPointCache::clear() {
+  arrays.clear();
+  links = nullptr;
+}
+
+qint64 CellToPointCache::totalBytes() const {
+  qint64 bytes =
+      (links != nullptr) ? links->GetActualMemorySize() * 1024LL : 0;
+  for (const vtkSmartPointer<vtkDataArray> &array : arrays) {
+    bytes += ModelMemoryUsage::arrayBytes(array);
+  }
+  return bytes;
+}
@@ -0,0 +1,38 @@
+#ifndef CELL_TO_POINT_CACHE_H
+#define CELL_TO_POINT_CACHE_H
+
+#include <QHash>
+#include <QString>
+
+#include <vtkDataArray.h>
+#include <vtkSmartPointer.h>
+#include <vtkStaticCellLinks.h>
+
+class vtkUnstructuredGrid;
+
+// Cell arrays averaged to the grid points (every point takes the mean of the
+// cells using it), cached per array so switching between flat and
+// interpolated cell coloring only pays for the first interpolation
+class CellToPointCache {
+public:
+  // Looks the interpolated array up, computing it on a miss. The result has
+  // the name of the cell array; Float32 only if the cell array is.
+  vtkDataArray *interpolate(vtkUnstructuredGrid *grid, vtkDataArray *cellArray);
+
+  // One multithreaded pass over the points using point-to-cell links (built
+  // with vtkStaticCellLinks, which is also threaded)
+  static vtkSmartPointer<vtkDataArray> interpolate(vtkDataArray *cellArray,
+                                                   vtkIdType numberOfPoints,
+                                                   vtkStaticCellLinks *links);
+
+  void remove(const QString &arrayName);
+  void clear(); // Also drops the links (e.g. for another mesh)
+
+  qint64 totalBytes() const; // Interpolated arrays and links
+
+private:
+  vtkSmartPointer<vtkStaticCellLinks> links; // Built on first use
+  QHash<QString, vtkSmartPointer<vtkDataArray>> arrays;
+};
+
+#endif // CELL_TO_POINT_CACHE_H
@@ -0,0 +1,133 @@
+#include "ColorBufferCache.h"
+
+#include <vtkArrayDispatch.h>
+#include <vtkDataArray.h>
+#include <vtkDataArrayRange.h>
+#include <vtkIdTypeArray.h>
+#include <vtkSMPTools.h>
+#include <vtkScalarsToColors.h>
+
+#include "PerfTrace.h"
+
+namespace {
+struct GatherTuplesWorker {
+  template <typename ArrayT>
+  void operator()(ArrayT *array, const vtkIdType *ids,
+                  vtkDataArray *gatheredArray) const {
+    // The gathered array is a new instance of the source array's class
+    ArrayT *gathered = static_cast<ArrayT *>(gatheredArray);
+    const auto source = vtk::DataArrayTupleRange(array);
+    auto destination = vtk::DataArrayTupleRange(gathered);
+    const int components = array->GetNumberOfComponents();
+    vtkSMPTools::For(0, destination.size(),
+                     [&](vtkIdType begin, vtkIdType end) {
+                       for (vtkIdType i = begin; i < end; ++i) {
+                         const auto tuple = source[ids[i]];
+                         auto gatheredTuple = destination[i];
+                         for (int c = 0; c < components; ++c) {
+                           gatheredTuple[c] = tuple[c];
+                         }
+                       }
+                     });
+  }
+};
+
+// Copies the listed tuples into a new array of the same type
+vtkSmartPointer<vtkDataArray> gatherTuples(vtkDataArray *array,
+                                           vtkIdTypeArray *tupleIds) {
+  vtkSmartPointer<vtkDataArray> gathered =
+      vtkSmartPointer<vtkDataArray>::Take(array->NewInstance());
+  gathered->SetName(array->GetName());
+  gathered->SetNumberOfComponents(array->GetNumberOfComponents());
+  gathered->SetNumberOfTuples(tupleIds->GetNumberOfTuples());
+
+  const vtkIdType *ids = tupleIds->GetPointer(0);
+  GatherTuplesWorker worker;
+  if (!vtkArrayDispatch::Dispatch::Execute(array, worker, ids, gathered)) {
+    worker(array, ids, gathered); // Generic vtkDataArray fallback
+  }
+  gathered->Modified();
+  return gathered;
+}
+} // namespace
+
+ColorBufferCache::ColorBufferCache(qint64 maxBytes) : entries(maxBytes) {}
+
+vtkSmartPointer<vtkUnsignedCharArray>
+ColorBufferCache::colors(vtkDataArray *array, int componentIndex,
+                         const double range[2],
+                         vtkScalarsToColors *lookupTable,
+                         const QString &lookupTableId,
+                         vtkIdTypeArray *tupleIds, const QString &view) {
+  if (array == nullptr || array->GetName() == nullptr ||
+      lookupTable == nullptr) {
+    return nullptr;
+  }
+  const QString arrayName = QString::fromStdString(array->GetName());
+  const QString key =
+      makeKey(arrayName, view, componentIndex, range, lookupTableId);
+
+  // QCache::object() also marks the entry as most recently used
+  if (Entry *entry = entries.object(key)) {
+    return entry->colors;
+  }
+
+  vtkSmartPointer<vtkDataArray> scalars = array;
+  if (tupleIds != nullptr) {
+    PerfTrace::Scope scope("color", "Gather surface values");
+    scalars = gatherTuples(array, tupleIds);
+  }
+  PerfTrace::Scope scope("color", "Map scalars");
+  vtkSmartPointer<vtkUnsignedCharArray> mappedColors =
+      vtkSmartPointer<vtkUnsignedCharArray>::Take(lookupTable->MapScalars(
+          scalars, VTK_COLOR_MODE_MAP_SCALARS, componentIndex, VTK_RGBA));
+  if (mappedColors == nullptr) {
+    return nullptr;
+  }
+
+  // Buffers larger than the whole budget are returned but not kept
+  const qint64 bytes = mappedColors->GetNumberOfValues();
+  if (entries.insert(key, new Entry{mappedColors}, bytes)) {
+    QSet<QString> &arrayKeys = keysByArray[arrayName];
+    // QCache::contains() leaves the order of use alone
+    for (auto it = arrayKeys.begin(); it != arrayKeys.end();) {
+      if (entries.contains(*it)) {
+        ++it;
+      } else {
+        it = arrayKeys.erase(it);
+      }
+    }
+    arrayKeys.insert(key);
+  }
+  return mappedColors;
+}
+
+void ColorBufferCache::removeArray(const QString &arrayName) {
+  for (const QString &key : keysByArray.take(arrayName)) {
+    entries.remove(key);
+  }
+}
+
+void ColorBufferCache::clear() {
+  entries.clear();
+  keysByArray.clear();
+}
+
+void ColorBufferCache::setMaxBytes(qint64 maxBytes) {
+  entries.setMaxCost(maxBytes);
+}
+
+qint64 ColorBufferCache::totalBytes() const { return entries.totalCost(); }
+
+QString ColorBufferCache::makeKey(const QString &arrayName,
+                                  const QString &view, int componentIndex,
+                                  const double range[2],
+                                  const QString &lookupTableId) {
+  return QString("%1|%2|%3|%4|%5|%6")
+      .arg(arrayName)
+      .arg(view)
+      .arg(componentIndex)
+      .arg(range[0], 0, 'g', 17)
+      .arg(range[1], 0, 'g', 17)
+      .arg(lookupTableId);
+}
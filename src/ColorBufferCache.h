@@ -0,0 +1,56 @@
+#ifndef COLOR_BUFFER_CACHE_H
+#define COLOR_BUFFER_CACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+
+class vtkDataArray;
+class vtkIdTypeArray;
+class vtkScalarsToColors;
+
+// Already-mapped RGBA buffers keyed by (array, view, component, range, lookup
+// table), so returning to a previously viewed field skips scalar mapping.
+// Least recently used buffers are dropped beyond the byte budget.
+class ColorBufferCache {
+public:
+  explicit ColorBufferCache(qint64 maxBytes = 512LL * 1024 * 1024);
+
+  // Returns the colors of the array component (-1 for magnitude) mapped
+  // through the lookup table, which must already be set up for the range.
+  // With tupleIds only those tuples are mapped, in that order (e.g. the
+  // surface points of a grid). view tells apart buffers mapped from arrays
+  // of the same name (e.g. a point array and a cell array).
+  vtkSmartPointer<vtkUnsignedCharArray>
+  colors(vtkDataArray *array, int componentIndex, const double range[2],
+         vtkScalarsToColors *lookupTable, const QString &lookupTableId,
+         vtkIdTypeArray *tupleIds = nullptr, const QString &view = QString());
+
+  // Drops every buffer mapped from the named array (e.g. after a reload)
+  void removeArray(const QString &arrayName);
+  void clear();
+
+  void setMaxBytes(qint64 maxBytes);
+  qint64 totalBytes() const;
+
+private:
+  struct Entry {
+    vtkSmartPointer<vtkUnsignedCharArray> colors;
+  };
+
+  static QString makeKey(const QString &arrayName, const QString &view,
+                         int componentIndex, const double range[2],
+                         const QString &lookupTableId);
+
+  QCache<QString, Entry> entries;
+  // Keys of the buffers mapped from each array. Reading entries to find them
+  // would mark every one as recently used; keys of evicted buffers linger
+  // until the array maps its next buffer.
+  QHash<QString, QSet<QString>> keysByArray;
+};
+
+#endif // COLOR_BUFFER_CACHE_H
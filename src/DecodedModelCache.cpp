@@ -0,0 +1,805 @@
+#include "DecodedModelCache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QStandardPaths>
+
+#include <vtkAOSDataArrayTemplate.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkUnsignedCharArray.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include "PerfTrace.h"
+#include "PvtuReader.h"
+#include "VtuModelLoader.h"
+
+namespace {
+/* ENTRY LAYOUT */
+// [EntryHeader, padded to bufferAlignment][buffers, each aligned to
+// bufferAlignment][metadata (QDataStream)]. Buffers are raw native-endian
+// values; the cache is local to a machine.
+const char entryMagic[8] = {'V', 'T', 'U', 'D', 'M', 'C', '0', '1'};
+const quint32 entryVersion = 6;
+const quint32 byteOrderMark = 0x01020304;
+const qint64 bufferAlignment = 64;
+const qint64 writeChunkBytes = 64LL * 1024 * 1024;
+const QString entrySuffix = ".vdmc";
+
+struct EntryHeader {
+  char magic[8];
+  quint32 version;
+  quint32 byteOrderMark;
+  quint32 idTypeSize;
+  quint32 reserved;
+  quint64 metadataOffset;
+  quint64 metadataSize;
+};
+static_assert(sizeof(EntryHeader) <= bufferAlignment,
+              "The entry header must fit in front of the first buffer");
+
+// Location and shape of one array buffer; dataType VTK_VOID marks an absent
+// array
+struct BufferDescriptor {
+  QString name;
+  qint32 dataType = VTK_VOID;
+  qint32 numberOfComponents = 1;
+  qint64 numberOfTuples = 0;
+  qint64 offset = 0;
+  QVector<QString> componentNames;
+};
+
+struct CellArrayDescriptor {
+  BufferDescriptor offsets;
+  BufferDescriptor connectivity;
+};
+
+QDataStream &operator<<(QDataStream &stream, const BufferDescriptor &buffer) {
+  return stream << buffer.name << buffer.dataType << buffer.numberOfComponents
+                << buffer.numberOfTuples << buffer.offset
+                << buffer.componentNames;
+}
+
+QDataStream &operator>>(QDataStream &stream, BufferDescriptor &buffer) {
+  return stream >> buffer.name >> buffer.dataType >>
+         buffer.numberOfComponents >> buffer.numberOfTuples >> buffer.offset >>
+         buffer.componentNames;
+}
+
+QDataStream &operator<<(QDataStream &stream,
+                        const CellArrayDescriptor &cellArray) {
+  return stream << cellArray.offsets << cellArray.connectivity;
+}
+
+QDataStream &operator>>(QDataStream &stream, CellArrayDescriptor &cellArray) {
+  return stream >> cellArray.offsets >> cellArray.connectivity;
+}
+
+QDataStream &operator<<(QDataStream &stream,
+                        const VtuDataArrayDescriptor &descriptor) {
+  return stream << descriptor.name << descriptor.type << descriptor.format
+                << descriptor.numberOfComponents << descriptor.componentNames
+                << descriptor.offset << descriptor.extent
+                << descriptor.hasDeclaredRange << descriptor.rangeMin
+                << descriptor.rangeMax;
+}
+
+QDataStream &operator>>(QDataStream &stream,
+                        VtuDataArrayDescriptor &descriptor) {
+  return stream >> descriptor.name >> descriptor.type >> descriptor.format >>
+         descriptor.numberOfComponents >> descriptor.componentNames >>
+         descriptor.offset >> descriptor.extent >>
+         descriptor.hasDeclaredRange >> descriptor.rangeMin >>
+         descriptor.rangeMax;
+}
+
+QDataStream &operator<<(QDataStream &stream, const VtuHeader &header) {
+  stream << header.byteOrder << header.headerType << header.compressor
+         << header.appendedEncoding << header.numberOfPoints
+         << header.numberOfCells << header.numberOfPieces << header.points
+         << header.cellArrays << header.pointDataArrays
+         << header.cellDataArrays << header.pieceFilePaths
+         << static_cast<quint32>(header.pieceHeaders.size());
+  for (const VtuHeader &pieceHeader : header.pieceHeaders) {
+    stream << pieceHeader;
+  }
+  return stream;
+}
+
+QDataStream &operator>>(QDataStream &stream, VtuHeader &header) {
+  stream >> header.byteOrder >> header.headerType >> header.compressor >>
+      header.appendedEncoding >> header.numberOfPoints >>
+      header.numberOfCells >> header.numberOfPieces >> header.points >>
+      header.cellArrays >> header.pointDataArrays >> header.cellDataArrays >>
+      header.pieceFilePaths;
+  quint32 numberOfPieces = 0;
+  stream >> numberOfPieces;
+  if (stream.status() != QDataStream::Ok ||
+      numberOfPieces != static_cast<quint32>(header.pieceFilePaths.size())) {
+    stream.setStatus(QDataStream::ReadCorruptData);
+    return stream;
+  }
+  header.pieceHeaders.resize(numberOfPieces);
+  for (VtuHeader &pieceHeader : header.pieceHeaders) {
+    stream >> pieceHeader;
+  }
+  return stream;
+}
+
+/* MAPPED BUFFERS */
+// A mapped entry stays mapped while any VTK array still points into it.
+// vtkBuffer free functions receive only the buffer address, so the mapping
+// of every handed out buffer is looked up in a registry.
+struct MappedEntry {
+  QFile file;
+  uchar *data = nullptr;
+  qint64 size = 0;
+
+  ~MappedEntry() {
+    if (data != nullptr) {
+      file.unmap(data);
+    }
+  }
+};
+
+std::mutex &mappedBuffersMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+QHash<const void *, std::shared_ptr<MappedEntry>> &mappedBuffers() {
+  static QHash<const void *, std::shared_ptr<MappedEntry>> buffers;
+  return buffers;
+}
+
+void releaseMappedBuffer(void *buffer) {
+  std::shared_ptr<MappedEntry> entry;
+  {
+    std::lock_guard<std::mutex> lock(mappedBuffersMutex());
+    entry = mappedBuffers().take(buffer);
+  }
+  // The last released buffer unmaps the entry here, outside the lock
+}
+
+// Whether any array still points into the entry at the path
+bool isEntryMapped(const QString &entryPath) {
+  const QString path = QFileInfo(entryPath).absoluteFilePath();
+  std::lock_guard<std::mutex> lock(mappedBuffersMutex());
+  for (const std::shared_ptr<MappedEntry> &entry : mappedBuffers()) {
+    if (QFileInfo(entry->file).absoluteFilePath() == path) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename ValueT>
+void adoptMappedBuffer(vtkDataArray *array, void *buffer,
+                       vtkIdType numberOfValues) {
+  auto *typedArray = static_cast<vtkAOSDataArrayTemplate<ValueT> *>(array);
+  typedArray->SetArray(static_cast<ValueT *>(buffer), numberOfValues, 0,
+                       vtkAbstractArray::VTK_DATA_ARRAY_USER_DEFINED);
+  typedArray->SetArrayFreeFunction(releaseMappedBuffer);
+}
+
+// Returns nullptr for an absent array; ok is false for a damaged descriptor
+vtkSmartPointer<vtkDataArray>
+wrapBuffer(const BufferDescriptor &buffer,
+           const std::shared_ptr<MappedEntry> &entry, bool &ok) {
+  ok = true;
+  if (buffer.dataType == VTK_VOID) {
+    return nullptr;
+  }
+  vtkSmartPointer<vtkDataArray> array = vtkSmartPointer<vtkDataArray>::Take(
+      vtkDataArray::CreateDataArray(buffer.dataType));
+  const qint64 numberOfValues =
+      buffer.numberOfTuples * static_cast<qint64>(buffer.numberOfComponents);
+  if (array == nullptr || !array->HasStandardMemoryLayout() ||
+      buffer.numberOfComponents <= 0 || buffer.numberOfTuples < 0 ||
+      buffer.offset % bufferAlignment != 0 || buffer.offset < 0 ||
+      numberOfValues > (entry->size - buffer.offset) /
+                           std::max(1, array->GetDataTypeSize())) {
+    ok = false;
+    return nullptr;
+  }
+  if (!buffer.name.isEmpty()) {
+    array->SetName(buffer.name.toStdString().c_str());
+  }
+  array->SetNumberOfComponents(buffer.numberOfComponents);
+  for (int c = 0; c < buffer.componentNames.size(); ++c) {
+    if (!buffer.componentNames[c].isEmpty()) {
+      array->SetComponentName(c,
+                              buffer.componentNames[c].toStdString().c_str());
+    }
+  }
+  if (numberOfValues == 0) {
+    return array; // Nothing to map (and no address to register)
+  }
+
+  void *data = entry->data + buffer.offset;
+  {
+    std::lock_guard<std::mutex> lock(mappedBuffersMutex());
+    mappedBuffers().insert(data, entry);
+  }
+  switch (buffer.dataType) {
+    vtkTemplateMacro(adoptMappedBuffer<VTK_TT>(array, data, numberOfValues));
+  default:
+    releaseMappedBuffer(data);
+    ok = false;
+    return nullptr;
+  }
+  return array;
+}
+
+vtkSmartPointer<vtkCellArray>
+wrapCellArray(const CellArrayDescriptor &cellArray,
+              const std::shared_ptr<MappedEntry> &entry, bool &ok) {
+  bool offsetsOk = false;
+  bool connectivityOk = false;
+  vtkSmartPointer<vtkDataArray> offsets =
+      wrapBuffer(cellArray.offsets, entry, offsetsOk);
+  vtkSmartPointer<vtkDataArray> connectivity =
+      wrapBuffer(cellArray.connectivity, entry, connectivityOk);
+  ok = offsetsOk && connectivityOk;
+  if (!ok || offsets == nullptr || connectivity == nullptr) {
+    return nullptr;
+  }
+  vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+  ok = cells->SetData(offsets, connectivity);
+  return ok ? cells : nullptr;
+}
+
+/* ENTRY WRITING */
+class EntryWriter {
+public:
+  EntryWriter(QSaveFile &file, const std::atomic_bool &cancelRequested)
+      : file(file), cancelRequested(cancelRequested) {}
+
+  // Appends the array's values at the next aligned offset; a null array is
+  // recorded as absent
+  bool writeArray(vtkDataArray *array, BufferDescriptor &buffer,
+                  QString &errorMessage) {
+    buffer = BufferDescriptor();
+    if (array == nullptr) {
+      return true;
+    }
+    if (!array->HasStandardMemoryLayout()) {
+      errorMessage = "Array layout cannot be cached: " +
+                     QString::fromStdString(array->GetName() != nullptr
+                                                ? array->GetName()
+                                                : "(unnamed)");
+      return false;
+    }
+    if (array->GetName() != nullptr) {
+      buffer.name = QString::fromStdString(array->GetName());
+    }
+    buffer.dataType = array->GetDataType();
+    buffer.numberOfComponents = array->GetNumberOfComponents();
+    buffer.numberOfTuples = array->GetNumberOfTuples();
+    for (int c = 0; c < buffer.numberOfComponents; ++c) {
+      const char *componentName = array->GetComponentName(c);
+      buffer.componentNames.push_back(
+          componentName != nullptr ? QString::fromStdString(componentName)
+                                   : QString());
+    }
+    if (!align(errorMessage)) {
+      return false;
+    }
+    buffer.offset = position;
+
+    const char *data = static_cast<const char *>(array->GetVoidPointer(0));
+    const qint64 bytes = static_cast<qint64>(array->GetNumberOfValues()) *
+                         array->GetDataTypeSize();
+    for (qint64 written = 0; written < bytes; written += writeChunkBytes) {
+      if (cancelRequested.load()) {
+        return false;
+      }
+      if (!write(data + written, std::min(writeChunkBytes, bytes - written),
+                 errorMessage)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool writeCellArray(vtkCellArray *cells, CellArrayDescriptor &cellArray,
+                      QString &errorMessage) {
+    if (cells == nullptr) {
+      cellArray = CellArrayDescriptor();
+      return true;
+    }
+    return writeArray(cells->GetOffsetsArray(), cellArray.offsets,
+                      errorMessage) &&
+           writeArray(cells->GetConnectivityArray(), cellArray.connectivity,
+                      errorMessage);
+  }
+
+  bool writeMetadata(const QByteArray &metadata, QString &errorMessage) {
+    if (!align(errorMessage)) {
+      return false;
+    }
+    EntryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, entryMagic, sizeof(entryMagic));
+    header.version = entryVersion;
+    header.byteOrderMark = byteOrderMark;
+    header.idTypeSize = sizeof(vtkIdType);
+    header.metadataOffset = static_cast<quint64>(position);
+    header.metadataSize = static_cast<quint64>(metadata.size());
+    if (!write(metadata.constData(), metadata.size(), errorMessage)) {
+      return false;
+    }
+    // The header goes in last so that an interrupted write never looks valid
+    if (!file.seek(0) ||
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header)) !=
+            static_cast<qint64>(sizeof(header))) {
+      errorMessage = "Failed to write decoded model cache entry:\n" +
+                     file.fileName();
+      return false;
+    }
+    return true;
+  }
+
+  bool reserveHeader(QString &errorMessage) {
+    const QByteArray placeholder(bufferAlignment, '\0');
+    return write(placeholder.constData(), placeholder.size(), errorMessage);
+  }
+
+private:
+  bool align(QString &errorMessage) {
+    const qint64 padding =
+        (bufferAlignment - position % bufferAlignment) % bufferAlignment;
+    const QByteArray zeros(padding, '\0');
+    return write(zeros.constData(), padding, errorMessage);
+  }
+
+  bool write(const char *data, qint64 bytes, QString &errorMessage) {
+    if (bytes > 0 && file.write(data, bytes) != bytes) {
+      errorMessage = "Failed to write decoded model cache entry:\n" +
+                     file.fileName();
+      return false;
+    }
+    position += bytes;
+    return true;
+  }
+
+  QSaveFile &file;
+  const std::atomic_bool &cancelRequested;
+  qint64 position = 0;
+};
+
+LoadedVtuModel *readEntry(const QString &entryPath, const QString &filePath,
+                          const QFileInfo &sourceInfo,
+                          const VtuLoadOptions &options) {
+  auto entry = std::make_shared<MappedEntry>();
+  entry->file.setFileName(entryPath);
+  if (!entry->file.open(QIODevice::ReadOnly)) {
+    return nullptr;
+  }
+  entry->size = entry->file.size();
+  if (entry->size < bufferAlignment) {
+    return nullptr;
+  }
+  // Private mapping: buffers may be modified in place without touching the
+  // entry on disk
+  entry->data =
+      entry->file.map(0, entry->size, QFileDevice::MapPrivateOption);
+  if (entry->data == nullptr) {
+    return nullptr;
+  }
+
+  EntryHeader header;
+  std::memcpy(&header, entry->data, sizeof(header));
+  if (std::memcmp(header.magic, entryMagic, sizeof(entryMagic)) != 0 ||
+      header.version != entryVersion ||
+      header.byteOrderMark != byteOrderMark ||
+      header.idTypeSize != sizeof(vtkIdType) ||
+      header.metadataOffset > static_cast<quint64>(entry->size) ||
+      header.metadataSize > entry->size - header.metadataOffset) {
+    return nullptr;
+  }
+
+  const QByteArray metadata = QByteArray::fromRawData(
+      reinterpret_cast<const char *>(entry->data + header.metadataOffset),
+      static_cast<int>(header.metadataSize));
+  QDataStream stream(metadata);
+  stream.setVersion(QDataStream::Qt_6_0);
+
+  QString sourcePath;
+  qint64 sourceSize = 0;
+  qint64 sourceModified = 0;
+  QScopedPointer<LoadedVtuModel> model(new LoadedVtuModel());
+  BufferDescriptor gridPoints;
+  CellArrayDescriptor gridCells;
+  BufferDescriptor gridCellTypes;
+  QVector<BufferDescriptor> gridCellData;
+  QVector<BufferDescriptor> gridPointData;
+  BufferDescriptor surfacePoints;
+  CellArrayDescriptor surfaceCells[4]; // Verts, lines, polys, strips
+  BufferDescriptor surfacePointIds;
+  BufferDescriptor surfaceCellIds;
+  QVector<QString> arrayNames;
+  QVector<QVector<QString>> componentNames;
+  stream >> sourcePath >> sourceSize >> sourceModified >> model->header >>
+      gridPoints >> gridCells >> gridCellTypes >> gridCellData >>
+      gridPointData >> surfacePoints;
+  for (CellArrayDescriptor &cells : surfaceCells) {
+    stream >> cells;
+  }
+  stream >> surfacePointIds >> surfaceCellIds >> arrayNames >>
+      componentNames;
+  if (stream.status() != QDataStream::Ok ||
+      !model->pointArrayRanges.readFrom(stream) ||
+      arrayNames.size() != componentNames.size() ||
+      sourcePath != sourceInfo.canonicalFilePath() ||
+      sourceSize != sourceInfo.size() ||
+      sourceModified != sourceInfo.lastModified().toMSecsSinceEpoch()) {
+    return nullptr;
+  }
+
+  /* Grid */
+  bool ok = false;
+  vtkSmartPointer<vtkDataArray> pointsArray =
+      wrapBuffer(gridPoints, entry, ok);
+  if (!ok || pointsArray == nullptr) {
+    return nullptr;
+  }
+  vtkSmartPointer<vtkCellArray> cells = wrapCellArray(gridCells, entry, ok);
+  if (!ok || cells == nullptr) {
+    return nullptr;
+  }
+  vtkSmartPointer<vtkDataArray> typesArray =
+      wrapBuffer(gridCellTypes, entry, ok);
+  vtkUnsignedCharArray *cellTypes =
+      vtkUnsignedCharArray::SafeDownCast(typesArray);
+  if (!ok || cellTypes == nullptr) {
+    return nullptr;
+  }
+  vtkNew<vtkPoints> points;
+  points->SetData(pointsArray);
+  model->grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  model->grid->SetPoints(points);
+  model->grid->SetCells(cellTypes, cells);
+  for (const BufferDescriptor &buffer : gridCellData) {
+    vtkSmartPointer<vtkDataArray> array = wrapBuffer(buffer, entry, ok);
+    if (!ok || array == nullptr) {
+      return nullptr;
+    }
+    model->grid->GetCellData()->AddArray(array);
+  }
+  for (const BufferDescriptor &buffer : gridPointData) {
+    vtkSmartPointer<vtkDataArray> array = wrapBuffer(buffer, entry, ok);
+    if (!ok || array == nullptr ||
+        array->GetNumberOfTuples() != model->grid->GetNumberOfPoints()) {
+      return nullptr;
+    }
+    model->grid->GetPointData()->AddArray(array);
+  }
+
+  /* Surface */
+  vtkSmartPointer<vtkDataArray> surfacePointsArray =
+      wrapBuffer(surfacePoints, entry, ok);
+  if (!ok || surfacePointsArray == nullptr) {
+    return nullptr;
+  }
+  vtkNew<vtkPoints> surfacePointsData;
+  surfacePointsData->SetData(surfacePointsArray);
+  model->surface = vtkSmartPointer<vtkPolyData>::New();
+  model->surface->SetPoints(surfacePointsData);
+  vtkSmartPointer<vtkCellArray> surfaceCellArrays[4];
+  for (int i = 0; i < 4; ++i) {
+    surfaceCellArrays[i] = wrapCellArray(surfaceCells[i], entry, ok);
+    if (!ok) {
+      return nullptr;
+    }
+  }
+  model->surface->SetVerts(surfaceCellArrays[0]);
+  model->surface->SetLines(surfaceCellArrays[1]);
+  model->surface->SetPolys(surfaceCellArrays[2]);
+  model->surface->SetStrips(surfaceCellArrays[3]);
+  vtkSmartPointer<vtkDataArray> surfacePointIdsArray =
+      wrapBuffer(surfacePointIds, entry, ok);
+  model->surfacePointIds = vtkIdTypeArray::SafeDownCast(surfacePointIdsArray);
+  if (!ok || model->surfacePointIds == nullptr) {
+    return nullptr;
+  }
+  vtkSmartPointer<vtkDataArray> surfaceCellIdsArray =
+      wrapBuffer(surfaceCellIds, entry, ok);
+  model->surfaceCellIds = vtkIdTypeArray::SafeDownCast(surfaceCellIdsArray);
+  if (!ok || model->surfaceCellIds == nullptr) {
+    return nullptr;
+  }
+
+  for (int i = 0; i < arrayNames.size(); ++i) {
+    model->pointArraysInfo.push_back(
+        PointArrayInfo(arrayNames[i], componentNames[i]));
+  }
+  VtuModelLoader::catalogCellArrays(*model);
+  model->filePath = filePath;
+  model->options = options;
+  // Mapped arrays are backed by the entry and cost no memory until touched;
+  // dropping them would only force decoding them from the file again. Arrays
+  // the entry lacks are decoded into memory and fall under the budget.
+  model->mappedFromCache = gridPointData.size() == arrayNames.size();
+  return model.take();
+}
+} // namespace
+
+DecodedModelCache::DecodedModelCache(const QString &directory,
+                                     qint64 maxBytes)
+    : directory(directory), maxBytes(maxBytes) {}
+
+QString DecodedModelCache::defaultDirectory() {
+  return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+      .filePath("decoded-models");
+}
+
+LoadedVtuModel *DecodedModelCache::open(const QString &filePath,
+                                        const VtuLoadOptions &options,
+                                        QString &errorMessage) const {
+  PerfTrace::Scope scope("cache", "Open cached model");
+  const QString path = entryPath(filePath, options.float32);
+  if (path.isEmpty() || !QFileInfo::exists(path)) {
+    return nullptr;
+  }
+
+  LoadedVtuModel *model =
+      readEntry(path, filePath, QFileInfo(filePath), options);
+  if (model == nullptr) {
+    // Every buffer of the failed read is released by now
+    errorMessage = "Ignoring a damaged decoded model cache entry:\n" + path;
+    if (!isEntryMapped(path)) {
+      QFile::remove(path);
+    }
+    return nullptr;
+  }
+
+  // Opening counts as use for pruning
+  QFile entryFile(path);
+  if (entryFile.open(QIODevice::Append)) {
+    entryFile.setFileTime(QDateTime::currentDateTime(),
+                          QFileDevice::FileModificationTime);
+  }
+  return model;
+}
+
+DecodedModelSnapshot DecodedModelCache::snapshot(const LoadedVtuModel &model) {
+  DecodedModelSnapshot snapshot;
+  snapshot.filePath = model.filePath;
+  snapshot.header = model.header;
+  if (model.grid != nullptr) {
+    snapshot.grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    snapshot.grid->CopyStructure(model.grid);
+    snapshot.grid->GetCellData()->ShallowCopy(model.grid->GetCellData());
+    vtkPointData *pointData = model.grid->GetPointData();
+    for (int i = 0; i < pointData->GetNumberOfArrays(); ++i) {
+      if (vtkDataArray *array = pointData->GetArray(i)) {
+        snapshot.pointArrays.push_back(array);
+      }
+    }
+  }
+  snapshot.pointArraysInfo = model.pointArraysInfo;
+  snapshot.pointArrayRanges = model.pointArrayRanges;
+  if (model.surface != nullptr) {
+    snapshot.surface = vtkSmartPointer<vtkPolyData>::New();
+    snapshot.surface->CopyStructure(model.surface);
+  }
+  snapshot.surfacePointIds = model.surfacePointIds;
+  snapshot.surfaceCellIds = model.surfaceCellIds;
+  snapshot.float32 = model.options.float32;
+  return snapshot;
+}
+
+bool DecodedModelCache::store(const DecodedModelSnapshot &snapshot,
+                              const std::atomic_bool &cancelRequested,
+                              QString &errorMessage) const {
+  PerfTrace::Scope scope("cache", "Store decoded model");
+  if (snapshot.grid == nullptr || snapshot.surface == nullptr ||
+      snapshot.surfacePointIds == nullptr ||
+      snapshot.surfaceCellIds == nullptr) {
+    errorMessage = "Incomplete model cannot be cached.";
+    return false;
+  }
+  // Polyhedra also need their face streams; such grids are not cached
+  vtkUnsignedCharArray *cellTypes = snapshot.grid->GetCellTypesArray();
+  if (cellTypes == nullptr ||
+      std::find(cellTypes->GetPointer(0),
+                cellTypes->GetPointer(0) + cellTypes->GetNumberOfValues(),
+                static_cast<unsigned char>(VTK_POLYHEDRON)) !=
+          cellTypes->GetPointer(0) + cellTypes->GetNumberOfValues()) {
+    errorMessage = "Grids with polyhedral cells are not cached.";
+    return false;
+  }
+
+  const QString path = entryPath(snapshot.filePath, snapshot.float32);
+  if (path.isEmpty() || !QDir().mkpath(directory)) {
+    errorMessage = "Cannot create decoded model cache directory:\n" + directory;
+    return false;
+  }
+  if (isEntryMapped(path)) {
+    errorMessage = "Decoded model cache entry is in use:\n" + path;
+    return false;
+  }
+  const QFileInfo sourceInfo(snapshot.filePath);
+
+  // QSaveFile writes to a temporary file and renames it on commit, so an
+  // entry is either complete or absent
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    errorMessage = "Cannot write decoded model cache entry:\n" + path;
+    return false;
+  }
+  EntryWriter writer(file, cancelRequested);
+  if (!writer.reserveHeader(errorMessage)) {
+    file.cancelWriting();
+    return false;
+  }
+
+  /* Grid */
+  BufferDescriptor gridPoints;
+  CellArrayDescriptor gridCells;
+  BufferDescriptor gridCellTypes;
+  bool ok = writer.writeArray(snapshot.grid->GetPoints()->GetData(),
+                              gridPoints, errorMessage) &&
+            writer.writeCellArray(snapshot.grid->GetCells(), gridCells,
+                                  errorMessage) &&
+            writer.writeArray(cellTypes, gridCellTypes, errorMessage);
+  QVector<BufferDescriptor> gridCellData;
+  vtkCellData *cellData = snapshot.grid->GetCellData();
+  for (int i = 0; ok && i < cellData->GetNumberOfArrays(); ++i) {
+    if (vtkDataArray *array = cellData->GetArray(i)) {
+      gridCellData.push_back(BufferDescriptor());
+      ok = writer.writeArray(array, gridCellData.back(), errorMessage);
+    }
+  }
+
+  // The whole catalog, but only the arrays the model had decoded; the
+  // others are decoded from the file once the entry is opened
+  QVector<BufferDescriptor> gridPointData;
+  QVector<QString> arrayNames;
+  QVector<QVector<QString>> componentNames;
+  for (const PointArrayInfo &arrayInfo : snapshot.pointArraysInfo) {
+    if (!ok || cancelRequested.load()) {
+      ok = false;
+      break;
+    }
+    for (const vtkSmartPointer<vtkDataArray> &decodedArray :
+         snapshot.pointArrays) {
+      if (arrayInfo.name == decodedArray->GetName()) {
+        gridPointData.push_back(BufferDescriptor());
+        ok = writer.writeArray(decodedArray, gridPointData.back(),
+                               errorMessage);
+        break;
+      }
+    }
+    arrayNames.push_back(arrayInfo.name);
+    componentNames.push_back(arrayInfo.componentNames);
+  }
+
+  /* Surface */
+  BufferDescriptor surfacePoints;
+  CellArrayDescriptor surfaceCells[4];
+  BufferDescriptor surfacePointIds;
+  BufferDescriptor surfaceCellIds;
+  vtkPolyData *surface = snapshot.surface;
+  ok = ok &&
+       writer.writeArray(surface->GetPoints()->GetData(), surfacePoints,
+                         errorMessage) &&
+       writer.writeCellArray(surface->GetVerts(), surfaceCells[0],
+                             errorMessage) &&
+       writer.writeCellArray(surface->GetLines(), surfaceCells[1],
+                             errorMessage) &&
+       writer.writeCellArray(surface->GetPolys(), surfaceCells[2],
+                             errorMessage) &&
+       writer.writeCellArray(surface->GetStrips(), surfaceCells[3],
+                             errorMessage) &&
+       writer.writeArray(snapshot.surfacePointIds, surfacePointIds,
+                         errorMessage) &&
+       writer.writeArray(snapshot.surfaceCellIds, surfaceCellIds,
+                         errorMessage);
+
+  if (ok) {
+    QByteArray metadata;
+    QDataStream stream(&metadata, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << sourceInfo.canonicalFilePath() << sourceInfo.size()
+           << sourceInfo.lastModified().toMSecsSinceEpoch() << snapshot.header
+           << gridPoints << gridCells << gridCellTypes << gridCellData
+           << gridPointData << surfacePoints;
+    for (const CellArrayDescriptor &cells : surfaceCells) {
+      stream << cells;
+    }
+    stream << surfacePointIds << surfaceCellIds << arrayNames
+           << componentNames;
+    snapshot.pointArrayRanges.writeTo(stream);
+    ok = writer.writeMetadata(metadata, errorMessage);
+  }
+  if (!ok || !file.commit()) {
+    file.cancelWriting();
+    if (errorMessage.isEmpty() && !cancelRequested.load()) {
+      errorMessage = "Failed to write decoded model cache entry:\n" + path;
+    }
+    return false;
+  }
+
+  prune();
+  return true;
+}
+
+void DecodedModelCache::prune() const {
+  if (maxBytes <= 0) {
+    return;
+  }
+  // Most recently used first
+  QFileInfoList entries =
+      QDir(directory).entryInfoList({"*" + entrySuffix}, QDir::Files,
+                                    QDir::Time);
+  qint64 keptBytes = 0;
+  for (const QFileInfo &entry : entries) {
+    keptBytes += entry.size();
+    // The newest entry is kept even if it alone exceeds the budget, and so
+    // are entries that are still mapped
+    if (keptBytes > maxBytes && entry != entries.first() &&
+        !isEntryMapped(entry.filePath())) {
+      QFile::remove(entry.filePath());
+      keptBytes -= entry.size();
+    }
+  }
+}
+
+qint64 DecodedModelCache::totalBytes() const {
+  qint64 bytes = 0;
+  for (const QFileInfo &entry : QDir(directory).entryInfoList(
+           {"*" + entrySuffix}, QDir::Files)) {
+    bytes += entry.size();
+  }
+  return bytes;
+}
+
+QString
+DecodedModelCache::entryPath(const QString &filePath,
+                             const Float32Selection &float32) const {
+  const QFileInfo sourceInfo(filePath);
+  const QString canonicalPath = sourceInfo.canonicalFilePath();
+  if (canonicalPath.isEmpty()) {
+    return QString();
+  }
+  QString key = QString("%1|%2|%3")
+                    .arg(canonicalPath)
+                    .arg(sourceInfo.size())
+                    .arg(sourceInfo.lastModified().toMSecsSinceEpoch());
+  // A partitioned file changes whenever one of its pieces does
+  QStringList pieceFilePaths;
+  QString pieceErrorMessage;
+  if (PvtuReader::isPvtuPath(filePath) &&
+      PvtuReader::readPieceFilePaths(filePath, pieceFilePaths,
+                                     pieceErrorMessage)) {
+    for (const QString &pieceFilePath : pieceFilePaths) {
+      const QFileInfo pieceInfo(pieceFilePath);
+      key += QString("|%1|%2").arg(pieceInfo.size()).arg(
+          pieceInfo.lastModified().toMSecsSinceEpoch());
+    }
+  }
+  if (!float32.isEmpty()) {
+    key += "|" + float32.key();
+  }
+  const QByteArray hash =
+      QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1);
+  return QDir(directory).filePath(QString::fromLatin1(hash.toHex()) +
+                                  entrySuffix);
+}
@@ -0,0 +1,84 @@
+#ifndef DECODED_MODEL_CACHE_H
+#define DECODED_MODEL_CACHE_H
+
+#include <QString>
+#include <QVector>
+
+#include <vtkDataArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <atomic>
+
+#include "ArrayRangeCache.h"
+#include "Float32Conversion.h"
+#include "PointArrayInfo.h"
+#include "VtuHeaderScanner.h"
+
+struct LoadedVtuModel;
+struct VtuLoadOptions;
+
+// Everything a cache entry is written from. The grid and the surface are
+// data sets of the snapshot's own that only add references to the model's
+// arrays (which are replaced, never changed in place), so the model may be
+// handed on and used while the snapshot is written.
+struct DecodedModelSnapshot {
+  QString filePath;
+  VtuHeader header;
+  vtkSmartPointer<vtkUnstructuredGrid> grid; // Structure and cell data
+  QVector<vtkSmartPointer<vtkDataArray>> pointArrays; // Decoded so far
+  QVector<PointArrayInfo> pointArraysInfo;
+  ArrayRangeCache pointArrayRanges;
+  vtkSmartPointer<vtkPolyData> surface; // Structure only
+  vtkSmartPointer<vtkIdTypeArray> surfacePointIds;
+  vtkSmartPointer<vtkIdTypeArray> surfaceCellIds;
+  Float32Selection float32;
+};
+
+// Fully decoded models on disk, keyed by the source file's path, size and
+// modification time and by the Float32 selection they were decoded with. An
+// entry is a flat file of 64-byte aligned raw array buffers followed by a
+// metadata block. Opening an entry memory-maps it and hands the buffers to
+// VTK arrays without copying, so reopening costs page faults on the data
+// actually touched rather than parsing and inflating. Entries this process
+// has mapped are never removed or replaced, as Windows refuses both.
+class DecodedModelCache {
+public:
+  // Entries beyond maxBytes are pruned, least recently opened first (0 keeps
+  // every entry)
+  explicit DecodedModelCache(const QString &directory, qint64 maxBytes = 0);
+
+  // Per-user cache location of the application
+  static QString defaultDirectory();
+
+  // Returns nullptr on a miss. errorMessage is set only for an entry that
+  // exists but cannot be used (it is removed and rewritten on the next
+  // store). The model holds the point arrays the entry was written with;
+  // any other array of its catalog has to be decoded from the file.
+  LoadedVtuModel *open(const QString &filePath, const VtuLoadOptions &options,
+                       QString &errorMessage) const;
+
+  static DecodedModelSnapshot snapshot(const LoadedVtuModel &model);
+
+  // Writes the entry for the snapshot's file with the mesh, the surface and
+  // the point arrays the snapshot holds. Arrays a lazily loaded model has
+  // not decoded are not read from the file for the entry.
+  bool store(const DecodedModelSnapshot &snapshot,
+             const std::atomic_bool &cancelRequested,
+             QString &errorMessage) const;
+
+  void prune() const;
+  qint64 totalBytes() const;
+
+private:
+  QString entryPath(const QString &filePath,
+                    const Float32Selection &float32) const;
+
+private:
+  QString directory;
+  qint64 maxBytes;
+};
+
+#endif // DECODED_MODEL_CACHE_H
@@ -0,0 +1,146 @@
+#include "DisplacementWarp.h"
+
+#include <vtkArrayDispatch.h>
+#include <vtkDataArray.h>
+#include <vtkDataArrayRange.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+
+#include <cmath>
+#include <cstring>
+
+namespace {
+struct WarpWorker {
+  template <typename PointsT, typename DisplacementT>
+  void operator()(PointsT *points, DisplacementT *displacement, double scale,
+                  const vtkIdType *ids, vtkDataArray *warpedPoints) const {
+    // The warped points share the data type of the source points
+    PointsT *warped = static_cast<PointsT *>(warpedPoints);
+    using ValueT = vtk::GetAPIType<PointsT>;
+    const auto source = vtk::DataArrayTupleRange<3>(points);
+    const auto offsets = vtk::DataArrayTupleRange<3>(displacement);
+    auto destination = vtk::DataArrayTupleRange<3>(warped);
+    vtkSMPTools::For(0, destination.size(), [&](vtkIdType begin,
+                                                vtkIdType end) {
+      for (vtkIdType i = begin; i < end; ++i) {
+        const auto point = source[ids[i]];
+        const auto offset = offsets[ids[i]];
+        auto warpedPoint = destination[i];
+        for (int c = 0; c < 3; ++c) {
+          warpedPoint[c] = static_cast<ValueT>(
+              point[c] + scale * static_cast<double>(offset[c]));
+        }
+      }
+    });
+  }
+};
+
+struct GatherWorker {
+  template <typename PointsT>
+  void operator()(PointsT *points, const vtkIdType *ids,
+                  vtkDataArray *gatheredPoints) const {
+    PointsT *gathered = static_cast<PointsT *>(gatheredPoints);
+    const auto source = vtk::DataArrayTupleRange<3>(points);
+    auto destination = vtk::DataArrayTupleRange<3>(gathered);
+    vtkSMPTools::For(0, destination.size(),
+                     [&](vtkIdType begin, vtkIdType end) {
+                       for (vtkIdType i = begin; i < end; ++i) {
+                         const auto point = source[ids[i]];
+                         auto gatheredPoint = destination[i];
+                         for (int c = 0; c < 3; ++c) {
+                           gatheredPoint[c] = point[c];
+                         }
+                       }
+                     });
+  }
+};
+
+// Gives target the data type of source (a no-op if it already has it) and
+// the given number of points
+void preparePoints(vtkPoints *source, vtkPoints *target,
+                   vtkIdType numberOfPoints) {
+  if (std::strcmp(target->GetData()->GetClassName(),
+                  source->GetData()->GetClassName()) != 0) {
+    vtkSmartPointer<vtkDataArray> data =
+        vtkSmartPointer<vtkDataArray>::Take(source->GetData()->NewInstance());
+    data->SetNumberOfComponents(3);
+    target->SetData(data);
+  }
+  if (target->GetNumberOfPoints() != numberOfPoints) {
+    target->SetNumberOfPoints(numberOfPoints);
+  }
+}
+} // namespace
+
+int DisplacementWarp::findDisplacementArray(
+    const QVector<PointArrayInfo> &pointArraysInfo) {
+  int containingIndex = -1;
+  for (int i = 0; i < pointArraysInfo.size(); ++i) {
+    const QString &name = pointArraysInfo[i].name;
+    if (name.compare("Displacement", Qt::CaseInsensitive) == 0) {
+      return i;
+    }
+    if (containingIndex < 0 &&
+        name.contains("displacement", Qt::CaseInsensitive)) {
+      containingIndex = i;
+    }
+  }
+  return containingIndex;
+}
+
+double DisplacementWarp::referenceScale(const double bounds[6],
+                                        double maxMagnitude, double fraction) {
+  const double diagonal =
+      std::sqrt((bounds[1] - bounds[0]) * (bounds[1] - bounds[0]) +
+                (bounds[3] - bounds[2]) * (bounds[3] - bounds[2]) +
+                (bounds[5] - bounds[4]) * (bounds[5] - bounds[4]));
+  if (!(maxMagnitude > 0.0) || !(diagonal > 0.0)) {
+    return 1.0;
+  }
+  return fraction * diagonal / maxMagnitude;
+}
+
+bool DisplacementWarp::warpPoints(vtkPoints *points,
+                                  vtkDataArray *displacement, double scale,
+                                  vtkIdTypeArray *pointIds,
+                                  vtkPoints *warpedPoints) {
+  if (points == nullptr || displacement == nullptr || pointIds == nullptr ||
+      warpedPoints == nullptr || displacement->GetNumberOfComponents() != 3) {
+    return false;
+  }
+  preparePoints(points, warpedPoints, pointIds->GetNumberOfTuples());
+
+  WarpWorker worker;
+  vtkDataArray *source = points->GetData();
+  const vtkIdType *ids = pointIds->GetPointer(0);
+  using Dispatcher =
+      vtkArrayDispatch::Dispatch2ByValueType<vtkArrayDispatch::Reals,
+                                             vtkArrayDispatch::Reals>;
+  if (!Dispatcher::Execute(source, displacement, worker, scale, ids,
+                           warpedPoints->GetData())) {
+    // Generic vtkDataArray fallback
+    worker(source, displacement, scale, ids, warpedPoints->GetData());
+  }
+  warpedPoints->Modified();
+  return true;
+}
+
+void DisplacementWarp::gatherPoints(vtkPoints *points,
+                                    vtkIdTypeArray *pointIds,
+                                    vtkPoints *gatheredPoints) {
+  if (points == nullptr || pointIds == nullptr || gatheredPoints == nullptr) {
+    return;
+  }
+  preparePoints(points, gatheredPoints, pointIds->GetNumberOfTuples());
+
+  GatherWorker worker;
+  vtkDataArray *source = points->GetData();
+  const vtkIdType *ids = pointIds->GetPointer(0);
+  if (!vtkArrayDispatch::DispatchByValueType<vtkArrayDispatch::Reals>::
+          Execute(source, worker, ids, gatheredPoints->GetData())) {
+    worker(source, ids, gatheredPoints->GetData()); // Generic fallback
+  }
+  gatheredPoints->Modified();
+}
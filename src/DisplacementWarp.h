@@ -0,0 +1,42 @@
+#ifndef DISPLACEMENT_WARP_H
+#define DISPLACEMENT_WARP_H
+
+#include <QVector>
+
+#include "PointArrayInfo.h"
+
+class vtkDataArray;
+class vtkIdTypeArray;
+class vtkPoints;
+
+// Deformed shape: points moved by a scaled displacement point array. Only the
+// coordinates are written, so the topology and colors of a warped surface
+// stay valid and renderers re-upload just the positions.
+class DisplacementWarp {
+public:
+  // Index of the array to warp by: the point array named "Displacement" or,
+  // failing that, the first one whose name contains it (case-insensitive).
+  // -1 if there is none.
+  static int findDisplacementArray(
+      const QVector<PointArrayInfo> &pointArraysInfo);
+
+  // Scale factor at which the largest displacement (maxMagnitude) is the
+  // given fraction of the bounding box diagonal; 1 without displacements
+  static double referenceScale(const double bounds[6], double maxMagnitude,
+                               double fraction = 0.1);
+
+  // warpedPoints[i] = points[pointIds[i]] + scale * displacement[pointIds[i]]
+  // in parallel. warpedPoints is resized to pointIds and takes the data type
+  // of points.
+  // Returns false if displacement has no three components.
+  static bool warpPoints(vtkPoints *points, vtkDataArray *displacement,
+                         double scale, vtkIdTypeArray *pointIds,
+                         vtkPoints *warpedPoints);
+
+  // warpedPoints[i] = points[pointIds[i]] (e.g. the proxy points of a warped
+  // surface)
+  static void gatherPoints(vtkPoints *points, vtkIdTypeArray *pointIds,
+                           vtkPoints *gatheredPoints);
+};
+
+#endif // DISPLACEMENT_WARP_H
@@ -0,0 +1,61 @@
+#include "Float32Conversion.h"
+
+#include <vtkDoubleArray.h>
+#include <vtkSMPTools.h>
+
+namespace {
+// Values per task; large enough to amortize scheduling, small enough to
+// spread a single array over every thread
+const vtkIdType valuesPerTask = 256 * 1024;
+
+// A plain loop over contiguous buffers, which compilers vectorize into
+// packed double-to-float conversions
+void narrowValues(const double *source, float *destination,
+                  vtkIdType numberOfValues) {
+  for (vtkIdType i = 0; i < numberOfValues; ++i) {
+    destination[i] = static_cast<float>(source[i]);
+  }
+}
+} // namespace
+
+bool Float32Selection::includesPointArray(const QString &arrayName) const {
+  return pointArrays.contains(arrayName) || pointArrays.contains("*");
+}
+
+QString Float32Selection::key() const {
+  if (isEmpty()) {
+    return QString();
+  }
+  QStringList sortedArrays = pointArrays;
+  sortedArrays.sort();
+  return QString("float32:%1:%2")
+      .arg(points ? "points" : "")
+      .arg(sortedArrays.join(','));
+}
+
+vtkSmartPointer<vtkFloatArray> Float32Conversion::convert(vtkDataArray *array) {
+  vtkDoubleArray *doubleArray = vtkDoubleArray::SafeDownCast(array);
+  if (doubleArray == nullptr) {
+    return nullptr;
+  }
+
+  vtkSmartPointer<vtkFloatArray> floatArray =
+      vtkSmartPointer<vtkFloatArray>::New();
+  floatArray->SetName(doubleArray->GetName());
+  floatArray->SetNumberOfComponents(doubleArray->GetNumberOfComponents());
+  for (int c = 0; c < doubleArray->GetNumberOfComponents(); ++c) {
+    if (doubleArray->GetComponentName(c) != nullptr) {
+      floatArray->SetComponentName(c, doubleArray->GetComponentName(c));
+    }
+  }
+  floatArray->SetNumberOfTuples(doubleArray->GetNumberOfTuples());
+
+  const double *source = doubleArray->GetPointer(0);
+  float *destination = floatArray->GetPointer(0);
+  vtkSMPTools::For(0, doubleArray->GetNumberOfValues(), valuesPerTask,
+                   [source, destination](vtkIdType begin, vtkIdType end) {
+                     narrowValues(source + begin, destination + begin,
+                                  end - begin);
+                   });
+  return floatArray;
+}
@@ -0,0 +1,34 @@
+#ifndef FLOAT32_CONVERSION_H
+#define FLOAT32_CONVERSION_H
+
+#include <QString>
+#include <QStringList>
+
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkSmartPointer.h>
+
+// Which Float64 data of a model is converted to Float32
+struct Float32Selection {
+  bool points = false;
+  QStringList pointArrays; // By name; "*" selects every point array
+
+  bool isEmpty() const { return !points && pointArrays.isEmpty(); }
+  bool includesPointArray(const QString &arrayName) const;
+  // Identifies the selection, e.g. in cache keys (empty when nothing is
+  // converted)
+  QString key() const;
+};
+
+// Converts Float64 arrays to Float32 for display: half the host memory and
+// GPU upload size, and the float specializations of VTK's scalar mapping.
+// Exact ranges must be taken from the double array before converting it.
+class Float32Conversion {
+public:
+  // Returns a Float32 copy of a vtkDoubleArray (name and component names
+  // kept), converted on the VTK SMP thread pool, or nullptr for any other
+  // array type
+  static vtkSmartPointer<vtkFloatArray> convert(vtkDataArray *array);
+};
+
+#endif // FLOAT32_CONVERSION_H
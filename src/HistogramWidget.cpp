@@ -0,0 +1,86 @@
+#include "HistogramWidget.h"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+HistogramWidget::HistogramWidget(QWidget *parent) : QWidget(parent) {
+  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+}
+
+void HistogramWidget::setHistogram(const ArrayHistogram &histogram,
+                                   const double range[2]) {
+  this->histogram = histogram;
+  colorRange[0] = range[0];
+  colorRange[1] = range[1];
+  update();
+}
+
+void HistogramWidget::clear() {
+  histogram = ArrayHistogram();
+  update();
+}
+
+QSize HistogramWidget::sizeHint() const { return QSize(240, 72); }
+
+void HistogramWidget::paintEvent(QPaintEvent *) {
+  QPainter painter(this);
+  const QRect frame = rect().adjusted(0, 0, -1, -1);
+  painter.fillRect(frame, QColor("#10161d"));
+  painter.setPen(QColor("#3a4756"));
+  painter.drawRect(frame);
+
+  const int numberOfBins = histogram.binCounts.size();
+  if (numberOfBins == 0 || histogram.totalCount == 0) {
+    return;
+  }
+
+  // One column per pixel; a column shows the fullest bin it covers
+  const QRect plot = frame.adjusted(2, 2, -1, -1);
+  const int columns = std::max(1, plot.width());
+  QVector<qint64> columnCounts(columns, 0);
+  for (int b = 0; b < numberOfBins; ++b) {
+    const int column = static_cast<int>(
+        static_cast<qint64>(b) * columns / numberOfBins);
+    columnCounts[column] =
+        std::max(columnCounts[column], histogram.binCounts[b]);
+  }
+  const qint64 maxCount =
+      *std::max_element(columnCounts.begin(), columnCounts.end());
+  const double logMaxCount = std::log1p(static_cast<double>(maxCount));
+
+  const double span = histogram.max - histogram.min;
+  auto valueAtColumn = [&](double column) {
+    return histogram.min + span * column / columns;
+  };
+  const QColor insideColor("#00bcd4");
+  const QColor outsideColor("#35414e");
+  for (int column = 0; column < columns; ++column) {
+    if (columnCounts[column] == 0) {
+      continue;
+    }
+    const int height = static_cast<int>(
+        std::ceil(plot.height() *
+                  std::log1p(static_cast<double>(columnCounts[column])) /
+                  logMaxCount));
+    const double value = valueAtColumn(column + 0.5);
+    const bool inside = span <= 0.0 ||
+                        (value >= colorRange[0] && value <= colorRange[1]);
+    painter.fillRect(plot.left() + column, plot.bottom() - height + 1, 1,
+                     height, inside ? insideColor : outsideColor);
+  }
+
+  // Color range markers, only when clipped within the histogram
+  if (span > 0.0) {
+    painter.setPen(QColor("#64e8ff"));
+    for (const double value : colorRange) {
+      if (value > histogram.min && value < histogram.max) {
+        const int x = plot.left() + static_cast<int>(
+                                        (value - histogram.min) / span *
+                                        columns);
+        painter.drawLine(x, plot.top(), x, plot.bottom());
+      }
+    }
+  }
+}
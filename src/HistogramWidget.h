@@ -0,0 +1,29 @@
+#ifndef HISTOGRAM_WIDGET_H
+#define HISTOGRAM_WIDGET_H
+
+#include <QWidget>
+
+#include "ArrayHistogram.h"
+
+// Bars of the selected field's histogram (log count) with the color range
+// marked; bins outside the range are dimmed
+class HistogramWidget : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit HistogramWidget(QWidget *parent = nullptr);
+
+  void setHistogram(const ArrayHistogram &histogram, const double range[2]);
+  void clear();
+
+  QSize sizeHint() const override;
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+
+private:
+  ArrayHistogram histogram;
+  double colorRange[2] = {0.0, 1.0};
+};
+
+#endif // HISTOGRAM_WIDGET_H
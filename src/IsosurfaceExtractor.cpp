@@ -0,0 +1,210 @@
+#include "IsosurfaceExtractor.h"
+
+#include <vtkArrayDispatch.h>
+#include <vtkContour3DLinearGrid.h>
+#include <vtkContourGrid.h>
+#include <vtkDataArrayRange.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPointData.h>
+#include <vtkSMPTools.h>
+#include <vtkSpanSpace.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <cmath>
+
+#include "PerfTrace.h"
+
+namespace {
+struct ScalarsWorker {
+  template <typename ArrayT, typename ScalarsT>
+  void operator()(ArrayT *array, ScalarsT *scalars, int componentIndex) const {
+    using ValueT = vtk::GetAPIType<ScalarsT>;
+    const auto tuples = vtk::DataArrayTupleRange(array);
+    auto values = vtk::DataArrayValueRange<1>(scalars);
+    vtkSMPTools::For(0, tuples.size(), [&](vtkIdType begin, vtkIdType end) {
+      for (vtkIdType i = begin; i < end; ++i) {
+        const auto tuple = tuples[i];
+        if (componentIndex >= 0) {
+          values[i] = static_cast<ValueT>(tuple[componentIndex]);
+          continue;
+        }
+        double sum = 0.0;
+        for (const auto value : tuple) {
+          sum += static_cast<double>(value) * static_cast<double>(value);
+        }
+        values[i] = static_cast<ValueT>(std::sqrt(sum));
+      }
+    });
+  }
+};
+} // namespace
+
+// The contoured field of the grid and the filters holding its span space;
+// only the thread running an extraction touches it
+struct IsosurfaceExtractor::ContourContext {
+  vtkSmartPointer<vtkUnstructuredGrid> input; // Structure plus the scalars
+  vtkSmartPointer<vtkDataArray> pointArray;   // Field the scalars come from
+  int componentIndex = 0;
+  bool linear = false; // Only linear cells: threaded contouring applies
+  vtkSmartPointer<vtkContour3DLinearGrid> linearContour;
+  vtkSmartPointer<vtkContourGrid> contour;
+};
+
+IsosurfaceExtractor::IsosurfaceExtractor(QObject *parent) : QObject(parent) {}
+
+IsosurfaceExtractor::~IsosurfaceExtractor() = default;
+
+void IsosurfaceExtractor::setGrid(vtkUnstructuredGrid *grid) {
+  cancel();
+  context.reset();
+  if (grid == nullptr) {
+    return;
+  }
+  context = std::make_shared<ContourContext>();
+  context->input = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  context->input->CopyStructure(grid);
+}
+
+void IsosurfaceExtractor::extractAsync(vtkDataArray *pointArray,
+                                       int componentIndex,
+                                       const QVector<double> &values) {
+  if (context == nullptr || pointArray == nullptr) {
+    return;
+  }
+  ExtractRequest request;
+  request.pointArray = pointArray;
+  request.componentIndex = componentIndex;
+  request.values = values;
+
+  // Only the latest request waits for the running extraction; setGrid()
+  // cancels the waiting one before the context changes
+  std::shared_ptr<ContourContext> contourContext = context;
+  worker.start([this, contourContext,
+                request](const LatestRequestWorker::Job &job) {
+    vtkSmartPointer<vtkPolyData> isosurfaces =
+        extract(*contourContext, request);
+
+    job.post([this, job, isosurfaces]() {
+      if (job.isCancelled()) {
+        return; // Model closed or extraction cancelled meanwhile
+      }
+      emit isosurfacesExtracted(isosurfaces);
+    });
+  });
+}
+
+void IsosurfaceExtractor::cancel() { worker.cancel(); }
+
+vtkSmartPointer<vtkDataArray>
+IsosurfaceExtractor::scalars(vtkDataArray *array, int componentIndex) {
+  if (array == nullptr || componentIndex >= array->GetNumberOfComponents()) {
+    return nullptr;
+  }
+  if (array->GetNumberOfComponents() == 1) {
+    return array;
+  }
+
+  vtkSmartPointer<vtkDataArray> scalars;
+  if (vtkFloatArray::SafeDownCast(array) != nullptr) {
+    scalars = vtkSmartPointer<vtkFloatArray>::New();
+  } else {
+    scalars = vtkSmartPointer<vtkDoubleArray>::New();
+  }
+  scalars->SetName(array->GetName());
+  scalars->SetNumberOfTuples(array->GetNumberOfTuples());
+
+  ScalarsWorker worker;
+  using Dispatcher =
+      vtkArrayDispatch::Dispatch2ByValueType<vtkArrayDispatch::Reals,
+                                             vtkArrayDispatch::Reals>;
+  if (!Dispatcher::Execute(array, scalars.GetPointer(), worker,
+                           componentIndex)) {
+    // Generic vtkDataArray fallback (e.g. integer arrays)
+    worker(array, scalars.GetPointer(), componentIndex);
+  }
+  return scalars;
+}
+
+vtkSmartPointer<vtkPolyData>
+IsosurfaceExtractor::extract(ContourContext &context,
+                             const ExtractRequest &request) {
+  PerfTrace::Scope scope("iso", "Extract isosurfaces");
+
+  // A new field replaces the scalars, so the span space is rebuilt by the
+  // next contouring; new values of the same field reuse it
+  if (context.pointArray != request.pointArray ||
+      context.componentIndex != request.componentIndex) {
+    PerfTrace::Scope scalarsScope("iso", "Prepare isosurface scalars");
+    vtkPointData *pointData = context.input->GetPointData();
+    pointData->Initialize();
+    context.pointArray = nullptr;
+    vtkSmartPointer<vtkDataArray> fieldScalars =
+        scalars(request.pointArray, request.componentIndex);
+    if (fieldScalars == nullptr || fieldScalars->GetName() == nullptr) {
+      return nullptr;
+    }
+    pointData->SetScalars(fieldScalars);
+    context.pointArray = request.pointArray;
+    context.componentIndex = request.componentIndex;
+
+    // vtkContour3DLinearGrid runs on the SMP thread pool but handles linear
+    // cells only; other grids take the serial vtkContourGrid
+    context.linear = vtkContour3DLinearGrid::CanFullyProcessDataObject(
+        context.input, fieldScalars->GetName());
+    if (context.linear && context.linearContour == nullptr) {
+      context.linearContour = vtkSmartPointer<vtkContour3DLinearGrid>::New();
+      context.linearContour->SetInputData(context.input);
+      context.linearContour->MergePointsOn();
+      context.linearContour->InterpolateAttributesOn();
+      context.linearContour->ComputeNormalsOn();
+      context.linearContour->UseScalarTreeOn();
+      context.linearContour->SetScalarTree(
+          vtkSmartPointer<vtkSpanSpace>::New());
+    } else if (!context.linear && context.contour == nullptr) {
+      context.contour = vtkSmartPointer<vtkContourGrid>::New();
+      context.contour->SetInputData(context.input);
+      context.contour->ComputeScalarsOn();
+      context.contour->UseScalarTreeOn();
+      context.contour->SetScalarTree(vtkSmartPointer<vtkSpanSpace>::New());
+    }
+    vtkAlgorithm *filter = context.linear
+                               ? static_cast<vtkAlgorithm *>(
+                                     context.linearContour.GetPointer())
+                               : context.contour.GetPointer();
+    filter->SetInputArrayToProcess(0, 0, 0,
+                                   vtkDataObject::FIELD_ASSOCIATION_POINTS,
+                                   fieldScalars->GetName());
+  }
+  if (context.input->GetPointData()->GetScalars() == nullptr) {
+    return nullptr;
+  }
+
+  vtkPolyData *output = nullptr;
+  if (context.linear) {
+    context.linearContour->SetNumberOfContours(request.values.size());
+    for (int i = 0; i < request.values.size(); ++i) {
+      context.linearContour->SetValue(i, request.values[i]);
+    }
+    context.linearContour->Update();
+    output = context.linearContour->GetOutput();
+  } else {
+    context.contour->SetNumberOfContours(request.values.size());
+    for (int i = 0; i < request.values.size(); ++i) {
+      context.contour->SetValue(i, request.values[i]);
+    }
+    context.contour->Update();
+    output = context.contour->GetOutput();
+  }
+  if (output == nullptr || output->GetNumberOfCells() == 0) {
+    return nullptr;
+  }
+
+  // Colored by the contoured scalars through the shared lookup table
+  vtkSmartPointer<vtkPolyData> isosurfaces =
+      vtkSmartPointer<vtkPolyData>::New();
+  isosurfaces->ShallowCopy(output);
+  isosurfaces->GetPointData()->SetActiveScalars(
+      context.input->GetPointData()->GetScalars()->GetName());
+  return isosurfaces;
+}
@@ -0,0 +1,62 @@
+#ifndef ISOSURFACE_EXTRACTOR_H
+#define ISOSURFACE_EXTRACTOR_H
+
+#include <QObject>
+#include <QVector>
+
+#include <vtkDataArray.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include <memory>
+
+#include "LatestRequestWorker.h"
+
+class vtkUnstructuredGrid;
+
+// Isosurfaces of one point array component (or the magnitude) of a model
+// grid, extracted on a worker thread. The scalars of the field and their
+// classification (a span space over the cells) are kept until another field
+// is contoured, so changing only the values reruns just the contouring.
+// Requests made while an extraction runs collapse into the latest one.
+class IsosurfaceExtractor : public QObject {
+  Q_OBJECT
+
+public:
+  explicit IsosurfaceExtractor(QObject *parent = nullptr);
+  ~IsosurfaceExtractor() override;
+
+  // Later isosurfaces are taken from the structure of grid (nullptr drops
+  // it)
+  void setGrid(vtkUnstructuredGrid *grid);
+
+  // componentIndex -1 selects the magnitude
+  void extractAsync(vtkDataArray *pointArray, int componentIndex,
+                    const QVector<double> &values);
+  void cancel(); // Drops the pending extraction and the running one's result
+
+  // The component (or magnitude) as a single-component array computed in
+  // parallel; single-component arrays are returned as they are
+  static vtkSmartPointer<vtkDataArray> scalars(vtkDataArray *array,
+                                               int componentIndex);
+
+signals:
+  void isosurfacesExtracted(vtkSmartPointer<vtkPolyData> isosurfaces);
+
+private:
+  struct ContourContext;
+  struct ExtractRequest {
+    vtkSmartPointer<vtkDataArray> pointArray;
+    int componentIndex;
+    QVector<double> values;
+  };
+
+  static vtkSmartPointer<vtkPolyData> extract(ContourContext &context,
+                                              const ExtractRequest &request);
+
+private:
+  std::shared_ptr<ContourContext> context; // Shared with the running job
+  LatestRequestWorker worker{LatestRequestWorker::Policy::QueueLatest};
+};
+
+#endif // ISOSURFACE_EXTRACTOR_H
@@ -0,0 +1,96 @@
+#include "LatestRequestWorker.h"
+
+#include <QThread>
+
+struct LatestRequestWorker::Job::State {
+  std::atomic_bool cancelRequested{false};
+};
+
+LatestRequestWorker::Job::Job(LatestRequestWorker *worker,
+                              std::shared_ptr<State> state)
+    : worker(worker), state(std::move(state)) {}
+
+const std::atomic_bool &LatestRequestWorker::Job::cancelFlag() const {
+  return state->cancelRequested;
+}
+
+bool LatestRequestWorker::Job::isCancelled() const {
+  return state->cancelRequested.load();
+}
+
+void LatestRequestWorker::Job::post(std::function<void()> function) const {
+  QMetaObject::invokeMethod(
+      worker,
+      [worker = worker, state = state, function = std::move(function)]() {
+        if (state == worker->latestJob) {
+          function();
+        }
+      },
+      Qt::QueuedConnection);
+}
+
+LatestRequestWorker::LatestRequestWorker(Policy policy, QObject *parent)
+    : QObject(parent), policy(policy) {}
+
+LatestRequestWorker::~LatestRequestWorker() {
+  cancel();
+  // Jobs post to this object; wait for them to finish
+  for (QThread *thread : threads) {
+    thread->wait();
+    delete thread;
+  }
+}
+
+void LatestRequestWorker::start(JobFunction function) {
+  if (policy == Policy::QueueLatest && !latestJobReturned) {
+    waitingJob = std::move(function);
+    return;
+  }
+  run(std::move(function));
+}
+
+void LatestRequestWorker::cancel() {
+  waitingJob = nullptr;
+  if (latestJob != nullptr) {
+    latestJob->cancelRequested.store(true);
+  }
+}
+
+bool LatestRequestWorker::isBusy() const { return !latestJobReturned; }
+
+void LatestRequestWorker::run(JobFunction function) {
+  if (latestJob != nullptr) {
+    latestJob->cancelRequested.store(true);
+  }
+  std::shared_ptr<Job::State> state = std::make_shared<Job::State>();
+  latestJob = state;
+  latestJobReturned = false;
+
+  QThread *thread =
+      QThread::create([this, state, function = std::move(function)]() {
+        function(Job(this, state));
+
+        // Queued behind everything the job posted
+        QMetaObject::invokeMethod(
+            this,
+            [this, state]() {
+              if (state != latestJob) {
+                return;
+              }
+              latestJobReturned = true;
+              if (waitingJob != nullptr) {
+                JobFunction next = std::move(waitingJob);
+                waitingJob = nullptr;
+                run(std::move(next));
+              }
+            },
+            Qt::QueuedConnection);
+      });
+
+  threads.insert(thread);
+  connect(thread, &QThread::finished, this, [this, thread]() {
+    threads.remove(thread);
+    thread->deleteLater();
+  });
+  thread->start();
+}
@@ -0,0 +1,68 @@
+#ifndef LATEST_REQUEST_WORKER_H
+#define LATEST_REQUEST_WORKER_H
+
+#include <QObject>
+#include <QSet>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class QThread;
+
+// Runs jobs on worker threads for an owner that only cares about its latest
+// request (the latest load, cut, comparison, ...). A job posts its results
+// back to the worker's thread; whatever it posts after a newer job has
+// started is dropped. Every job has its own cancel flag, set when the job is
+// superseded, cancelled or the worker is destroyed.
+class LatestRequestWorker : public QObject {
+  Q_OBJECT
+
+public:
+  enum class Policy {
+    // A new job starts right away; the running one is cancelled
+    CancelRunning,
+    // Jobs run one at a time; jobs started meanwhile wait and only the
+    // latest of them runs, once the running job has returned
+    QueueLatest
+  };
+
+  // Handed to a running job
+  class Job {
+  public:
+    const std::atomic_bool &cancelFlag() const;
+    bool isCancelled() const;
+    // Runs function on the worker's thread, unless a newer job has started
+    // by then. Cancelled jobs still deliver, so check isCancelled() there
+    // where a cancelled result has to be dropped.
+    void post(std::function<void()> function) const;
+
+  private:
+    friend class LatestRequestWorker;
+    struct State;
+    Job(LatestRequestWorker *worker, std::shared_ptr<State> state);
+
+    LatestRequestWorker *worker;
+    std::shared_ptr<State> state;
+  };
+  using JobFunction = std::function<void(const Job &job)>;
+
+  explicit LatestRequestWorker(Policy policy, QObject *parent = nullptr);
+  ~LatestRequestWorker() override; // Cancels every job and waits for it
+
+  void start(JobFunction function);
+  void cancel(); // Cancels the latest job and drops a waiting one
+  bool isBusy() const; // The latest job has not returned yet
+
+private:
+  void run(JobFunction function);
+
+private:
+  Policy policy;
+  QSet<QThread *> threads; // Superseded jobs may still be running
+  std::shared_ptr<Job::State> latestJob;
+  bool latestJobReturned = true;
+  JobFunction waitingJob; // QueueLatest only
+};
+
+#endif // LATEST_REQUEST_WORKER_H
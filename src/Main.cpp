@@ -1,5 +1,7 @@
 ﻿#include <QApplication>
+#include <QCommandLineParser>
 #include <QIcon>
+#include <QTextStream>
 
 #include "MainWindow.h"
 
@@ -7,9 +9,33 @@ int main(int argc, char *argv[]) {
   QApplication app(argc, argv);
   app.setWindowIcon(QIcon(":/icons/icon.ico"));
 
-  const QString initialFile =
-      (argc >= 2) ? QString::fromLocal8Bit(argv[1]) : QString();
-  MainWindow mainWindow(initialFile);
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Views VTU files.");
+  parser.addHelpOption();
+  QCommandLineOption interactiveFrameRateOption(
+      "interactive-fps",
+      "Frame rate to keep while the camera moves; slower surfaces are drawn "
+      "decimated meanwhile.",
+      "fps", "30");
+  parser.addOption(interactiveFrameRateOption);
+  parser.addPositionalArgument("file",
+                               "VTU or PVTU file or .pvd collection to open.",
+                               "[file]");
+  parser.process(app);
+
+  bool frameRateOk = false;
+  const double interactiveFrameRate =
+      parser.value(interactiveFrameRateOption).toDouble(&frameRateOk);
+  if (!frameRateOk || interactiveFrameRate <= 0.0) {
+    QTextStream(stderr) << "Invalid interactive frame rate: "
+                        << parser.value(interactiveFrameRateOption)
+                        << Qt::endl;
+    return 2;
+  }
+
+  const QStringList arguments = parser.positionalArguments();
+  const QString initialFile = arguments.isEmpty() ? QString() : arguments[0];
+  MainWindow mainWindow(initialFile, interactiveFrameRate);
   mainWindow.show();
   return app.exec();
 }
@@ -1,4 +1,10 @@
 ﻿#include "MainWindow.h"
+#include "DecodedModelCache.h"
+#include "DisplacementWarp.h"
+#include "HistogramWidget.h"
+#include "ModelMemoryUsage.h"
+#include "PerfTrace.h"
+#include "SurfaceColoring.h"
 #include "VtuModelLoader.h"
 
 #include <QFile>
@@ -8,26 +14,73 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QMessageBox>
+#include <QPointF>
 #include <QPointer>
 #include <QPushButton>
+#include <QShortcut>
 #include <QTimer>
 #include <QVBoxLayout>
 #include <QVTKOpenGLNativeWidget.h>
 
+#include <vtkCellData.h>
+#include <vtkCommand.h>
 #include <vtkDataArray.h>
+#include <vtkEventQtSlotConnect.h>
+#include <vtkIdTypeArray.h>
+#include <vtkInteractorStyleTrackballCamera.h>
+#include <vtkNew.h>
 #include <vtkPointData.h>
+#include <vtkProperty.h>
 #include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkUnsignedCharArray.h>
 
-MainWindow::MainWindow(const QString &vtuFilePath, QWidget *parent)
+#include <algorithm>
+#include <cstring>
+
+MainWindow::MainWindow(const QString &vtuFilePath,
+                       double interactiveFrameRate, QWidget *parent)
     : QMainWindow(parent), modelLoader(this),
-      fileFilter("VTU files (*.vtu);;All files (*.*)"),
-      fileLabelPlaceholderText("📁 No VTU file selected") {
+      fileFilter("VTK files (*.vtu *.pvtu *.pvd);;VTU files (*.vtu);;"
+                 "Partitioned VTU files (*.pvtu);;"
+                 "PVD collections (*.pvd);;All files (*.*)"),
+      fileLabelPlaceholderText("📁 No VTU file selected"),
+      memoryBudget(4LL * 1024 * 1024 * 1024),
+      decodedModelCacheBudget(32LL * 1024 * 1024 * 1024),
+      colorLookupTableId("default"), interactiveFrameRate(interactiveFrameRate),
+      minimumProxyTriangles(20000),
+      timeStepPrefetchCapacity(TimeStepPrefetcher::defaultCapacity),
+      playbackFrameRate(30.0), perfOverlayOperationCount(12),
+      perfOverlayFrameCount(60) {
   setupVtk();
   setupUi();
   setupConnections();
 
+  // Decode point arrays only when they are first colored by
+  VtuLoadOptions loadOptions;
+  loadOptions.lazyPointArrays = true;
+  loadOptions.memoryBudget = memoryBudget;
+  // Previously opened files reopen from their decoded snapshot
+  if (!qEnvironmentVariableIsSet("VTK_RENDERER_NO_MODEL_CACHE")) {
+    loadOptions.decodedModelCacheDirectory =
+        DecodedModelCache::defaultDirectory();
+  }
+  loadOptions.decodedModelCacheBudget = decodedModelCacheBudget;
+  // Float64 solver output is displayed from Float32 copies on request
+  if (qEnvironmentVariableIsSet("VTK_RENDERER_FLOAT32")) {
+    loadOptions.float32.points = true;
+    loadOptions.float32.pointArrays = QStringList{"*"};
+  }
+  modelLoader.setLoadOptions(loadOptions);
+  timeStepPrefetcher.setCapacity(timeStepPrefetchCapacity);
+
+  // Trace from startup (e.g. to capture the first load) when asked to
+  if (qEnvironmentVariableIsSet("VTK_RENDERER_TRACE")) {
+    PerfTrace::setEnabled(true);
+  }
+
   if (!vtuFilePath.isEmpty()) {
-    modelLoader.load(vtuFilePath);
+    openFile(vtuFilePath);
   }
 }
 
@@ -36,7 +89,41 @@ void MainWindow::setupVtk() {
   renderer = vtkSmartPointer<vtkRenderer>::New();
   renderer->SetBackground(0.12, 0.16, 0.20);
 
-  modelMapper = vtkSmartPointer<vtkDataSetMapper>::New();
+  modelMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+  // Scalars are mapped through this table by colorBufferCache; the mapper
+  // draws the resulting RGBA buffer directly
+  colorLookupTable = vtkSmartPointer<vtkLookupTable>::New();
+  colorLookupTable->Build();
+
+  // Decimated stand-in for the surface, drawn while the camera moves
+  proxyMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+  proxyMapper->SetScalarModeToUsePointData();
+  proxyMapper->SetColorModeToDirectScalars();
+
+  // Clip/slice cut, small enough to map its scalars at render time through
+  // the lookup table the surface colors come from
+  cutPlane = vtkSmartPointer<vtkPlane>::New();
+  cutMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+  cutMapper->SetLookupTable(colorLookupTable);
+  cutMapper->UseLookupTableScalarRangeOn();
+  cutMapper->SetColorModeToMapScalars();
+  cutMapper->ScalarVisibilityOff();
+  cutActor = vtkSmartPointer<vtkActor>::New();
+  cutActor->SetMapper(cutMapper);
+  cutActor->SetVisibility(0);
+  renderer->AddActor(cutActor);
+
+  // Isosurfaces carry the contoured scalars, mapped like the cut
+  isoMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+  isoMapper->SetLookupTable(colorLookupTable);
+  isoMapper->UseLookupTableScalarRangeOn();
+  isoMapper->SetColorModeToMapScalars();
+  isoMapper->SetScalarModeToUsePointData();
+  isoActor = vtkSmartPointer<vtkActor>::New();
+  isoActor->SetMapper(isoMapper);
+  isoActor->SetVisibility(0);
+  renderer->AddActor(isoActor);
+
   scalarBar = vtkSmartPointer<vtkScalarBarActor>::New();
   scalarBar->SetNumberOfLabels(6);
   scalarBar->SetWidth(0.08);
@@ -61,8 +148,57 @@ void MainWindow::setupUi() {
   // VTK Widget
   vtkVisualizer = new QVTKOpenGLNativeWidget(this);
   vtkVisualizer->renderWindow()->AddRenderer(renderer);
+  // Interaction events are emitted by the active style, so use a single
+  // trackball camera style rather than the default style switch
+  vtkNew<vtkInteractorStyleTrackballCamera> interactorStyle;
+  vtkVisualizer->interactor()->SetInteractorStyle(interactorStyle);
+  vtkVisualizer->interactor()->SetDesiredUpdateRate(interactiveFrameRate);
   rootLayout->addWidget(vtkVisualizer, 1);
 
+  // Handle of the clip/slice plane, shown while a cut mode is on. The cut
+  // itself marks the plane, so only the outline, normal and edges are drawn.
+  cutPlaneRepresentation =
+      vtkSmartPointer<vtkImplicitPlaneRepresentation>::New();
+  cutPlaneRepresentation->SetPlaceFactor(1.0);
+  cutPlaneRepresentation->DrawPlaneOff();
+  cutPlaneRepresentation->OutlineTranslationOff();
+  cutPlaneRepresentation->ScaleEnabledOff();
+  cutPlaneWidget = vtkSmartPointer<vtkImplicitPlaneWidget2>::New();
+  cutPlaneWidget->SetInteractor(vtkVisualizer->interactor());
+  cutPlaneWidget->SetRepresentation(cutPlaneRepresentation);
+
+  // Performance overlay (F3) drawn over the top-left corner of the view
+  perfOverlayLabel = new QLabel(vtkVisualizer);
+  perfOverlayLabel->setAttribute(Qt::WA_TransparentForMouseEvents);
+  perfOverlayLabel->setStyleSheet("QLabel {"
+                                  "   color: #d9e7f5;"
+                                  "   background-color: rgba(19, 24, 31, 210);"
+                                  "   border: 1px solid #3a4756;"
+                                  "   border-radius: 0px;"
+                                  "   padding: 6px;"
+                                  "   font-family: monospace;"
+                                  "   font-size: 11px;"
+                                  "}");
+  perfOverlayLabel->move(8, 8);
+  perfOverlayLabel->setVisible(false);
+
+  // Probed value under the cursor, drawn over the bottom-left corner
+  probeLabel = new QLabel(vtkVisualizer);
+  probeLabel->setAttribute(Qt::WA_TransparentForMouseEvents);
+  probeLabel->setStyleSheet("QLabel {"
+                            "   color: #d9e7f5;"
+                            "   background-color: rgba(19, 24, 31, 210);"
+                            "   border: 1px solid #3a4756;"
+                            "   border-radius: 0px;"
+                            "   padding: 6px;"
+                            "   font-family: monospace;"
+                            "   font-size: 11px;"
+                            "}");
+  probeLabel->setVisible(false);
+
+  perfOverlayTimer = new QTimer(this);
+  perfOverlayTimer->setInterval(250);
+
   // Right Panel
   auto *rightPanel = new QWidget(this);
   rightPanel->setMinimumWidth(300);
@@ -138,12 +274,116 @@ void MainWindow::setupUi() {
                                  "}");
   closeFileButton->setEnabled(false);
 
+  // Opens a second result on the same mesh and adds difference fields
+  compareFileButton = new QPushButton("⚖ Compare", this);
+  compareFileButton->setToolTip(
+      "Compare with another result on the same mesh");
+  compareFileButton->setStyleSheet("QPushButton {"
+                                   "   background-color: #121820;"
+                                   "   color: #d9e7f5;"
+                                   "   border: 2px solid #2a3a4b;"
+                                   "   border-radius: 0px;"
+                                   "   padding: 8px 16px;"
+                                   "   font-weight: 600;"
+                                   "}"
+                                   "QPushButton:hover {"
+                                   "   background-color: #0f2630;"
+                                   "   color: #64e8ff;"
+                                   "   border: 2px solid #00bcd4;"
+                                   "}"
+                                   "QPushButton:pressed {"
+                                   "   background-color: #093946;"
+                                   "   border: 2px solid #00bcd4;"
+                                   "}"
+                                   "QPushButton:disabled {"
+                                   "   background-color: #171d24;"
+                                   "   border: 2px solid #35414e;"
+                                   "   color: #607182;"
+                                   "}");
+  compareFileButton->setEnabled(false);
+
+  // Reloads the opened file whenever it is rewritten (e.g. by a solver)
+  watchFileButton = new QPushButton("👁 Watch", this);
+  watchFileButton->setToolTip(
+      "Reload the opened file when it is rewritten, keeping the view");
+  watchFileButton->setCheckable(true);
+  watchFileButton->setStyleSheet("QPushButton {"
+                                 "   background-color: #121820;"
+                                 "   color: #d9e7f5;"
+                                 "   border: 2px solid #2a3a4b;"
+                                 "   border-radius: 0px;"
+                                 "   padding: 8px 16px;"
+                                 "   font-weight: 600;"
+                                 "}"
+                                 "QPushButton:hover {"
+                                 "   background-color: #0f2630;"
+                                 "   color: #64e8ff;"
+                                 "   border: 2px solid #00bcd4;"
+                                 "}"
+                                 "QPushButton:pressed, QPushButton:checked {"
+                                 "   background-color: #093946;"
+                                 "   border: 2px solid #00bcd4;"
+                                 "}"
+                                 "QPushButton:disabled {"
+                                 "   background-color: #171d24;"
+                                 "   border: 2px solid #35414e;"
+                                 "   color: #607182;"
+                                 "}");
+  watchFileButton->setEnabled(false);
+
   buttonLayout->addWidget(openFileButton);
   buttonLayout->addWidget(closeFileButton);
+  buttonLayout->addWidget(compareFileButton);
+  buttonLayout->addWidget(watchFileButton);
   buttonLayout->addStretch();
 
+  // Loading indicator (visible only while a model is being loaded)
+  loadingWidget = new QWidget(this);
+  QHBoxLayout *loadingLayout = new QHBoxLayout(loadingWidget);
+  loadingLayout->setContentsMargins(0, 0, 0, 0);
+  loadingLayout->setSpacing(8);
+
+  loadingProgressBar = new QProgressBar(this);
+  loadingProgressBar->setRange(0, 100);
+  loadingProgressBar->setTextVisible(true);
+  loadingProgressBar->setStyleSheet("QProgressBar {"
+                                    "   color: #d9e7f5;"
+                                    "   background-color: #10161d;"
+                                    "   border: 1px solid #3a4756;"
+                                    "   border-radius: 0px;"
+                                    "   padding: 2px;"
+                                    "   text-align: center;"
+                                    "}"
+                                    "QProgressBar::chunk {"
+                                    "   background-color: #00bcd4;"
+                                    "}");
+
+  cancelLoadingButton = new QPushButton("⏹ Cancel", this);
+  cancelLoadingButton->setStyleSheet("QPushButton {"
+                                     "   background-color: #121820;"
+                                     "   color: #d9e7f5;"
+                                     "   border: 2px solid #2a3a4b;"
+                                     "   border-radius: 0px;"
+                                     "   padding: 4px 12px;"
+                                     "   font-weight: 600;"
+                                     "}"
+                                     "QPushButton:hover {"
+                                     "   background-color: #2a1713;"
+                                     "   color: #ff9c87;"
+                                     "   border: 2px solid #ff5a36;"
+                                     "}"
+                                     "QPushButton:pressed {"
+                                     "   background-color: #3f1510;"
+                                     "   border: 2px solid #ff5a36;"
+                                     "}");
+
+  loadingLayout->addWidget(loadingProgressBar, 1);
+  loadingLayout->addWidget(cancelLoadingButton);
+  loadingWidget->setVisible(false);
+
   filePickerLayout->addWidget(fileLabel);
   filePickerLayout->addLayout(buttonLayout);
+  filePickerLayout->addWidget(loadingWidget);
   filePickerWidget->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Fixed);
   rightLayout->addWidget(filePickerWidget);
 
@@ -266,10 +506,544 @@ void MainWindow::setupUi() {
   componentLayout->addWidget(componentLabel);
   componentLayout->addWidget(componentCombo);
 
+  // Color range row (full range or percentiles of the histogram)
+  QHBoxLayout *colorRangeLayout = new QHBoxLayout();
+  colorRangeLayout->setSpacing(8);
+
+  colorRangeLabel = new QLabel("🎚 Range:", this);
+  colorRangeLabel->setMinimumWidth(80);
+  colorRangeLabel->setStyleSheet("QLabel {"
+                                 "   color: #8fb0cf;"
+                                 "   font-weight: 600;"
+                                 "   background-color: transparent;"
+                                 "}");
+
+  colorRangeCombo = new QComboBox(this);
+  colorRangeCombo->addItem("Full (min – max)", QPointF(0.0, 100.0));
+  colorRangeCombo->addItem("1 – 99 %", QPointF(1.0, 99.0));
+  colorRangeCombo->addItem("5 – 95 %", QPointF(5.0, 95.0));
+  colorRangeCombo->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+  colorRangeCombo->setStyleSheet("QComboBox {"
+                                 "   border: 1px solid #3a4756;"
+                                 "   border-radius: 0px;"
+                                 "   padding: 6px;"
+                                 "   background-color: #10161d;"
+                                 "   color: #e6f3ff;"
+                                 "   selection-background-color: #00bcd4;"
+                                 "   selection-color: #04151d;"
+                                 "}"
+                                 "QComboBox::drop-down {"
+                                 "   border-left: 1px solid #3a4756;"
+                                 "   width: 22px;"
+                                 "   background-color: #141c24;"
+                                 "}"
+                                 "QComboBox:enabled:hover {"
+                                 "   border: 1px solid #00bcd4;"
+                                 "}"
+                                 "QComboBox:disabled {"
+                                 "   background-color: #1a2129;"
+                                 "   color: #5a6877;"
+                                 "}"
+                                 "QComboBox QAbstractItemView {"
+                                 "   background-color: #10161d;"
+                                 "   color: #e6f3ff;"
+                                 "   border: 1px solid #3a4756;"
+                                 "   selection-background-color: #00bcd4;"
+                                 "   selection-color: #04151d;"
+                                 "}");
+
+  colorRangeLayout->addWidget(colorRangeLabel);
+  colorRangeLayout->addWidget(colorRangeCombo);
+
+  // Cell data row (enabled while a cell array is selected)
+  QHBoxLayout *cellDataModeLayout = new QHBoxLayout();
+  cellDataModeLayout->setSpacing(8);
+
+  cellDataModeLabel = new QLabel("🧱 Cells:", this);
+  cellDataModeLabel->setMinimumWidth(80);
+  cellDataModeLabel->setStyleSheet("QLabel {"
+                                   "   color: #8fb0cf;"
+                                   "   font-weight: 600;"
+                                   "   background-color: transparent;"
+                                   "}");
+
+  cellDataModeCombo = new QComboBox(this);
+  cellDataModeCombo->addItem("Flat per cell");
+  cellDataModeCombo->addItem("Interpolated to points");
+  cellDataModeCombo->setEnabled(false);
+  cellDataModeCombo->setSizePolicy(QSizePolicy::Expanding,
+                                   QSizePolicy::Fixed);
+  cellDataModeCombo->setStyleSheet("QComboBox {"
+                                   "   border: 1px solid #3a4756;"
+                                   "   border-radius: 0px;"
+                                   "   padding: 6px;"
+                                   "   background-color: #10161d;"
+                                   "   color: #e6f3ff;"
+                                   "   selection-background-color: #00bcd4;"
+                                   "   selection-color: #04151d;"
+                                   "}"
+                                   "QComboBox::drop-down {"
+                                   "   border-left: 1px solid #3a4756;"
+                                   "   width: 22px;"
+                                   "   background-color: #141c24;"
+                                   "}"
+                                   "QComboBox:enabled:hover {"
+                                   "   border: 1px solid #00bcd4;"
+                                   "}"
+                                   "QComboBox:disabled {"
+                                   "   background-color: #1a2129;"
+                                   "   color: #5a6877;"
+                                   "}"
+                                   "QComboBox QAbstractItemView {"
+                                   "   background-color: #10161d;"
+                                   "   color: #e6f3ff;"
+                                   "   border: 1px solid #3a4756;"
+                                   "   selection-background-color: #00bcd4;"
+                                   "   selection-color: #04151d;"
+                                   "}");
+
+  cellDataModeLayout->addWidget(cellDataModeLabel);
+  cellDataModeLayout->addWidget(cellDataModeCombo);
+
+  // Histogram of the selected field, computed on first selection
+  histogramWidget = new HistogramWidget(this);
+
   groupLayout->addLayout(arrayLayout);
   groupLayout->addLayout(componentLayout);
+  groupLayout->addLayout(colorRangeLayout);
+  groupLayout->addLayout(cellDataModeLayout);
+  groupLayout->addWidget(histogramWidget);
   rightLayout->addWidget(arrayComponentGroupBox);
 
+  // Deformed shape (enabled when the model has a displacement array)
+  warpGroupBox = new QGroupBox("Deformed Shape", this);
+  warpGroupBox->setStyleSheet("QGroupBox {"
+                              "   color: #d9e7f5;"
+                              "   border: 1px solid #3a4756;"
+                              "   border-radius: 0px;"
+                              "   margin-top: 10px;"
+                              "   padding-top: 8px;"
+                              "   background-color: #151d26;"
+                              "}"
+                              "QGroupBox::title {"
+                              "   subcontrol-origin: margin;"
+                              "   left: 8px;"
+                              "   padding: 0 4px;"
+                              "   color: #64e8ff;"
+                              "   font-weight: 600;"
+                              "}");
+  warpGroupBox->setEnabled(false);
+  QHBoxLayout *warpLayout = new QHBoxLayout(warpGroupBox);
+  warpLayout->setSpacing(8);
+
+  QLabel *warpLabel = new QLabel("🌀 Scale:", this);
+  warpLabel->setMinimumWidth(80);
+  warpLabel->setStyleSheet("QLabel {"
+                           "   color: #8fb0cf;"
+                           "   font-weight: 600;"
+                           "   background-color: transparent;"
+                           "}");
+
+  // Position 50 moves the largest displacement by a tenth of the model size
+  warpScaleSlider = new QSlider(Qt::Horizontal, this);
+  warpScaleSlider->setRange(0, 100);
+  warpScaleSlider->setStyleSheet("QSlider::groove:horizontal {"
+                                 "   height: 4px;"
+                                 "   background-color: #3a4756;"
+                                 "}"
+                                 "QSlider::sub-page:horizontal {"
+                                 "   background-color: #00bcd4;"
+                                 "}"
+                                 "QSlider::handle:horizontal {"
+                                 "   width: 12px;"
+                                 "   margin: -5px 0;"
+                                 "   background-color: #d9e7f5;"
+                                 "}");
+
+  warpScaleLabel = new QLabel("Off", this);
+  warpScaleLabel->setMinimumWidth(64);
+  warpScaleLabel->setStyleSheet("QLabel {"
+                                "   color: #b3c4d6;"
+                                "   background-color: transparent;"
+                                "}");
+
+  warpLayout->addWidget(warpLabel);
+  warpLayout->addWidget(warpScaleSlider, 1);
+  warpLayout->addWidget(warpScaleLabel);
+  rightLayout->addWidget(warpGroupBox);
+
+  // Clip and slice plane (enabled with a model)
+  cutGroupBox = new QGroupBox("Clip / Slice", this);
+  cutGroupBox->setStyleSheet("QGroupBox {"
+                             "   color: #d9e7f5;"
+                             "   border: 1px solid #3a4756;"
+                             "   border-radius: 0px;"
+                             "   margin-top: 10px;"
+                             "   padding-top: 8px;"
+                             "   background-color: #151d26;"
+                             "}"
+                             "QGroupBox::title {"
+                             "   subcontrol-origin: margin;"
+                             "   left: 8px;"
+                             "   padding: 0 4px;"
+                             "   color: #64e8ff;"
+                             "   font-weight: 600;"
+                             "}");
+  cutGroupBox->setEnabled(false);
+  QHBoxLayout *cutLayout = new QHBoxLayout(cutGroupBox);
+  cutLayout->setSpacing(8);
+
+  QLabel *cutLabel = new QLabel("✂ Plane:", this);
+  cutLabel->setMinimumWidth(80);
+  cutLabel->setStyleSheet("QLabel {"
+                          "   color: #8fb0cf;"
+                          "   font-weight: 600;"
+                          "   background-color: transparent;"
+                          "}");
+
+  cutModeCombo = new QComboBox(this);
+  cutModeCombo->addItem("Off");
+  cutModeCombo->addItem("Clip surface");
+  cutModeCombo->addItem("Slice only");
+  cutModeCombo->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+  cutModeCombo->setStyleSheet("QComboBox {"
+                              "   border: 1px solid #3a4756;"
+                              "   border-radius: 0px;"
+                              "   padding: 6px;"
+                              "   background-color: #10161d;"
+                              "   color: #e6f3ff;"
+                              "   selection-background-color: #00bcd4;"
+                              "   selection-color: #04151d;"
+                              "}"
+                              "QComboBox::drop-down {"
+                              "   border-left: 1px solid #3a4756;"
+                              "   width: 22px;"
+                              "   background-color: #141c24;"
+                              "}"
+                              "QComboBox:enabled:hover {"
+                              "   border: 1px solid #00bcd4;"
+                              "}"
+                              "QComboBox:disabled {"
+                              "   background-color: #1a2129;"
+                              "   color: #5a6877;"
+                              "}"
+                              "QComboBox QAbstractItemView {"
+                              "   background-color: #10161d;"
+                              "   color: #e6f3ff;"
+                              "   border: 1px solid #3a4756;"
+                              "   selection-background-color: #00bcd4;"
+                              "   selection-color: #04151d;"
+                              "}");
+
+  cutLayout->addWidget(cutLabel);
+  cutLayout->addWidget(cutModeCombo, 1);
+  rightLayout->addWidget(cutGroupBox);
+
+  // Isosurfaces of the selected field (enabled with a model)
+  isoGroupBox = new QGroupBox("Isosurfaces", this);
+  isoGroupBox->setCheckable(true);
+  isoGroupBox->setChecked(false);
+  isoGroupBox->setStyleSheet("QGroupBox {"
+                             "   color: #d9e7f5;"
+                             "   border: 1px solid #3a4756;"
+                             "   border-radius: 0px;"
+                             "   margin-top: 10px;"
+                             "   padding-top: 8px;"
+                             "   background-color: #151d26;"
+                             "}"
+                             "QGroupBox::title {"
+                             "   subcontrol-origin: margin;"
+                             "   left: 8px;"
+                             "   padding: 0 4px;"
+                             "   color: #64e8ff;"
+                             "   font-weight: 600;"
+                             "}");
+  isoGroupBox->setEnabled(false);
+  QVBoxLayout *isoLayout = new QVBoxLayout(isoGroupBox);
+  isoLayout->setSpacing(8);
+
+  // Value row; the slider spans the color range of the field
+  QHBoxLayout *isoValueLayout = new QHBoxLayout();
+  isoValueLayout->setSpacing(8);
+
+  QLabel *isoLabel = new QLabel("◈ Value:", this);
+  isoLabel->setMinimumWidth(80);
+  isoLabel->setStyleSheet("QLabel {"
+                          "   color: #8fb0cf;"
+                          "   font-weight: 600;"
+                          "   background-color: transparent;"
+                          "}");
+
+  isoValueSlider = new QSlider(Qt::Horizontal, this);
+  isoValueSlider->setRange(0, 1000);
+  isoValueSlider->setValue(500);
+  isoValueSlider->setStyleSheet("QSlider::groove:horizontal {"
+                                "   height: 4px;"
+                                "   background-color: #3a4756;"
+                                "}"
+                                "QSlider::sub-page:horizontal {"
+                                "   background-color: #00bcd4;"
+                                "}"
+                                "QSlider::handle:horizontal {"
+                                "   width: 12px;"
+                                "   margin: -5px 0;"
+                                "   background-color: #d9e7f5;"
+                                "}");
+
+  isoValueLabel = new QLabel("-", this);
+  isoValueLabel->setMinimumWidth(64);
+  isoValueLabel->setStyleSheet("QLabel {"
+                               "   color: #b3c4d6;"
+                               "   background-color: transparent;"
+                               "}");
+
+  isoValueLayout->addWidget(isoLabel);
+  isoValueLayout->addWidget(isoValueSlider, 1);
+  isoValueLayout->addWidget(isoValueLabel);
+
+  // Kept values row: the slider value is added to the kept ones
+  QHBoxLayout *isoButtonsLayout = new QHBoxLayout();
+  isoButtonsLayout->setSpacing(8);
+
+  keepIsoValueButton = new QPushButton("📌 Keep", this);
+  keepIsoValueButton->setToolTip(
+      "Keep an isosurface at this value while the slider moves on");
+  keepIsoValueButton->setStyleSheet("QPushButton {"
+                                     "   background-color: #121820;"
+                                     "   color: #d9e7f5;"
+                                     "   border: 2px solid #2a3a4b;"
+                                     "   border-radius: 0px;"
+                                     "   padding: 6px 12px;"
+                                     "   font-weight: 600;"
+                                     "}"
+                                     "QPushButton:hover {"
+                                     "   background-color: #0f2630;"
+                                     "   color: #64e8ff;"
+                                     "   border: 2px solid #00bcd4;"
+                                     "}"
+                                     "QPushButton:pressed {"
+                                     "   background-color: #093946;"
+                                     "   border: 2px solid #00bcd4;"
+                                     "}"
+                                     "QPushButton:disabled {"
+                                     "   background-color: #171d24;"
+                                     "   border: 2px solid #35414e;"
+                                     "   color: #607182;"
+                                     "}");
+
+  clearIsoValuesButton = new QPushButton("Clear", this);
+  clearIsoValuesButton->setToolTip("Drop the kept isosurfaces");
+  clearIsoValuesButton->setStyleSheet("QPushButton {"
+                                       "   background-color: #121820;"
+                                       "   color: #d9e7f5;"
+                                       "   border: 2px solid #2a3a4b;"
+                                       "   border-radius: 0px;"
+                                       "   padding: 6px 12px;"
+                                       "   font-weight: 600;"
+                                       "}"
+                                       "QPushButton:hover {"
+                                       "   background-color: #0f2630;"
+                                       "   color: #64e8ff;"
+                                       "   border: 2px solid #00bcd4;"
+                                       "}"
+                                       "QPushButton:pressed {"
+                                       "   background-color: #093946;"
+                                       "   border: 2px solid #00bcd4;"
+                                       "}"
+                                       "QPushButton:disabled {"
+                                       "   background-color: #171d24;"
+                                       "   border: 2px solid #35414e;"
+                                       "   color: #607182;"
+                                       "}");
+
+  isoButtonsLayout->addWidget(keepIsoValueButton);
+  isoButtonsLayout->addWidget(clearIsoValuesButton);
+  isoButtonsLayout->addStretch(1);
+
+  isoLayout->addLayout(isoValueLayout);
+  isoLayout->addLayout(isoButtonsLayout);
+  rightLayout->addWidget(isoGroupBox);
+
+  // Memory breakdown and budget
+  memoryGroupBox = new QGroupBox("Memory", this);
+  memoryGroupBox->setStyleSheet("QGroupBox {"
+                                "   color: #d9e7f5;"
+                                "   border: 1px solid #3a4756;"
+                                "   border-radius: 0px;"
+                                "   margin-top: 10px;"
+                                "   padding-top: 8px;"
+                                "   background-color: #151d26;"
+                                "}"
+                                "QGroupBox::title {"
+                                "   subcontrol-origin: margin;"
+                                "   left: 8px;"
+                                "   padding: 0 4px;"
+                                "   color: #64e8ff;"
+                                "   font-weight: 600;"
+                                "}");
+  QVBoxLayout *memoryLayout = new QVBoxLayout(memoryGroupBox);
+  memoryLayout->setSpacing(8);
+
+  memoryUsageLabel = new QLabel("No model loaded.", this);
+  memoryUsageLabel->setTextFormat(Qt::RichText);
+  memoryUsageLabel->setStyleSheet("QLabel {"
+                                  "   color: #b3c4d6;"
+                                  "   font-size: 11px;"
+                                  "   background-color: transparent;"
+                                  "}");
+
+  QHBoxLayout *memoryBudgetLayout = new QHBoxLayout();
+  memoryBudgetLayout->setSpacing(8);
+
+  QLabel *memoryBudgetLabel = new QLabel("💾 Budget:", this);
+  memoryBudgetLabel->setMinimumWidth(80);
+  memoryBudgetLabel->setStyleSheet("QLabel {"
+                                   "   color: #8fb0cf;"
+                                   "   font-weight: 600;"
+                                   "   background-color: transparent;"
+                                   "}");
+
+  // 0 keeps every array resident
+  memoryBudgetSpinBox = new QDoubleSpinBox(this);
+  memoryBudgetSpinBox->setRange(0.0, 1024.0);
+  memoryBudgetSpinBox->setSingleStep(0.5);
+  memoryBudgetSpinBox->setDecimals(1);
+  memoryBudgetSpinBox->setSuffix(" GiB");
+  memoryBudgetSpinBox->setSpecialValueText("Unlimited");
+  memoryBudgetSpinBox->setValue(memoryBudget / (1024.0 * 1024.0 * 1024.0));
+  memoryBudgetSpinBox->setSizePolicy(QSizePolicy::Expanding,
+                                     QSizePolicy::Fixed);
+  memoryBudgetSpinBox->setStyleSheet("QDoubleSpinBox {"
+                                     "   border: 1px solid #3a4756;"
+                                     "   border-radius: 0px;"
+                                     "   padding: 6px;"
+                                     "   background-color: #10161d;"
+                                     "   color: #e6f3ff;"
+                                     "}"
+                                     "QDoubleSpinBox:hover {"
+                                     "   border: 1px solid #00bcd4;"
+                                     "}");
+
+  memoryBudgetLayout->addWidget(memoryBudgetLabel);
+  memoryBudgetLayout->addWidget(memoryBudgetSpinBox);
+
+  QHBoxLayout *cacheBudgetLayout = new QHBoxLayout();
+  cacheBudgetLayout->setSpacing(8);
+
+  QLabel *cacheBudgetLabel = new QLabel("🗄 Cache:", this);
+  cacheBudgetLabel->setMinimumWidth(80);
+  cacheBudgetLabel->setStyleSheet("QLabel {"
+                                  "   color: #8fb0cf;"
+                                  "   font-weight: 600;"
+                                  "   background-color: transparent;"
+                                  "}");
+
+  // Disk space of the decoded model cache; 0 keeps every entry
+  cacheBudgetSpinBox = new QDoubleSpinBox(this);
+  cacheBudgetSpinBox->setRange(0.0, 4096.0);
+  cacheBudgetSpinBox->setSingleStep(1.0);
+  cacheBudgetSpinBox->setDecimals(1);
+  cacheBudgetSpinBox->setSuffix(" GiB");
+  cacheBudgetSpinBox->setSpecialValueText("Unlimited");
+  // Pruning removes entries; typed values apply once they are complete
+  cacheBudgetSpinBox->setKeyboardTracking(false);
+  cacheBudgetSpinBox->setValue(decodedModelCacheBudget /
+                               (1024.0 * 1024.0 * 1024.0));
+  cacheBudgetSpinBox->setSizePolicy(QSizePolicy::Expanding,
+                                    QSizePolicy::Fixed);
+  cacheBudgetSpinBox->setStyleSheet("QDoubleSpinBox {"
+                                    "   border: 1px solid #3a4756;"
+                                    "   border-radius: 0px;"
+                                    "   padding: 6px;"
+                                    "   background-color: #10161d;"
+                                    "   color: #e6f3ff;"
+                                    "}"
+                                    "QDoubleSpinBox:hover {"
+                                    "   border: 1px solid #00bcd4;"
+                                    "}");
+
+  cacheBudgetLayout->addWidget(cacheBudgetLabel);
+  cacheBudgetLayout->addWidget(cacheBudgetSpinBox);
+
+  memoryLayout->addWidget(memoryUsageLabel);
+  memoryLayout->addLayout(memoryBudgetLayout);
+  memoryLayout->addLayout(cacheBudgetLayout);
+  rightLayout->addWidget(memoryGroupBox);
+
+  // Time Series (visible only while a time series is opened)
+  timeSeriesGroupBox = new QGroupBox("Time Series", this);
+  timeSeriesGroupBox->setStyleSheet("QGroupBox {"
+                                    "   color: #d9e7f5;"
+                                    "   border: 1px solid #3a4756;"
+                                    "   border-radius: 0px;"
+                                    "   margin-top: 10px;"
+                                    "   padding-top: 8px;"
+                                    "   background-color: #151d26;"
+                                    "}"
+                                    "QGroupBox::title {"
+                                    "   subcontrol-origin: margin;"
+                                    "   left: 8px;"
+                                    "   padding: 0 4px;"
+                                    "   color: #64e8ff;"
+                                    "   font-weight: 600;"
+                                    "}");
+  timeSeriesGroupBox->setVisible(false);
+  QVBoxLayout *timeSeriesLayout = new QVBoxLayout(timeSeriesGroupBox);
+  timeSeriesLayout->setSpacing(8);
+
+  QHBoxLayout *playbackLayout = new QHBoxLayout();
+  playbackLayout->setSpacing(8);
+
+  playButton = new QPushButton("▶ Play", this);
+  playButton->setStyleSheet("QPushButton {"
+                            "   background-color: #121820;"
+                            "   color: #d9e7f5;"
+                            "   border: 2px solid #2a3a4b;"
+                            "   border-radius: 0px;"
+                            "   padding: 4px 12px;"
+                            "   font-weight: 600;"
+                            "}"
+                            "QPushButton:hover {"
+                            "   background-color: #0f2630;"
+                            "   color: #64e8ff;"
+                            "   border: 2px solid #00bcd4;"
+                            "}"
+                            "QPushButton:pressed {"
+                            "   background-color: #093946;"
+                            "   border: 2px solid #00bcd4;"
+                            "}");
+
+  timeStepLabel = new QLabel(this);
+  timeStepLabel->setStyleSheet("QLabel {"
+                               "   color: #8fb0cf;"
+                               "   font-weight: 600;"
+                               "   background-color: transparent;"
+                               "}");
+
+  playbackLayout->addWidget(playButton);
+  playbackLayout->addWidget(timeStepLabel, 1);
+
+  timeStepSlider = new QSlider(Qt::Horizontal, this);
+  timeStepSlider->setStyleSheet("QSlider::groove:horizontal {"
+                                "   height: 4px;"
+                                "   background-color: #3a4756;"
+                                "}"
+                                "QSlider::sub-page:horizontal {"
+                                "   background-color: #00bcd4;"
+                                "}"
+                                "QSlider::handle:horizontal {"
+                                "   width: 12px;"
+                                "   margin: -5px 0;"
+                                "   background-color: #d9e7f5;"
+                                "}");
+
+  timeSeriesLayout->addLayout(playbackLayout);
+  timeSeriesLayout->addWidget(timeStepSlider);
+  rightLayout->addWidget(timeSeriesGroupBox);
+
+  playbackTimer = new QTimer(this);
+  playbackTimer->setInterval(static_cast<int>(1000.0 / playbackFrameRate));
+
   // Separator
   QFrame *separator2 = new QFrame(this);
   separator2->setFrameShape(QFrame::HLine);
@@ -279,7 +1053,8 @@ void MainWindow::setupUi() {
   // Info label
   QLabel *infoLabel = new QLabel(
       "💡 Select an array and component to color the mesh.\n"
-      "For multi-component arrays, 'Magnitude' shows all components.",
+      "For multi-component arrays, 'Magnitude' shows all components.\n"
+      "F3 toggles the performance overlay; Ctrl+Shift+T saves a trace.",
       this);
   infoLabel->setWordWrap(true);
   infoLabel->setStyleSheet("QLabel {"
@@ -302,18 +1077,132 @@ void MainWindow::setupConnections() {
           &MainWindow::onOpenFileClicked);
   connect(closeFileButton, &QPushButton::clicked, this,
           &MainWindow::onCloseFileClicked);
+  connect(cancelLoadingButton, &QPushButton::clicked, this,
+          &MainWindow::onCancelLoadingClicked);
+  connect(compareFileButton, &QPushButton::clicked, this,
+          &MainWindow::onCompareFileClicked);
+  connect(watchFileButton, &QPushButton::toggled, this,
+          &MainWindow::onWatchFileToggled);
+  connect(&modelFileWatcher, &ModelFileWatcher::fileRewritten, this,
+          &MainWindow::onWatchedFileRewritten);
 
   // Model loader connections
   connect(&modelLoader, &VtuModelLoader::modelLoaded, this,
           &MainWindow::onModelLoaded);
   connect(&modelLoader, &VtuModelLoader::modelLoadingErrorOccured, this,
           &MainWindow::onModelLoadingErrorOccurred);
+  connect(&modelLoader, &VtuModelLoader::modelLoadingProgressChanged, this,
+          &MainWindow::onModelLoadingProgressChanged);
+  connect(&modelLoader, &VtuModelLoader::modelLoadingCancelled, this,
+          &MainWindow::onModelLoadingCancelled);
+  connect(&modelLoader, &VtuModelLoader::pointArraysDecoded, this,
+          &MainWindow::onPointArraysDecoded);
+  connect(&modelLoader, &VtuModelLoader::pointArrayDecodingFailed, this,
+          &MainWindow::onPointArrayDecodingFailed);
+  connect(&modelLoader, &VtuModelLoader::pointArrayDecodingCancelled, this,
+          &MainWindow::onPointArrayDecodingCancelled);
+
+  // Comparison connections (progress shares the loading indicator)
+  connect(&modelComparer, &ModelComparer::comparisonFinished, this,
+          &MainWindow::onComparisonFinished);
+  connect(&modelComparer, &ModelComparer::comparisonFailed, this,
+          &MainWindow::onComparisonFailed);
+  connect(&modelComparer, &ModelComparer::comparisonProgressChanged, this,
+          &MainWindow::onModelLoadingProgressChanged);
 
   // Array/Component selector connections
   connect(arrayCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
           &MainWindow::onArrayIndexChanged);
   connect(componentCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
           this, &MainWindow::onComponentIndexChanged);
+  connect(colorRangeCombo,
+          QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+          &MainWindow::onColorRangeModeChanged);
+  connect(cellDataModeCombo,
+          QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+          &MainWindow::onCellDataModeChanged);
+
+  // Deformed shape connections
+  connect(warpScaleSlider, &QSlider::valueChanged, this,
+          &MainWindow::onWarpScaleChanged);
+
+  // Clip and slice connections
+  connect(cutModeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+          this, &MainWindow::onCutModeChanged);
+  connect(&planeCutter, &PlaneCutter::cutFinished, this,
+          &MainWindow::onPlaneCutFinished);
+
+  // Isosurface connections
+  connect(isoGroupBox, &QGroupBox::toggled, this,
+          &MainWindow::onIsosurfacesToggled);
+  connect(isoValueSlider, &QSlider::valueChanged, this,
+          &MainWindow::onIsoValueChanged);
+  connect(keepIsoValueButton, &QPushButton::clicked, this,
+          &MainWindow::onKeepIsoValueClicked);
+  connect(clearIsoValuesButton, &QPushButton::clicked, this,
+          &MainWindow::onClearIsoValuesClicked);
+  connect(&isosurfaceExtractor, &IsosurfaceExtractor::isosurfacesExtracted,
+          this, &MainWindow::onIsosurfacesExtracted);
+
+  // Memory connections
+  connect(memoryBudgetSpinBox,
+          QOverload<double>::of(&QDoubleSpinBox::valueChanged), this,
+          &MainWindow::onMemoryBudgetChanged);
+  connect(cacheBudgetSpinBox,
+          QOverload<double>::of(&QDoubleSpinBox::valueChanged), this,
+          &MainWindow::onCacheBudgetChanged);
+
+  // Time series connections
+  connect(playButton, &QPushButton::clicked, this, &MainWindow::onPlayClicked);
+  connect(timeStepSlider, &QSlider::valueChanged, this,
+          &MainWindow::onTimeStepSliderChanged);
+  connect(playbackTimer, &QTimer::timeout, this,
+          &MainWindow::onPlaybackTimeout);
+  connect(&timeStepPrefetcher, &TimeStepPrefetcher::stepReady, this,
+          &MainWindow::onTimeStepReady);
+  connect(&timeStepPrefetcher, &TimeStepPrefetcher::stepFailed, this,
+          &MainWindow::onTimeStepFailed);
+
+  // Level of detail connections
+  connect(&proxyBuilder, &SurfaceProxyBuilder::proxyBuilt, this,
+          &MainWindow::onSurfaceProxyBuilt);
+  vtkEventConnections = vtkSmartPointer<vtkEventQtSlotConnect>::New();
+  vtkInteractorObserver *interactorStyle =
+      vtkVisualizer->interactor()->GetInteractorStyle();
+  vtkEventConnections->Connect(interactorStyle,
+                               vtkCommand::StartInteractionEvent, this,
+                               SLOT(onInteractionStarted()));
+  vtkEventConnections->Connect(interactorStyle, vtkCommand::EndInteractionEvent,
+                               this, SLOT(onInteractionEnded()));
+  vtkEventConnections->Connect(renderer, vtkCommand::EndEvent, this,
+                               SLOT(onRenderFinished()));
+  vtkEventConnections->Connect(cutPlaneWidget, vtkCommand::InteractionEvent,
+                               this, SLOT(onCutPlaneMoved()));
+
+  // Probe connections
+  vtkEventConnections->Connect(vtkVisualizer->interactor(),
+                               vtkCommand::MouseMoveEvent, this,
+                               SLOT(onProbeMouseMoved()));
+  vtkEventConnections->Connect(vtkVisualizer->interactor(),
+                               vtkCommand::LeaveEvent, this,
+                               SLOT(onProbeMouseLeft()));
+
+  // Performance overlay connections
+  vtkEventConnections->Connect(vtkVisualizer->renderWindow(),
+                               vtkCommand::StartEvent, this,
+                               SLOT(onFrameStarted()));
+  vtkEventConnections->Connect(vtkVisualizer->renderWindow(),
+                               vtkCommand::EndEvent, this,
+                               SLOT(onFrameFinished()));
+  connect(perfOverlayTimer, &QTimer::timeout, this,
+          &MainWindow::updatePerfOverlay);
+  auto *perfOverlayShortcut = new QShortcut(QKeySequence(Qt::Key_F3), this);
+  connect(perfOverlayShortcut, &QShortcut::activated, this,
+          &MainWindow::onTogglePerfOverlay);
+  auto *saveTraceShortcut =
+      new QShortcut(QKeySequence("Ctrl+Shift+T"), this);
+  connect(saveTraceShortcut, &QShortcut::activated, this,
+          &MainWindow::onSaveTraceRequested);
 }
 
 /* INTERNAL SLOTS */
@@ -332,24 +1221,166 @@ void MainWindow::onOpenFileClicked() {
                          QString("File not found: %1").arg(filePath));
     return;
   }
-  // Load model(Loader will emit modelLoaded or modelLoadingErrorOccurred)
-  modelLoader.load(filePath);
+  openFile(filePath);
 }
 
 void MainWindow::onCloseFileClicked() { closeFile(); }
 
+void MainWindow::onCancelLoadingClicked() {
+  modelLoader.cancel();
+  // Cancelled comparisons report nothing back
+  if (modelComparer.isComparing()) {
+    modelComparer.cancel();
+    setLoadingIndicatorVisible(LoadingOperation::Comparison, false);
+  }
+}
+
+void MainWindow::onCompareFileClicked() {
+  if (openedVtuModel == nullptr) {
+    return;
+  }
+  const QString filePath = QFileDialog::getOpenFileName(
+      this, "Select Result to Compare", openedVtuModelFileInfo->path(),
+      fileFilter);
+  if (filePath.isEmpty()) {
+    return;
+  }
+  setLoadingIndicatorVisible(LoadingOperation::Comparison, true);
+  modelComparer.compareAsync(*openedVtuModel, filePath);
+}
+
+void MainWindow::onWatchFileToggled(bool watching) {
+  if (watching && openedVtuModelFileInfo != nullptr &&
+      openedTimeSeries.isEmpty()) {
+    modelFileWatcher.watch(openedVtuModelFileInfo->filePath());
+  } else {
+    modelFileWatcher.stop();
+  }
+}
+
+/* File Watching */
+void MainWindow::onWatchedFileRewritten(const QString &filePath) {
+  // A load in progress delivers the file as it is now anyway
+  if (openedVtuModel == nullptr || modelLoader.isLoading()) {
+    return;
+  }
+  PerfTrace::Scope scope("ui", "Reload rewritten file");
+  VtuHeader header;
+  QString errorMessage;
+  if (!VtuHeaderScanner::scan(filePath, header, errorMessage)) {
+    QMessageBox::warning(this, "Error Reloading Model", errorMessage);
+    return;
+  }
+
+  // Another mesh is loaded again, as the watched file alone
+  QStringList changedPointArrays;
+  if (!VtuModelLoader::findChangedPointArrays(openedVtuModel->header, header,
+                                              changedPointArrays)) {
+    loadFile(filePath);
+    return;
+  }
+
+  // Same mesh: only the changed arrays are decoded again; topology, camera,
+  // the selection and everything cached for other arrays are kept
+  const QString selectedArrayName = arrayCombo->currentText();
+  modelLoader.cancelPointArrayDecode(); // Would decode the previous values
+  decodingPointArrays.clear();
+  if (!VtuModelLoader::reloadChangedPointArrays(
+          *openedVtuModel, header, changedPointArrays, errorMessage)) {
+    QMessageBox::warning(this, "Error Reloading Model", errorMessage);
+    return;
+  }
+  for (const QString &arrayName : changedPointArrays) {
+    colorBufferCache.removeArray(arrayName);
+  }
+
+  // Comparison fields were computed from the previous values
+  if (!openedVtuModel->derivedPointArrays.isEmpty()) {
+    for (const QString &arrayName : openedVtuModel->derivedPointArrays) {
+      colorBufferCache.removeArray(arrayName);
+    }
+    VtuModelLoader::removeDerivedPointArrays(*openedVtuModel);
+    arrayCombo->blockSignals(true);
+    setArrayComboboxItems(selectableArrayNames());
+    arrayCombo->blockSignals(false);
+  }
+  const int arrayIndex = arrayCombo->findText(selectedArrayName);
+  if (arrayIndex < 0) {
+    onArrayIndexChanged(0);
+    return;
+  }
+  setArrayComboboxIndex(arrayIndex);
+  const int componentIndex = VtuModelLoader::comboIndexToVtkIndex(
+      *arrayInfoAt(arrayIndex), componentCombo->currentIndex());
+
+  // The deformed shape follows a changed displacement
+  if (warpScaleSlider->value() > 0) {
+    warpDisplacement = nullptr;
+    updateWarp();
+  }
+  upadateSceneColoring(arrayIndex, componentIndex);
+  rerenderVtkVisualizer();
+}
+
+/* Comparison */
+void MainWindow::onComparisonFinished(ComparisonResult *result) {
+  QScopedPointer<ComparisonResult> ownedResult(result);
+  setLoadingIndicatorVisible(LoadingOperation::Comparison, false);
+  if (openedVtuModel == nullptr || result == nullptr) {
+    return;
+  }
+  if (result->arrays.isEmpty()) {
+    QMessageBox::warning(
+        this, "Nothing to Compare",
+        "The files have no point arrays in common:\n" + result->otherFilePath);
+    return;
+  }
+
+  // Fields of an earlier comparison are replaced; the new fields reuse
+  // their names, so their cached colors are stale
+  for (const QString &arrayName : openedVtuModel->derivedPointArrays) {
+    colorBufferCache.removeArray(arrayName);
+  }
+  VtuModelLoader::removeDerivedPointArrays(*openedVtuModel);
+  const int firstFieldIndex = openedVtuModel->pointArraysInfo.size();
+  VtuModelLoader::addDerivedPointArrays(*openedVtuModel, result->arrays);
+
+  arrayCombo->blockSignals(true);
+  setArrayComboboxItems(selectableArrayNames());
+  arrayCombo->blockSignals(false);
+
+  // Show the first difference field right away
+  onArrayIndexChanged(firstFieldIndex);
+
+  if (!result->skippedArrays.isEmpty()) {
+    QMessageBox::information(
+        this, "Arrays Skipped",
+        "These arrays differ in shape and were not compared:\n" +
+            result->skippedArrays.join(", "));
+  }
+}
+
+void MainWindow::onComparisonFailed(const QString &errorMessage) {
+  setLoadingIndicatorVisible(LoadingOperation::Comparison, false);
+  QMessageBox::warning(this, "Comparison Failed", errorMessage);
+}
+
 /* Model Loading */
 void MainWindow::onModelLoaded(LoadedVtuModel *model,
                                const QString &modelFilePath) {
+  PerfTrace::Scope scope("ui", "Show loaded model");
+  setLoadingIndicatorVisible(LoadingOperation::ModelLoad, false);
+
   // Validate model
   if (model == nullptr || model->grid == nullptr) {
     QMessageBox::warning(this, "No Model Loaded",
                          "No model loaded. Please open a valid VTU file.");
     return;
   }
-  if (model->pointArraysInfo.empty()) {
-    QMessageBox::warning(this, "No Point Arrays",
-                         "No numeric point arrays found for coloring.");
+  if (model->pointArraysInfo.empty() &&
+      (model->cellArraysInfo.empty() || !pendingTimeSeries.isEmpty())) {
+    QMessageBox::warning(this, "No Arrays",
+                         "No numeric point or cell arrays found for coloring.");
     return;
   }
 
@@ -359,26 +1390,20 @@ void MainWindow::onModelLoaded(LoadedVtuModel *model,
   // Set attributes – MainWindow now owns the model and its file info
   this->openedVtuModel.reset(model);
   this->openedVtuModelFileInfo.reset(new QFileInfo(modelFilePath));
+  openedTimeSeries = pendingTimeSeries;
+  pendingTimeSeries = VtuTimeSeries();
 
   // Set initial array and component indices
   int initialArrayIndex = 0;
   int initialComponentIndex = 0;
-  if (!openedVtuModel->pointArraysInfo.isEmpty() &&
-      VtuModelLoader::hasMagnitudeOption(
-          openedVtuModel->pointArraysInfo[initialArrayIndex])) {
+  const PointArrayInfo *initialArrayInfo = arrayInfoAt(initialArrayIndex);
+  if (VtuModelLoader::hasMagnitudeOption(*initialArrayInfo)) {
     initialComponentIndex = -1;
   }
 
-  // Set array combobox items
-  QVector<QString> arrayNames;
-  for (const PointArrayInfo &arrayInfo : openedVtuModel->pointArraysInfo) {
-    arrayNames.push_back(arrayInfo.name);
-  }
-
   // Update Selector
-  setArrayComboboxItems(arrayNames);
-  setComponentComboboxItems(
-      openedVtuModel->pointArraysInfo[initialArrayIndex].componentNames);
+  setArrayComboboxItems(selectableArrayNames());
+  setComponentComboboxItems(initialArrayInfo->componentNames);
   setArrayComboboxIndex(initialArrayIndex);
   setComponentComboboxIndex(initialComponentIndex);
   setArrayComboboxEnabled(true);
@@ -390,40 +1415,100 @@ void MainWindow::onModelLoaded(LoadedVtuModel *model,
 
   // Update VTK
   syncModelActorWithOpenedModel();
+  syncWarpWithOpenedModel();
+  syncCutWithOpenedModel();
+  // Locators for probing are built in the background
+  surfaceProbe.buildAsync(openedVtuModel->surface);
+  syncIsosurfacesWithOpenedModel();
   upadateSceneColoring(0, initialComponentIndex);
   rerenderVtkVisualizer();
+
+  // Update Time Series
+  syncTimeSeriesWithOpenedModel();
 }
 
 void MainWindow::onModelLoadingErrorOccurred(const QString &errorMessage) {
+  setLoadingIndicatorVisible(LoadingOperation::ModelLoad, false);
   QMessageBox::warning(this, "Error Loading Model", errorMessage);
 }
 
+void MainWindow::onModelLoadingProgressChanged(double progress,
+                                               const QString &stage) {
+  loadingProgressBar->setValue(static_cast<int>(progress * 100.0));
+  loadingProgressBar->setFormat(stage + " %p%");
+}
+
+void MainWindow::onModelLoadingCancelled(const QString &modelFilePath) {
+  Q_UNUSED(modelFilePath);
+  setLoadingIndicatorVisible(LoadingOperation::ModelLoad, false);
+}
+
+void MainWindow::onPointArraysDecoded(
+    const QString &modelFilePath,
+    const QVector<vtkSmartPointer<vtkDataArray>> &arrays) {
+  decodingPointArrays.clear();
+  setLoadingIndicatorVisible(LoadingOperation::PointArrayDecode, false);
+  // Arrays of a closed model or of a previous time step are dropped
+  if (openedVtuModel == nullptr || openedVtuModel->filePath != modelFilePath) {
+    return;
+  }
+  VtuModelLoader::installPointArrays(*openedVtuModel, arrays);
+
+  // Redo what waited for the arrays
+  if (warpScaleSlider->value() > 0) {
+    updateWarp();
+  }
+  const int arrayIndex = arrayCombo->currentIndex();
+  const PointArrayInfo *arrayInfo = arrayInfoAt(arrayIndex);
+  if (arrayInfo != nullptr) {
+    upadateSceneColoring(arrayIndex,
+                         VtuModelLoader::comboIndexToVtkIndex(
+                             *arrayInfo, componentCombo->currentIndex()));
+  }
+  rerenderVtkVisualizer();
+}
+
+void MainWindow::onPointArrayDecodingFailed(const QString &errorMessage) {
+  decodingPointArrays.clear();
+  setLoadingIndicatorVisible(LoadingOperation::PointArrayDecode, false);
+  QMessageBox::warning(this, "Error Decoding Point Array", errorMessage);
+}
+
+void MainWindow::onPointArrayDecodingCancelled() {
+  decodingPointArrays.clear();
+  setLoadingIndicatorVisible(LoadingOperation::PointArrayDecode, false);
+}
+
 /* Array/Component Selector */
 void MainWindow::onArrayIndexChanged(int arrayIndex) {
   if (openedVtuModel == nullptr) {
     return;
   }
   // Validate array index
-  if (arrayIndex < 0 ||
-      arrayIndex >= static_cast<int>(openedVtuModel->pointArraysInfo.size())) {
+  const PointArrayInfo *arrayInfo = arrayInfoAt(arrayIndex);
+  if (arrayInfo == nullptr) {
     QMessageBox::warning(this, "Invalid Array Index",
                          QString("Invalid array index: %1").arg(arrayIndex));
     return;
   }
-  // Get array info
-  const auto &arrayInfo = openedVtuModel->pointArraysInfo[arrayIndex];
   int initialComponentIndex =
-      VtuModelLoader::hasMagnitudeOption(arrayInfo) ? -1 : 0;
+      VtuModelLoader::hasMagnitudeOption(*arrayInfo) ? -1 : 0;
 
   // Update Selector
   setArrayComboboxIndex(arrayIndex);
-  setComponentComboboxItems(
-      openedVtuModel->pointArraysInfo[arrayIndex].componentNames);
+  setComponentComboboxItems(arrayInfo->componentNames);
   setComponentComboboxIndex(initialComponentIndex);
+  keptIsoValues.clear(); // Values of the previous field
 
   // Update VTK
   upadateSceneColoring(arrayIndex, initialComponentIndex);
   rerenderVtkVisualizer();
+
+  // Prefetch the newly selected array of the upcoming steps
+  if (!openedTimeSeries.isEmpty()) {
+    timeStepPrefetcher.setArrayName(arrayInfo->name);
+    timeStepPrefetcher.setPlayhead(currentTimeStep);
+  }
 }
 
 void MainWindow::onComponentIndexChanged(int comboIndex) {
@@ -432,24 +1517,415 @@ void MainWindow::onComponentIndexChanged(int comboIndex) {
   }
   // Validate array index
   int arrayIndex = arrayCombo->currentIndex();
-  if (!(arrayIndex >= 0 &&
-        arrayIndex < openedVtuModel->pointArraysInfo.size())) {
+  const PointArrayInfo *arrayInfo = arrayInfoAt(arrayIndex);
+  if (arrayInfo == nullptr) {
     return;
   }
-  const auto &array = openedVtuModel->pointArraysInfo[arrayIndex];
 
   // Convert combo index to vtk index
   int vtkComponentIndex =
-      VtuModelLoader::comboIndexToVtkIndex(array, comboIndex);
+      VtuModelLoader::comboIndexToVtkIndex(*arrayInfo, comboIndex);
 
   // Update Selector
   setComponentComboboxIndex(vtkComponentIndex);
+  keptIsoValues.clear();
 
   // Update VTK
   upadateSceneColoring(arrayIndex, vtkComponentIndex);
   rerenderVtkVisualizer();
 }
 
+void MainWindow::onColorRangeModeChanged(int modeIndex) {
+  const QPointF percentiles = colorRangeCombo->itemData(modeIndex).toPointF();
+  colorRangePercentiles.lower = percentiles.x();
+  colorRangePercentiles.upper = percentiles.y();
+  if (openedVtuModel == nullptr) {
+    return;
+  }
+
+  const int arrayIndex = arrayCombo->currentIndex();
+  const PointArrayInfo *arrayInfo = arrayInfoAt(arrayIndex);
+  if (arrayInfo == nullptr) {
+    return;
+  }
+  const int componentIndex = VtuModelLoader::comboIndexToVtkIndex(
+      *arrayInfo, componentCombo->currentIndex());
+  upadateSceneColoring(arrayIndex, componentIndex);
+  rerenderVtkVisualizer();
+}
+
+void MainWindow::onCellDataModeChanged(int modeIndex) {
+  cellDataMode = (modeIndex == 1) ? SurfaceColoring::CellDataMode::Interpolated
+                                  : SurfaceColoring::CellDataMode::Flat;
+  if (openedVtuModel == nullptr) {
+    return;
+  }
+
+  const int arrayIndex = arrayCombo->currentIndex();
+  if (!isCellArrayIndex(arrayIndex)) {
+    return;
+  }
+  const int componentIndex = VtuModelLoader::comboIndexToVtkIndex(
+      *arrayInfoAt(arrayIndex), componentCombo->currentIndex());
+  upadateSceneColoring(arrayIndex, componentIndex);
+  rerenderVtkVisualizer();
+}
+
+/* Deformed Shape */
+void MainWindow::onWarpScaleChanged(int position) {
+  Q_UNUSED(position);
+  updateWarp();
+  rerenderVtkVisualizer();
+}
+
+/* Clip and Slice */
+void MainWindow::onCutModeChanged(int modeIndex) {
+  cutMode = static_cast<CutMode>(modeIndex);
+  updateCutView();
+  rerenderVtkVisualizer();
+}
+
+void MainWindow::onCutPlaneMoved() {
+  // The clipped surface follows right away on the GPU; the cut follows as
+  // soon as the cutter catches up
+  cutPlaneRepresentation->GetPlane(cutPlane);
+  requestPlaneCut();
+}
+
+void MainWindow::onPlaneCutFinished(vtkSmartPointer<vtkPolyData> cut) {
+  if (openedVtuModel == nullptr || cutMode == CutMode::Off) {
+    return;
+  }
+  if (cut == nullptr) {
+    // The plane misses the grid
+    cutActor->SetVisibility(0);
+  } else {
+    cutMapper->SetInputData(cut);
+    updateCutColoring();
+    cutActor->SetVisibility(1);
+  }
+  rerenderVtkVisualizer();
+}
+
+/* Isosurfaces */
+void MainWindow::onIsosurfacesToggled(bool enabled) {
+  Q_UNUSED(enabled);
+  updateIsosurfaceView();
+  rerenderVtkVisualizer();
+}
+
+void MainWindow::onIsoValueChanged(int position) {
+  Q_UNUSED(position);
+  requestIsosurfaces();
+}
+
+void MainWindow::onKeepIsoValueClicked() {
+  keptIsoValues.push_back(sliderIsoValue());
+  requestIsosurfaces();
+}
+
+void MainWindow::onClearIsoValuesClicked() {
+  keptIsoValues.clear();
+  requestIsosurfaces();
+}
+
+void MainWindow::onIsosurfacesExtracted(
+    vtkSmartPointer<vtkPolyData> isosurfaces) {
+  if (openedVtuModel == nullptr || !isoGroupBox->isChecked()) {
+    return;
+  }
+  if (isosurfaces == nullptr) {
+    // No value within the field
+    isoActor->SetVisibility(0);
+  } else {
+    isoMapper->SetInputData(isosurfaces);
+    isoActor->SetVisibility(1);
+  }
+  rerenderVtkVisualizer();
+}
+
+/* Memory */
+void MainWindow::onMemoryBudgetChanged(double budgetGiB) {
+  memoryBudget = static_cast<qint64>(budgetGiB * 1024.0 * 1024.0 * 1024.0);
+
+  // Later loads and the opened model (evicting arrays beyond the new budget)
+  VtuLoadOptions loadOptions = modelLoader.loadOptions();
+  loadOptions.memoryBudget = memoryBudget;
+  modelLoader.setLoadOptions(loadOptions);
+  if (openedVtuModel != nullptr) {
+    VtuModelLoader::setMemoryBudget(*openedVtuModel, memoryBudget);
+  }
+  updateMemoryPanel();
+}
+
+void MainWindow::onCacheBudgetChanged(double budgetGiB) {
+  decodedModelCacheBudget =
+      static_cast<qint64>(budgetGiB * 1024.0 * 1024.0 * 1024.0);
+
+  // Later stores prune to the new budget; a smaller one applies right away
+  VtuLoadOptions loadOptions = modelLoader.loadOptions();
+  loadOptions.decodedModelCacheBudget = decodedModelCacheBudget;
+  modelLoader.setLoadOptions(loadOptions);
+  if (!loadOptions.decodedModelCacheDirectory.isEmpty()) {
+    DecodedModelCache(loadOptions.decodedModelCacheDirectory,
+                      decodedModelCacheBudget)
+        .prune();
+  }
+}
+
+/* Time Series */
+void MainWindow::onPlayClicked() { setPlaying(!playbackTimer->isActive()); }
+
+void MainWindow::onTimeStepSliderChanged(int step) {
+  if (openedTimeSeries.isEmpty() || step == currentTimeStep) {
+    return;
+  }
+  // Scrubbing shows buffered steps at once, others as soon as they arrive
+  if (!showTimeStep(step)) {
+    requestedTimeStep = step;
+    timeStepPrefetcher.setPlayhead(step);
+  }
+}
+
+void MainWindow::onPlaybackTimeout() {
+  if (openedTimeSeries.isEmpty()) {
+    setPlaying(false);
+    return;
+  }
+  // Playback only advances to buffered steps; it waits for the prefetcher
+  // instead of decoding on the GUI thread
+  const int nextStep = (currentTimeStep + 1) % openedTimeSeries.size();
+  showTimeStep(nextStep);
+}
+
+void MainWindow::onTimeStepReady(int step) {
+  if (step == requestedTimeStep) {
+    showTimeStep(step);
+  }
+}
+
+void MainWindow::onTimeStepFailed(int step, const QString &errorMessage) {
+  Q_UNUSED(step);
+  setPlaying(false);
+  QMessageBox::warning(this, "Time Step Unavailable", errorMessage);
+}
+
+/* Level of Detail */
+void MainWindow::onInteractionStarted() {
+  interactionActive = true;
+  interactionFrameTime = 0.0;
+  interactionFrameCount = 0;
+
+  // Swap in the proxy only when the full surface misses the target rate.
+  // The proxy carries point colors only, so flat cell colors stay on the full
+  // surface.
+  const double targetFrameTime = 1.0 / interactiveFrameRate;
+  if (modelActor != nullptr && proxySurface != nullptr &&
+      coloredSurface != nullptr &&
+      coloredSurface->GetCellData()->GetScalars() == nullptr &&
+      lastStillFrameTime > targetFrameTime) {
+    modelActor->SetMapper(proxyMapper);
+    renderingProxy = true;
+  }
+}
+
+void MainWindow::onInteractionEnded() {
+  interactionActive = false;
+
+  // Coarsen the proxy (or build one) if interaction still missed the target
+  if (interactionFrameCount > 0 && openedVtuModel != nullptr &&
+      openedVtuModel->surface != nullptr) {
+    const vtkIdType renderedTriangles =
+        renderingProxy ? proxySurface->GetNumberOfCells()
+                       : openedVtuModel->surface->GetNumberOfCells();
+    requestSurfaceProxy(renderedTriangles,
+                        interactionFrameTime / interactionFrameCount);
+  }
+
+  // Bring back the full surface
+  if (renderingProxy) {
+    renderingProxy = false;
+    if (modelActor != nullptr) {
+      modelActor->SetMapper(modelMapper);
+    }
+    rerenderVtkVisualizer();
+  }
+}
+
+void MainWindow::onRenderFinished() {
+  if (modelActor == nullptr) {
+    return;
+  }
+  const double frameTime = renderer->GetLastRenderTimeInSeconds();
+  if (interactionActive) {
+    interactionFrameTime += frameTime;
+    ++interactionFrameCount;
+    return;
+  }
+  lastStillFrameTime = frameTime;
+
+  // The first frame of a model decides whether a proxy is worth building
+  if (!surfaceProxyRequested && openedVtuModel != nullptr &&
+      openedVtuModel->surface != nullptr) {
+    surfaceProxyRequested = true;
+    requestSurfaceProxy(openedVtuModel->surface->GetNumberOfCells(),
+                        frameTime);
+  }
+}
+
+void MainWindow::onSurfaceProxyBuilt(vtkSmartPointer<vtkPolyData> proxy) {
+  if (openedVtuModel == nullptr || proxy == nullptr) {
+    return;
+  }
+  proxySurface = proxy;
+  proxyMapper->SetInputData(proxySurface);
+  updateProxyColoring();
+  // Proxies are decimated from the undeformed surface
+  if (warpScaleSlider->value() > 0) {
+    updateProxyPoints();
+  }
+  updateMemoryPanel();
+}
+
+/* Probe */
+void MainWindow::onProbeMouseMoved() {
+  // Only the undeformed, uncut surface is probed; camera drags are left alone
+  if (openedVtuModel == nullptr || !surfaceProbe.isReady() ||
+      interactionActive || warpScaleSlider->value() > 0 ||
+      cutMode != CutMode::Off) {
+    probeLabel->setVisible(false);
+    return;
+  }
+  const int arrayIndex = arrayCombo->currentIndex();
+  const PointArrayInfo *arrayInfo = arrayInfoAt(arrayIndex);
+  bool cellArray = false;
+  vtkDataArray *array = selectedColorArray(cellArray);
+  if (arrayInfo == nullptr || array == nullptr) {
+    probeLabel->setVisible(false);
+    return;
+  }
+
+  // Ray through the cursor from the near to the far clipping plane
+  const int *eventPosition = vtkVisualizer->interactor()->GetEventPosition();
+  double rayStart[4];
+  double rayEnd[4];
+  renderer->SetDisplayPoint(eventPosition[0], eventPosition[1], 0.0);
+  renderer->DisplayToWorld();
+  renderer->GetWorldPoint(rayStart);
+  renderer->SetDisplayPoint(eventPosition[0], eventPosition[1], 1.0);
+  renderer->DisplayToWorld();
+  renderer->GetWorldPoint(rayEnd);
+
+  const int componentIndex = VtuModelLoader::comboIndexToVtkIndex(
+      *arrayInfo, componentCombo->currentIndex());
+  SurfaceProbeResult result;
+  if (!surfaceProbe.probe(rayStart, rayEnd, openedVtuModel->surfacePointIds,
+                          openedVtuModel->surfaceCellIds, array, cellArray,
+                          componentIndex, result)) {
+    probeLabel->setVisible(false);
+    return;
+  }
+
+  probeLabel->setText(
+      QString("%1 (%2) = %3\nNode %4  Cell %5")
+          .arg(arrayInfo->name)
+          .arg(VtuModelLoader::getDisplayNameForVtkIndex(*arrayInfo,
+                                                         componentIndex))
+          .arg(result.value, 0, 'g', 6)
+          .arg(result.nodeId)
+          .arg(result.cellId));
+  probeLabel->adjustSize();
+  probeLabel->move(8, vtkVisualizer->height() - probeLabel->height() - 8);
+  probeLabel->setVisible(true);
+}
+
+void MainWindow::onProbeMouseLeft() { probeLabel->setVisible(false); }
+
+/* Performance Overlay */
+void MainWindow::onFrameStarted() {
+  frameStartNs = PerfTrace::isEnabled() ? PerfTrace::nowNs() : -1;
+}
+
+void MainWindow::onFrameFinished() {
+  if (frameStartNs >= 0) {
+    PerfTrace::record("render", "Frame", frameStartNs,
+                      PerfTrace::nowNs() - frameStartNs);
+    frameStartNs = -1;
+  }
+}
+
+void MainWindow::onTogglePerfOverlay() {
+  const bool visible = !perfOverlayLabel->isVisible();
+  perfOverlayLabel->setVisible(visible);
+  if (visible) {
+    PerfTrace::setEnabled(true);
+    updatePerfOverlay();
+    perfOverlayTimer->start();
+  } else {
+    perfOverlayTimer->stop();
+    // Keep tracing if it was requested at startup
+    PerfTrace::setEnabled(qEnvironmentVariableIsSet("VTK_RENDERER_TRACE"));
+  }
+}
+
+void MainWindow::onSaveTraceRequested() {
+  if (PerfTrace::recentEvents(1).isEmpty()) {
+    QMessageBox::information(
+        this, "No Trace Recorded",
+        "Nothing was traced yet. Press F3 to start tracing, reproduce the "
+        "slow operation and save again.");
+    return;
+  }
+  const QString filePath = QFileDialog::getSaveFileName(
+      this, "Save Trace", "vtk-renderer-trace.json",
+      "Chrome trace (*.json);;All files (*.*)");
+  if (filePath.isEmpty()) {
+    return;
+  }
+  QString errorMessage;
+  if (!PerfTrace::writeChromeTrace(filePath, errorMessage)) {
+    QMessageBox::warning(this, "Error Saving Trace", errorMessage);
+  }
+}
+
+void MainWindow::updatePerfOverlay() {
+  auto isFrame = [](const PerfTraceEvent &event) {
+    return std::strcmp(event.category, "render") == 0 &&
+           std::strcmp(event.name, "Frame") == 0;
+  };
+  const QVector<PerfTraceEvent> frames =
+      PerfTrace::recentEvents(perfOverlayFrameCount, isFrame);
+  const QVector<PerfTraceEvent> operations = PerfTrace::recentEvents(
+      perfOverlayOperationCount,
+      [&isFrame](const PerfTraceEvent &event) { return !isFrame(event); });
+
+  QStringList lines;
+  if (frames.isEmpty()) {
+    lines.push_back("Frame -");
+  } else {
+    double totalMs = 0.0;
+    for (const PerfTraceEvent &frame : frames) {
+      totalMs += frame.durationNs / 1.0e6;
+    }
+    const double averageMs = totalMs / frames.size();
+    lines.push_back(QString("Frame %1 ms (avg %2 ms of %3, %4 fps)")
+                        .arg(frames.last().durationNs / 1.0e6, 0, 'f', 1)
+                        .arg(averageMs, 0, 'f', 1)
+                        .arg(frames.size())
+                        .arg(1000.0 / std::max(averageMs, 0.001), 0, 'f', 0));
+  }
+  lines.push_back(QString());
+  // Newest operation first
+  for (auto it = operations.crbegin(); it != operations.crend(); ++it) {
+    lines.push_back(QString("%1 %2 ms  [%3]")
+                        .arg(QString::fromUtf8(it->name), -26)
+                        .arg(it->durationNs / 1.0e6, 9, 'f', 1)
+                        .arg(QString::fromUtf8(it->category)));
+  }
+  perfOverlayLabel->setText(lines.join('\n'));
+  perfOverlayLabel->adjustSize();
+}
+
 /* UI UPDATES */
 /* Array/Component selector */
 void MainWindow::setArrayComboboxItems(QVector<QString> items) {
@@ -472,15 +1948,13 @@ void MainWindow::setArrayComboboxIndex(int index) {
 }
 
 void MainWindow::setComponentComboboxIndex(int vtkComponentIndex) {
-  int arrayIndex = arrayCombo->currentIndex();
-  if (!(arrayIndex >= 0 &&
-        arrayIndex < openedVtuModel->pointArraysInfo.size())) {
+  const PointArrayInfo *arrayInfo = arrayInfoAt(arrayCombo->currentIndex());
+  if (arrayInfo == nullptr) {
     return;
   }
-  const auto &arrayInfo = openedVtuModel->pointArraysInfo[arrayIndex];
 
   int comboIndex =
-      VtuModelLoader::vtkIndexToComboIndex(arrayInfo, vtkComponentIndex);
+      VtuModelLoader::vtkIndexToComboIndex(*arrayInfo, vtkComponentIndex);
 
   if (!(comboIndex >= 0 && comboIndex < componentCombo->count())) {
     return;
@@ -503,6 +1977,521 @@ void MainWindow::clearSelectorComboboxes() {
   componentCombo->clear();
 }
 
+QVector<QString> MainWindow::selectableArrayNames() const {
+  QVector<QString> arrayNames;
+  for (const PointArrayInfo &arrayInfo : openedVtuModel->pointArraysInfo) {
+    arrayNames.push_back(arrayInfo.name);
+  }
+  if (openedTimeSeries.isEmpty()) {
+    for (const PointArrayInfo &arrayInfo : openedVtuModel->cellArraysInfo) {
+      arrayNames.push_back(arrayInfo.name + " [cell]");
+    }
+  }
+  return arrayNames;
+}
+
+const PointArrayInfo *MainWindow::arrayInfoAt(int arrayIndex) const {
+  if (openedVtuModel == nullptr || arrayIndex < 0) {
+    return nullptr;
+  }
+  const int pointArrayCount = openedVtuModel->pointArraysInfo.size();
+  if (arrayIndex < pointArrayCount) {
+    return &openedVtuModel->pointArraysInfo[arrayIndex];
+  }
+  const int cellArrayIndex = arrayIndex - pointArrayCount;
+  if (!openedTimeSeries.isEmpty() ||
+      cellArrayIndex >= openedVtuModel->cellArraysInfo.size()) {
+    return nullptr;
+  }
+  return &openedVtuModel->cellArraysInfo[cellArrayIndex];
+}
+
+bool MainWindow::isCellArrayIndex(int arrayIndex) const {
+  return arrayInfoAt(arrayIndex) != nullptr &&
+         arrayIndex >= openedVtuModel->pointArraysInfo.size();
+}
+
+bool MainWindow::decodeMissingPointArrays(int arrayIndex) {
+  if (openedVtuModel == nullptr) {
+    return false;
+  }
+  // Both are requested together, so the XML reader needs only one pass
+  QVector<int> arrayIndices;
+  if (!isCellArrayIndex(arrayIndex)) {
+    arrayIndices.push_back(arrayIndex);
+  }
+  if (warpScaleSlider->value() > 0 && warpDisplacement == nullptr) {
+    arrayIndices.push_back(displacementArrayIndex);
+  }
+  const QStringList arrayNames =
+      VtuModelLoader::missingPointArrays(*openedVtuModel, arrayIndices);
+  if (arrayNames.isEmpty()) {
+    return false;
+  }
+  // The warp and the coloring both ask for the same arrays
+  if (arrayNames != decodingPointArrays) {
+    decodingPointArrays = arrayNames;
+    setLoadingIndicatorVisible(LoadingOperation::PointArrayDecode, true);
+    modelLoader.decodePointArraysAsync(*openedVtuModel, arrayNames);
+  }
+  return true;
+}
+
+void MainWindow::updateHistogram(int arrayIndex, int componentIndex,
+                                 const double colorRange[2]) {
+  const bool cellArray = isCellArrayIndex(arrayIndex);
+  const QString &arrayName = arrayInfoAt(arrayIndex)->name;
+  vtkDataSetAttributes *arrays =
+      cellArray ? static_cast<vtkDataSetAttributes *>(
+                      openedVtuModel->grid->GetCellData())
+                : openedVtuModel->grid->GetPointData();
+  vtkDataArray *array = arrays->GetArray(arrayName.toStdString().c_str());
+  if (array == nullptr) {
+    histogramWidget->clear();
+    return;
+  }
+
+  // The histogram spans the full range (cached; percentile clipping reads
+  // the same one)
+  ArrayRangeCache &ranges = cellArray ? openedVtuModel->cellArrayRanges
+                                      : openedVtuModel->pointArrayRanges;
+  ArrayHistogramCache &histograms = cellArray
+                                        ? openedVtuModel->cellArrayHistograms
+                                        : openedVtuModel->pointArrayHistograms;
+  double fullRange[2] = {0.0, 1.0};
+  ranges.getRange(array, componentIndex, fullRange);
+  const ArrayHistogram *histogram =
+      histograms.histogram(array, componentIndex, fullRange);
+  if (histogram == nullptr) {
+    histogramWidget->clear();
+    return;
+  }
+  histogramWidget->setHistogram(*histogram, colorRange);
+}
+
+/* Deformed Shape */
+void MainWindow::syncWarpWithOpenedModel() {
+  displacementArrayIndex = -1;
+  warpReferenceScale = 0.0;
+  warpedSurfacePoints = nullptr;
+  warpDisplacement = nullptr;
+  warpScaleSlider->blockSignals(true);
+  warpScaleSlider->setValue(0);
+  warpScaleSlider->blockSignals(false);
+  warpScaleLabel->setText("Off");
+  if (openedVtuModel == nullptr) {
+    warpGroupBox->setTitle("Deformed Shape");
+    warpGroupBox->setEnabled(false);
+    return;
+  }
+
+  displacementArrayIndex =
+      DisplacementWarp::findDisplacementArray(openedVtuModel->pointArraysInfo);
+  if (displacementArrayIndex < 0) {
+    warpGroupBox->setTitle("Deformed Shape (no displacement)");
+    warpGroupBox->setEnabled(false);
+    return;
+  }
+  warpGroupBox->setTitle(
+      QString("Deformed Shape (%1)")
+          .arg(openedVtuModel->pointArraysInfo[displacementArrayIndex].name));
+  warpGroupBox->setEnabled(true);
+}
+
+void MainWindow::updateWarp() {
+  PerfTrace::Scope scope("ui", "Update deformed shape");
+  if (openedVtuModel == nullptr || coloredSurface == nullptr ||
+      openedVtuModel->surface == nullptr) {
+    return;
+  }
+
+  // Undeformed: render the extracted surface points again
+  const int position = warpScaleSlider->value();
+  if (position == 0 || displacementArrayIndex < 0) {
+    warpScaleLabel->setText("Off");
+    warpDisplacement = nullptr;
+    if (coloredSurface->GetPoints() != openedVtuModel->surface->GetPoints()) {
+      coloredSurface->SetPoints(openedVtuModel->surface->GetPoints());
+      updateProxyPoints();
+    }
+    return;
+  }
+
+  auto fail = [this](const QString &errorMessage) {
+    warpScaleSlider->blockSignals(true);
+    warpScaleSlider->setValue(0);
+    warpScaleSlider->blockSignals(false);
+    updateWarp();
+    QMessageBox::warning(this, "Deformation Failed", errorMessage);
+  };
+
+  // Lazily loaded models decode the displacement on the loader's thread
+  // first; the shape is deformed once it arrives. Taking the resident array
+  // leaves the LRU order to the coloring.
+  const QString &arrayName =
+      openedVtuModel->pointArraysInfo[displacementArrayIndex].name;
+  if (warpDisplacement == nullptr) {
+    if (decodeMissingPointArrays(arrayCombo->currentIndex())) {
+      return;
+    }
+    warpDisplacement = openedVtuModel->grid->GetPointData()->GetArray(
+        arrayName.toStdString().c_str());
+    if (warpDisplacement == nullptr) {
+      fail(QString("Array '%1' is unavailable in point data.").arg(arrayName));
+      return;
+    }
+  }
+  vtkDataArray *displacement = warpDisplacement;
+
+  if (warpReferenceScale == 0.0) {
+    double magnitudeRange[2] = {0.0, 0.0};
+    openedVtuModel->pointArrayRanges.getRange(displacement, -1,
+                                              magnitudeRange);
+    if (magnitudeRange[1] > 0.0) {
+      warpReferenceScale = DisplacementWarp::referenceScale(
+          openedVtuModel->surface->GetBounds(), magnitudeRange[1]);
+    }
+  }
+  const double referenceScale =
+      (warpReferenceScale > 0.0) ? warpReferenceScale : 1.0;
+  const double scale = referenceScale * position / 50.0;
+
+  // Only the coordinates change; topology and colors are left untouched, so
+  // the mapper re-uploads just the positions
+  if (warpedSurfacePoints == nullptr) {
+    warpedSurfacePoints = vtkSmartPointer<vtkPoints>::New();
+  }
+  if (!DisplacementWarp::warpPoints(openedVtuModel->grid->GetPoints(),
+                                    displacement, scale,
+                                    openedVtuModel->surfacePointIds,
+                                    warpedSurfacePoints)) {
+    fail(QString("Array '%1' does not have three components.")
+             .arg(arrayName));
+    return;
+  }
+  coloredSurface->SetPoints(warpedSurfacePoints);
+  updateProxyPoints();
+  renderer->ResetCameraClippingRange();
+  warpScaleLabel->setText(QString("×%1").arg(scale, 0, 'g', 3));
+}
+
+void MainWindow::updateProxyPoints() {
+  if (proxySurface == nullptr || coloredSurface == nullptr) {
+    return;
+  }
+  vtkIdTypeArray *pointIds =
+      vtkIdTypeArray::SafeDownCast(proxySurface->GetPointData()->GetArray(
+          SurfaceProxyBuilder::surfacePointIdsName));
+  if (pointIds == nullptr) {
+    return;
+  }
+  DisplacementWarp::gatherPoints(coloredSurface->GetPoints(), pointIds,
+                                 proxySurface->GetPoints());
+}
+
+/* Clip and Slice */
+void MainWindow::syncCutWithOpenedModel() {
+  // Every model starts uncut, with the plane through its center
+  cutModeCombo->blockSignals(true);
+  cutModeCombo->setCurrentIndex(0);
+  cutModeCombo->blockSignals(false);
+  cutMode = CutMode::Off;
+  planeCutter.setGrid(openedVtuModel != nullptr ? openedVtuModel->grid
+                                                : nullptr);
+  cutGroupBox->setEnabled(openedVtuModel != nullptr);
+  if (openedVtuModel != nullptr) {
+    double bounds[6];
+    openedVtuModel->grid->GetBounds(bounds);
+    cutPlaneRepresentation->PlaceWidget(bounds);
+    cutPlaneRepresentation->SetOrigin((bounds[0] + bounds[1]) / 2.0,
+                                      (bounds[2] + bounds[3]) / 2.0,
+                                      (bounds[4] + bounds[5]) / 2.0);
+    cutPlaneRepresentation->SetNormal(1.0, 0.0, 0.0);
+    cutPlaneRepresentation->GetPlane(cutPlane);
+  }
+  updateCutView();
+}
+
+void MainWindow::updateCutView() {
+  const bool cutting = openedVtuModel != nullptr && cutMode != CutMode::Off;
+  cutPlaneWidget->SetEnabled(cutting ? 1 : 0);
+
+  // Clipping keeps the side of the surface the plane normal points to. It is
+  // done by the GPU, so the surface needs no recomputation while dragging.
+  modelMapper->RemoveAllClippingPlanes();
+  proxyMapper->RemoveAllClippingPlanes();
+  if (cutting && cutMode == CutMode::Clip) {
+    modelMapper->AddClippingPlane(cutPlane);
+    proxyMapper->AddClippingPlane(cutPlane);
+  }
+  if (modelActor != nullptr) {
+    modelActor->SetVisibility(cutting && cutMode == CutMode::Slice ? 0 : 1);
+  }
+
+  if (!cutting) {
+    planeCutter.cancel();
+    cutActor->SetVisibility(0);
+    cutMapper->RemoveAllInputs();
+    return;
+  }
+  requestPlaneCut();
+}
+
+void MainWindow::requestPlaneCut() {
+  if (openedVtuModel == nullptr || cutMode == CutMode::Off) {
+    return;
+  }
+  bool cellArray = false;
+  vtkDataArray *array = selectedColorArray(cellArray);
+  planeCutter.cutAsync(cutPlane->GetOrigin(), cutPlane->GetNormal(), array,
+                       cellArray);
+}
+
+void MainWindow::updateCutColoring() {
+  bool cellArray = false;
+  vtkDataArray *array = selectedColorArray(cellArray);
+  const PointArrayInfo *arrayInfo = arrayInfoAt(arrayCombo->currentIndex());
+  if (array == nullptr || arrayInfo == nullptr) {
+    cutMapper->ScalarVisibilityOff();
+    return;
+  }
+
+  // The lookup table is already set up (component, clipped range) by the
+  // surface coloring
+  const int componentIndex = VtuModelLoader::comboIndexToVtkIndex(
+      *arrayInfo, componentCombo->currentIndex());
+  if (cellArray) {
+    cutMapper->SetScalarModeToUseCellFieldData();
+  } else {
+    cutMapper->SetScalarModeToUsePointFieldData();
+  }
+  cutMapper->SelectColorArray(array->GetName());
+  cutMapper->SetArrayComponent(componentIndex);
+  cutMapper->ScalarVisibilityOn();
+}
+
+vtkDataArray *MainWindow::selectedColorArray(bool &cellArray) {
+  cellArray = false;
+  const int arrayIndex = arrayCombo->currentIndex();
+  const PointArrayInfo *arrayInfo = arrayInfoAt(arrayIndex);
+  if (arrayInfo == nullptr) {
+    return nullptr;
+  }
+  const std::string arrayName = arrayInfo->name.toStdString();
+  if (!isCellArrayIndex(arrayIndex)) {
+    return openedVtuModel->grid->GetPointData()->GetArray(arrayName.c_str());
+  }
+  vtkDataArray *array =
+      openedVtuModel->grid->GetCellData()->GetArray(arrayName.c_str());
+  if (cellDataMode == SurfaceColoring::CellDataMode::Interpolated) {
+    // Already interpolated (and cached) by the surface coloring
+    return openedVtuModel->cellToPointArrays.interpolate(openedVtuModel->grid,
+                                                         array);
+  }
+  cellArray = true;
+  return array;
+}
+
+/* Isosurfaces */
+void MainWindow::syncIsosurfacesWithOpenedModel() {
+  // Every model starts without isosurfaces
+  isoGroupBox->blockSignals(true);
+  isoGroupBox->setChecked(false);
+  isoGroupBox->blockSignals(false);
+  keptIsoValues.clear();
+  isosurfaceExtractor.setGrid(openedVtuModel != nullptr ? openedVtuModel->grid
+                                                        : nullptr);
+  isoGroupBox->setEnabled(openedVtuModel != nullptr);
+  updateIsosurfaceView();
+}
+
+void MainWindow::updateIsosurfaceView() {
+  const bool enabled = openedVtuModel != nullptr && isoGroupBox->isChecked();
+  // The surface turns translucent to show the isosurfaces inside
+  if (modelActor != nullptr) {
+    modelActor->GetProperty()->SetOpacity(enabled ? 0.25 : 1.0);
+  }
+  if (!enabled) {
+    isosurfaceExtractor.cancel();
+    isoActor->SetVisibility(0);
+    isoMapper->RemoveAllInputs();
+    return;
+  }
+  requestIsosurfaces();
+}
+
+void MainWindow::requestIsosurfaces() {
+  const double value = sliderIsoValue();
+  QString valueText = QString::number(value, 'g', 4);
+  if (!keptIsoValues.isEmpty()) {
+    valueText += QString(" +%1").arg(keptIsoValues.size());
+  }
+  isoValueLabel->setText(valueText);
+  if (openedVtuModel == nullptr || !isoGroupBox->isChecked()) {
+    return;
+  }
+
+  // Contours need point scalars; cell arrays use their interpolation
+  const int arrayIndex = arrayCombo->currentIndex();
+  const PointArrayInfo *arrayInfo = arrayInfoAt(arrayIndex);
+  if (arrayInfo == nullptr) {
+    return;
+  }
+  const std::string arrayName = arrayInfo->name.toStdString();
+  vtkDataArray *pointArray = nullptr;
+  if (isCellArrayIndex(arrayIndex)) {
+    pointArray = openedVtuModel->cellToPointArrays.interpolate(
+        openedVtuModel->grid,
+        openedVtuModel->grid->GetCellData()->GetArray(arrayName.c_str()));
+  } else {
+    pointArray =
+        openedVtuModel->grid->GetPointData()->GetArray(arrayName.c_str());
+  }
+  const int componentIndex = VtuModelLoader::comboIndexToVtkIndex(
+      *arrayInfo, componentCombo->currentIndex());
+
+  QVector<double> values = keptIsoValues;
+  values.push_back(value);
+  isosurfaceExtractor.extractAsync(pointArray, componentIndex, values);
+}
+
+double MainWindow::sliderIsoValue() const {
+  const double fraction = static_cast<double>(isoValueSlider->value()) /
+                          isoValueSlider->maximum();
+  return isoValueRange[0] + fraction * (isoValueRange[1] - isoValueRange[0]);
+}
+
+/* Memory */
+void MainWindow::updateMemoryPanel() {
+  if (openedVtuModel == nullptr) {
+    memoryUsageLabel->setText("No model loaded.");
+    return;
+  }
+
+  ModelMemoryUsage usage = ModelMemoryUsage::measure(*openedVtuModel);
+  usage.colorBuffers = colorBufferCache.totalBytes();
+  usage.gpuBuffers = ModelMemoryUsage::estimateGpuBytes(coloredSurface) +
+                     ModelMemoryUsage::estimateGpuBytes(proxySurface);
+
+  QString rows;
+  auto addRow = [&rows](const QString &name, qint64 bytes) {
+    rows +=
+        QString("<tr><td>%1</td><td align=\"right\">%2</td></tr>")
+            .arg(name.toHtmlEscaped(), ModelMemoryUsage::formatBytes(bytes));
+  };
+  for (const QPair<QString, qint64> &pointArray : usage.pointArrays) {
+    addRow(pointArray.first, pointArray.second);
+  }
+  addRow("Points", usage.points);
+  addRow("Topology", usage.topology);
+  if (usage.cellData > 0) {
+    addRow("Cell data", usage.cellData);
+  }
+  addRow("Surface", usage.surface);
+  addRow("Color buffers", usage.colorBuffers);
+  addRow("GPU buffers (est.)", usage.gpuBuffers);
+  rows += QString("<tr><td><b>Total</b></td>"
+                  "<td align=\"right\"><b>%1</b></td></tr>")
+              .arg(ModelMemoryUsage::formatBytes(usage.totalBytes()));
+
+  const QString note =
+      openedVtuModel->mappedFromCache
+          ? "<br>Mapped from the model cache; pages load on demand."
+          : QString();
+  memoryUsageLabel->setText("<table width=\"100%\">" + rows + "</table>" +
+                            note);
+}
+
+/* Time Series */
+void MainWindow::syncTimeSeriesWithOpenedModel() {
+  setPlaying(false);
+  currentTimeStep = 0;
+  requestedTimeStep = -1;
+  if (openedVtuModel == nullptr || openedTimeSeries.isEmpty()) {
+    timeStepPrefetcher.clear();
+    timeSeriesGroupBox->setVisible(false);
+    return;
+  }
+  // The loaded file is the step the user chose
+  currentTimeStep = std::max(
+      openedTimeSeries.indexOf(openedVtuModelFileInfo->filePath()), 0);
+
+  // Steps share the loaded mesh; only the selected point array is prefetched
+  timeStepPrefetcher.setTimeSeries(openedTimeSeries, openedVtuModel->header);
+  const int arrayIndex = arrayCombo->currentIndex();
+  if (arrayIndex >= 0 && arrayIndex < openedVtuModel->pointArraysInfo.size()) {
+    timeStepPrefetcher.setArrayName(
+        openedVtuModel->pointArraysInfo[arrayIndex].name);
+  }
+  timeStepPrefetcher.setPlayhead(currentTimeStep);
+
+  timeStepSlider->blockSignals(true);
+  timeStepSlider->setRange(0, openedTimeSeries.size() - 1);
+  timeStepSlider->setValue(currentTimeStep);
+  timeStepSlider->blockSignals(false);
+  timeStepLabel->setText(QString("Step %1/%2  t = %3")
+                             .arg(currentTimeStep + 1)
+                             .arg(openedTimeSeries.size())
+                             .arg(openedTimeSeries.times[currentTimeStep]));
+  timeSeriesGroupBox->setVisible(true);
+}
+
+bool MainWindow::showTimeStep(int step) {
+  if (openedVtuModel == nullptr || openedTimeSeries.isEmpty()) {
+    return false;
+  }
+  const PrefetchedTimeStep *timeStep = timeStepPrefetcher.find(step);
+  if (timeStep == nullptr) {
+    return false;
+  }
+
+  // Swap the point data of the shared mesh; colors of the previous step are
+  // stale
+  VtuModelLoader::switchPointDataFile(*openedVtuModel, timeStep->filePath,
+                                      timeStep->header, timeStep->array);
+  modelLoader.cancelPointArrayDecode(); // Arrays of the previous step
+  decodingPointArrays.clear();
+  colorBufferCache.clear();
+  currentTimeStep = step;
+  requestedTimeStep = -1;
+  timeStepPrefetcher.setPlayhead(step);
+
+  timeStepSlider->blockSignals(true);
+  timeStepSlider->setValue(step);
+  timeStepSlider->blockSignals(false);
+  timeStepLabel->setText(QString("Step %1/%2  t = %3")
+                             .arg(step + 1)
+                             .arg(openedTimeSeries.size())
+                             .arg(openedTimeSeries.times[step]));
+
+  // The deformed shape follows the displacement of the step
+  if (warpScaleSlider->value() > 0) {
+    warpDisplacement = nullptr;
+    updateWarp();
+  }
+
+  const int arrayIndex = arrayCombo->currentIndex();
+  if (arrayIndex < 0 || arrayIndex >= openedVtuModel->pointArraysInfo.size()) {
+    return true;
+  }
+  const int componentIndex = VtuModelLoader::comboIndexToVtkIndex(
+      openedVtuModel->pointArraysInfo[arrayIndex],
+      componentCombo->currentIndex());
+  upadateSceneColoring(arrayIndex, componentIndex);
+  rerenderVtkVisualizer();
+  return true;
+}
+
+void MainWindow::setPlaying(bool playing) {
+  if (playing) {
+    playbackTimer->start();
+    playButton->setText("⏸ Pause");
+  } else {
+    playbackTimer->stop();
+    playButton->setText("▶ Play");
+  }
+}
+
 /* File Selection */
 void MainWindow::syncFileSelectionWithOpenedFile() {
   if (openedVtuModelFileInfo == nullptr) {
@@ -517,6 +2506,10 @@ void MainWindow::syncFileSelectionWithOpenedFile() {
                              "   font-family: monospace;"
                              "}");
     closeFileButton->setEnabled(false);
+    compareFileButton->setEnabled(false);
+    // Kept checked, so the next opened file is watched as well
+    watchFileButton->setEnabled(false);
+    modelFileWatcher.stop();
 
     // No file opened → keep the open button visually highlighted
     openFileButton->setStyleSheet("QPushButton {"
@@ -548,6 +2541,11 @@ void MainWindow::syncFileSelectionWithOpenedFile() {
                              "   font-family: monospace;"
                              "}");
     closeFileButton->setEnabled(true);
+    // Time steps replace every point array, so series are not compared
+    compareFileButton->setEnabled(openedTimeSeries.isEmpty());
+    // Time series are not watched; their steps are separate files
+    watchFileButton->setEnabled(openedTimeSeries.isEmpty());
+    onWatchFileToggled(watchFileButton->isChecked());
 
     // File opened → remove idle highlight; keep it only on hover
     openFileButton->setStyleSheet("QPushButton {"
@@ -570,6 +2568,19 @@ void MainWindow::syncFileSelectionWithOpenedFile() {
   }
 }
 
+void MainWindow::setLoadingIndicatorVisible(LoadingOperation operation,
+                                            bool visible) {
+  const unsigned operationBit = 1u << static_cast<int>(operation);
+  if (visible) {
+    runningLoadingOperations |= operationBit;
+  } else {
+    runningLoadingOperations &= ~operationBit;
+  }
+  loadingProgressBar->setValue(0);
+  loadingProgressBar->setFormat("%p%");
+  loadingWidget->setVisible(runningLoadingOperations != 0);
+}
+
 /* VTK */
 void MainWindow::setScalarBarVisibility(bool visible) {
   if (scalarBar == nullptr) {
@@ -591,17 +2602,24 @@ void MainWindow::syncModelActorWithOpenedModel() {
     }
     return;
   }
-  // If model grid is nullptr or has no points - silently return
-  if (openedVtuModel->grid == nullptr ||
-      openedVtuModel->grid->GetNumberOfPoints() == 0) {
+  // If model surface is nullptr or has no points - silently return
+  if (openedVtuModel->surface == nullptr ||
+      openedVtuModel->surface->GetNumberOfPoints() == 0) {
     return;
   }
   // If model mapper is nullptr - silently return
   if (modelMapper == nullptr) {
     return;
   }
-  // Set model mapper input data and create a new model actor
-  modelMapper->SetInputData(openedVtuModel->grid);
+  // Render the surface extracted at load time; its copy carries only the
+  // mapped colors of the surface points
+  coloredSurface = vtkSmartPointer<vtkPolyData>::New();
+  coloredSurface->CopyStructure(openedVtuModel->surface);
+  modelMapper->SetInputData(coloredSurface);
+  modelMapper->SetScalarModeToDefault(); // Point colors, else flat cell ones
+  modelMapper->SetColorModeToDirectScalars();
+
+  // Create a new model actor
   modelActor = vtkSmartPointer<vtkActor>::New();
   modelActor->SetMapper(modelMapper);
   renderer->AddActor(modelActor);
@@ -609,89 +2627,193 @@ void MainWindow::syncModelActorWithOpenedModel() {
 }
 
 void MainWindow::upadateSceneColoring(int arrayIndex, int componentIndex) {
+  PerfTrace::Scope scope("ui", "Update scene coloring");
   if (openedVtuModel == nullptr) {
     return;
   }
   if (openedVtuModel->grid == nullptr) {
     return;
   }
-  if (modelMapper == nullptr) {
+  if (modelMapper == nullptr || coloredSurface == nullptr) {
     return;
   }
   if (scalarBar == nullptr) {
     return;
   }
 
-  const auto &pointArrays = this->openedVtuModel->pointArraysInfo;
-  if (arrayIndex < 0 ||
-      arrayIndex >= static_cast<int>(openedVtuModel->pointArraysInfo.size())) {
+  const PointArrayInfo *arrayInfo = arrayInfoAt(arrayIndex);
+  if (arrayInfo == nullptr) {
     QMessageBox::warning(this, "Invalid Array Index",
                          QString("Invalid array index: %1").arg(arrayIndex));
     return;
   }
 
-  vtkPointData *pointData = this->openedVtuModel->grid->GetPointData();
-  if (pointData == nullptr) {
-    QMessageBox::warning(this, "No Point Data",
-                         "Model has no point data for coloring.");
-    return;
+  // Map the selected component onto the surface colors
+  const bool cellArray = isCellArrayIndex(arrayIndex);
+  cellDataModeCombo->setEnabled(cellArray);
+  double range[2] = {0.0, 1.0};
+  QString coloringErrorMessage;
+  bool colored = false;
+  if (cellArray) {
+    colored = SurfaceColoring::applyCellData(
+        *openedVtuModel, arrayIndex - openedVtuModel->pointArraysInfo.size(),
+        componentIndex, cellDataMode, colorLookupTable, colorLookupTableId,
+        colorBufferCache, coloredSurface, colorRangePercentiles, range,
+        coloringErrorMessage);
+  } else {
+    // Lazily loaded models decode the array on the loader's thread first;
+    // the coloring is redone once it arrives
+    if (decodeMissingPointArrays(arrayIndex)) {
+      return;
+    }
+    colored = SurfaceColoring::apply(
+        *openedVtuModel, arrayIndex, componentIndex, colorLookupTable,
+        colorLookupTableId, colorBufferCache, coloredSurface,
+        colorRangePercentiles, range, coloringErrorMessage);
   }
-
-  const std::string arrayName =
-      openedVtuModel->pointArraysInfo[arrayIndex].name.toStdString();
-  vtkDataArray *arr = pointData->GetArray(arrayName.c_str());
-  if (arr == nullptr) {
-    QMessageBox::warning(this, "Array Unavailable",
-                         QString("Array '%1' is unavailable in point data.")
-                             .arg(QString::fromStdString(arrayName)));
+  if (!colored) {
+    QMessageBox::warning(this, "Coloring Failed", coloringErrorMessage);
     return;
   }
-
-  // Configure mapper for scalar coloring
-  modelMapper->SetInputData(this->openedVtuModel->grid);
-  modelMapper->SetScalarModeToUsePointFieldData();
-  modelMapper->SetColorModeToMapScalars();
   modelMapper->ScalarVisibilityOn();
-  modelMapper->ColorByArrayComponent(arrayName.c_str(), componentIndex);
-
-  // Set scalar range
-  double range[2] = {0.0, 1.0};
-  arr->GetRange(range, componentIndex);
-  modelMapper->SetScalarRange(range);
 
   // Configure scalar bar - use parsed component names from model
-  const auto &array = pointArrays[arrayIndex];
+  const auto &array = *arrayInfo;
   QString componentText =
       VtuModelLoader::getDisplayNameForVtkIndex(array, componentIndex);
   const QString title = array.name + "\n" + componentText;
-  scalarBar->SetLookupTable(modelMapper->GetLookupTable());
+  scalarBar->SetLookupTable(colorLookupTable);
   scalarBar->SetTitle(title.toLocal8Bit().constData());
   scalarBar->SetVisibility(1);
+
+  updateHistogram(arrayIndex, componentIndex, range);
+  updateProxyColoring();
+  // The cut carries only the array it was colored by
+  requestPlaneCut();
+  // The iso value slider spans the color range
+  isoValueRange[0] = range[0];
+  isoValueRange[1] = range[1];
+  requestIsosurfaces();
+  updateMemoryPanel();
 }
 
 void MainWindow::rerenderVtkVisualizer() {
+  PerfTrace::Scope scope("render", "Rerender visualizer");
   if (vtkVisualizer != nullptr) {
     vtkVisualizer->renderWindow()->Render();
   }
 }
 
+void MainWindow::requestSurfaceProxy(vtkIdType renderedTriangles,
+                                     double frameTime) {
+  if (openedVtuModel == nullptr || openedVtuModel->surface == nullptr) {
+    return;
+  }
+  const double targetFrameTime = 1.0 / interactiveFrameRate;
+  if (frameTime <= targetFrameTime) {
+    return;
+  }
+  // Render time is assumed to scale with the number of triangles drawn
+  const vtkIdType targetTriangles =
+      std::max(static_cast<vtkIdType>(renderedTriangles * targetFrameTime /
+                                      frameTime),
+               minimumProxyTriangles);
+  if (targetTriangles >= openedVtuModel->surface->GetNumberOfCells() ||
+      (proxySurface != nullptr &&
+       targetTriangles >= proxySurface->GetNumberOfCells())) {
+    return;
+  }
+  proxyBuilder.buildAsync(openedVtuModel->surface, targetTriangles);
+}
+
+void MainWindow::updateProxyColoring() {
+  if (proxySurface == nullptr || coloredSurface == nullptr) {
+    return;
+  }
+  vtkSmartPointer<vtkUnsignedCharArray> colors =
+      SurfaceProxyBuilder::proxyColors(
+          proxySurface, vtkUnsignedCharArray::SafeDownCast(
+                            coloredSurface->GetPointData()->GetScalars()));
+  if (colors == nullptr) {
+    proxyMapper->ScalarVisibilityOff();
+    return;
+  }
+  proxySurface->GetPointData()->SetScalars(colors);
+  proxyMapper->ScalarVisibilityOn();
+}
+
 /* Helpers */
+void MainWindow::openFile(const QString &filePath) {
+  // A .pvd collection or numbered .vtu steps of one mesh open as a time
+  // series. The chosen step (the first one of a collection) provides the
+  // shared mesh and is shown first.
+  if (!VtuTimeSeries::isTimeSeriesPath(filePath)) {
+    loadFile(filePath);
+    return;
+  }
+  VtuTimeSeries series;
+  QString errorMessage;
+  if (!VtuTimeSeries::open(filePath, series, errorMessage)) {
+    QMessageBox::warning(this, "Error Opening Time Series", errorMessage);
+    return;
+  }
+  const int step = std::max(series.indexOf(filePath), 0);
+  loadFile(series.isEmpty() ? filePath : series.filePaths[step]);
+  pendingTimeSeries = series;
+}
+
+void MainWindow::loadFile(const QString &filePath) {
+  // Load model on a worker thread (Loader will emit modelLoaded,
+  // modelLoadingErrorOccurred or modelLoadingCancelled)
+  pendingTimeSeries = VtuTimeSeries();
+  setLoadingIndicatorVisible(LoadingOperation::ModelLoad, true);
+  modelLoader.loadAsync(filePath);
+}
+
 void MainWindow::closeFile() {
   // Clear attributes
+  modelLoader.cancelPointArrayDecode();
+  decodingPointArrays.clear();
+  // A running comparison refers to the closed model
+  if (modelComparer.isComparing()) {
+    modelComparer.cancel();
+    setLoadingIndicatorVisible(LoadingOperation::Comparison, false);
+  }
   openedVtuModel.reset(nullptr);
   openedVtuModelFileInfo.reset(nullptr);
+  coloredSurface = nullptr;
+  colorBufferCache.clear();
+
+  // Drop the level of detail proxy
+  proxyBuilder.cancel();
+  proxySurface = nullptr;
+  proxyMapper->RemoveAllInputs();
+  renderingProxy = false;
+  surfaceProxyRequested = false;
+
+  // Stop playback and drop prefetched steps
+  openedTimeSeries = VtuTimeSeries();
+  syncTimeSeriesWithOpenedModel();
 
   // Update Selector
   clearSelectorComboboxes();
   setArrayComboboxEnabled(false);
   setComponentComboboxEnabled(false);
+  cellDataModeCombo->setEnabled(false);
+  histogramWidget->clear();
   arrayComponentGroupBox->setEnabled(false);
 
   // Update File Selection
   syncFileSelectionWithOpenedFile();
+  syncWarpWithOpenedModel();
+  updateMemoryPanel();
 
   // Update VTK
   syncModelActorWithOpenedModel();
+  syncCutWithOpenedModel();
+  surfaceProbe.clear();
+  probeLabel->setVisible(false);
+  syncIsosurfacesWithOpenedModel();
   setScalarBarVisibility(false);
   rerenderVtkVisualizer();
 }
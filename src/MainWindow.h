@@ -2,29 +2,55 @@
 #define MAINWINDOW_H
 
 #include <QComboBox>
+#include <QDoubleSpinBox>
 #include <QFileInfo>
 #include <QGroupBox>
 #include <QLabel>
 #include <QMainWindow>
+#include <QProgressBar>
 #include <QPushButton>
 #include <QScopedPointer>
+#include <QSlider>
+#include <QTimer>
 
 #include <vtkActor.h>
-#include <vtkDataSetMapper.h>
+#include <vtkImplicitPlaneRepresentation.h>
+#include <vtkImplicitPlaneWidget2.h>
+#include <vtkLookupTable.h>
+#include <vtkPlane.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
 #include <vtkRenderer.h>
 #include <vtkScalarBarActor.h>
 #include <vtkSmartPointer.h>
 
+#include "ArrayHistogram.h"
+#include "ColorBufferCache.h"
+#include "IsosurfaceExtractor.h"
+#include "ModelComparer.h"
+#include "ModelFileWatcher.h"
+#include "PlaneCutter.h"
 #include "PointArrayInfo.h"
+#include "SurfaceColoring.h"
+#include "SurfaceProbe.h"
+#include "SurfaceProxyBuilder.h"
+#include "TimeStepPrefetcher.h"
 #include "VtuModelLoader.h"
+#include "VtuTimeSeries.h"
 
+class HistogramWidget;
 class QVTKOpenGLNativeWidget;
+class vtkEventQtSlotConnect;
 
 class MainWindow : public QMainWindow {
   Q_OBJECT
 
 public:
+  // interactiveFrameRate is the rate below which a decimated proxy is drawn
+  // while the camera moves
   explicit MainWindow(const QString &vtuFilePath = QString(),
+                      double interactiveFrameRate = 30.0,
                       QWidget *parent = nullptr);
 
 private slots:
@@ -32,14 +58,76 @@ private slots:
   /* File Selection */
   void onOpenFileClicked();
   void onCloseFileClicked();
+  void onCancelLoadingClicked();
+  void onCompareFileClicked();
+  void onWatchFileToggled(bool watching);
+
+  /* File Watching */
+  void onWatchedFileRewritten(const QString &filePath);
+
+  /* Comparison */
+  void onComparisonFinished(ComparisonResult *result);
+  void onComparisonFailed(const QString &errorMessage);
 
   /* Model Loading */
   void onModelLoaded(LoadedVtuModel *model, const QString &modelFilePath);
   void onModelLoadingErrorOccurred(const QString &errorMessage);
+  void onModelLoadingProgressChanged(double progress, const QString &stage);
+  void onModelLoadingCancelled(const QString &modelFilePath);
+  void onPointArraysDecoded(
+      const QString &modelFilePath,
+      const QVector<vtkSmartPointer<vtkDataArray>> &arrays);
+  void onPointArrayDecodingFailed(const QString &errorMessage);
+  void onPointArrayDecodingCancelled();
 
   /* Array/Component Selector */
   void onArrayIndexChanged(int arrayIndex);
   void onComponentIndexChanged(int componentIndex);
+  void onColorRangeModeChanged(int modeIndex);
+  void onCellDataModeChanged(int modeIndex);
+
+  /* Deformed Shape */
+  void onWarpScaleChanged(int position);
+
+  /* Clip and Slice */
+  void onCutModeChanged(int modeIndex);
+  void onCutPlaneMoved();
+  void onPlaneCutFinished(vtkSmartPointer<vtkPolyData> cut);
+
+  /* Isosurfaces */
+  void onIsosurfacesToggled(bool enabled);
+  void onIsoValueChanged(int position);
+  void onKeepIsoValueClicked();
+  void onClearIsoValuesClicked();
+  void onIsosurfacesExtracted(vtkSmartPointer<vtkPolyData> isosurfaces);
+
+  /* Memory */
+  void onMemoryBudgetChanged(double budgetGiB);
+  void onCacheBudgetChanged(double budgetGiB);
+
+  /* Time Series */
+  void onPlayClicked();
+  void onTimeStepSliderChanged(int step);
+  void onPlaybackTimeout();
+  void onTimeStepReady(int step);
+  void onTimeStepFailed(int step, const QString &errorMessage);
+
+  /* Level of Detail */
+  void onInteractionStarted();
+  void onInteractionEnded();
+  void onRenderFinished();
+  void onSurfaceProxyBuilt(vtkSmartPointer<vtkPolyData> proxy);
+
+  /* Probe */
+  void onProbeMouseMoved();
+  void onProbeMouseLeft();
+
+  /* Performance Overlay */
+  void onFrameStarted();
+  void onFrameFinished();
+  void onTogglePerfOverlay();
+  void onSaveTraceRequested();
+  void updatePerfOverlay();
 
 private:
   /* SETUP */
@@ -56,33 +144,131 @@ private:
   void setArrayComboboxEnabled(bool enabled);
   void setComponentComboboxEnabled(bool enabled);
   void clearSelectorComboboxes();
+  // The array combobox lists the point arrays followed by the cell arrays
+  // (unless a time series is open; its steps only switch point data)
+  QVector<QString> selectableArrayNames() const;
+  const PointArrayInfo *arrayInfoAt(int arrayIndex) const;
+  bool isCellArrayIndex(int arrayIndex) const;
+  // Starts decoding what the view needs and a lazily loaded model does not
+  // hold: the point array at arrayIndex and, while the shape is deformed,
+  // the displacement. Returns false if nothing is missing.
+  bool decodeMissingPointArrays(int arrayIndex);
+  void updateHistogram(int arrayIndex, int componentIndex,
+                       const double colorRange[2]);
+
+  /* Deformed Shape */
+  void syncWarpWithOpenedModel();
+  void updateWarp();
+  void updateProxyPoints();
+
+  /* Clip and Slice */
+  void syncCutWithOpenedModel();
+  void updateCutView();
+  void requestPlaneCut();
+  void updateCutColoring();
+  // The array the surface is currently colored by, as the cut interpolates
+  // it; nullptr if there is none
+  vtkDataArray *selectedColorArray(bool &cellArray);
+
+  /* Isosurfaces */
+  void syncIsosurfacesWithOpenedModel();
+  void updateIsosurfaceView();
+  void requestIsosurfaces();
+  double sliderIsoValue() const;
+
+  /* Memory */
+  void updateMemoryPanel();
+
+  /* Time Series */
+  void syncTimeSeriesWithOpenedModel();
+  bool showTimeStep(int step);
+  void setPlaying(bool playing);
 
   /* File Selection */
   void syncFileSelectionWithOpenedFile();
+  // The indicator stays visible while any of its operations runs
+  enum class LoadingOperation { ModelLoad, PointArrayDecode, Comparison };
+  void setLoadingIndicatorVisible(LoadingOperation operation, bool visible);
 
   /* VTK */
   void setScalarBarVisibility(bool visible);
   void syncModelActorWithOpenedModel();
   void upadateSceneColoring(int arrayIndex, int componentIndex);
   void rerenderVtkVisualizer();
+  void requestSurfaceProxy(vtkIdType renderedTriangles, double frameTime);
+  void updateProxyColoring();
 
   /* Helpers */
+  void openFile(const QString &filePath);
+  void loadFile(const QString &filePath); // Never opens a time series
   void closeFile();
 
 private:
   /* CONFIGURATION */
   QString fileFilter;
   QString fileLabelPlaceholderText;
+  qint64 memoryBudget;
+  qint64 decodedModelCacheBudget;
+  QString colorLookupTableId;
+  double interactiveFrameRate;
+  vtkIdType minimumProxyTriangles;
+  int timeStepPrefetchCapacity;
+  double playbackFrameRate;
+  int perfOverlayOperationCount;
+  int perfOverlayFrameCount;
 
   /* STATE */
   QScopedPointer<LoadedVtuModel> openedVtuModel;
   QScopedPointer<QFileInfo> openedVtuModelFileInfo;
+  PercentileRange colorRangePercentiles; // Kept across fields and files
+  SurfaceColoring::CellDataMode cellDataMode =
+      SurfaceColoring::CellDataMode::Flat;
+  QStringList decodingPointArrays; // Requested from the loader's thread
+  unsigned runningLoadingOperations = 0; // Bit per LoadingOperation
+
+  /* Time Series */
+  VtuTimeSeries pendingTimeSeries; // Series whose first step is loading
+  VtuTimeSeries openedTimeSeries;
+  int currentTimeStep = 0;
+  int requestedTimeStep = -1; // Step to show as soon as it is buffered
+
+  /* Deformed Shape */
+  int displacementArrayIndex = -1;
+  // Scale at which the largest displacement is a tenth of the model size; 0
+  // until the displacement is first used (and while it is all zero)
+  double warpReferenceScale = 0.0;
+
+  /* Clip and Slice */
+  enum class CutMode { Off, Clip, Slice }; // Order of cutModeCombo
+  CutMode cutMode = CutMode::Off;
+
+  /* Isosurfaces */
+  QVector<double> keptIsoValues; // Of the selected field, besides the slider
+  double isoValueRange[2] = {0.0, 1.0}; // Color range of the selected field
+
+  /* Level of Detail */
+  bool interactionActive = false;
+  bool renderingProxy = false;
+  bool surfaceProxyRequested = false;
+  double lastStillFrameTime = 0.0;
+  double interactionFrameTime = 0.0;
+  int interactionFrameCount = 0;
+
+  /* Performance Overlay */
+  qint64 frameStartNs = -1; // Trace clock time of the frame being rendered
 
   /* UI COMPONENTS */
   /* File Picker */
   QLabel *fileLabel;
   QPushButton *openFileButton;
   QPushButton *closeFileButton;
+  QPushButton *compareFileButton;
+  QPushButton *watchFileButton;
+
+  /* Loading Indicator */
+  QWidget *loadingWidget;
+  QProgressBar *loadingProgressBar;
+  QPushButton *cancelLoadingButton;
 
   /* Array/Component Selector */
   QGroupBox *arrayComponentGroupBox;
@@ -90,18 +276,87 @@ private:
   QComboBox *arrayCombo;
   QLabel *componentLabel;
   QComboBox *componentCombo;
+  QLabel *colorRangeLabel;
+  QComboBox *colorRangeCombo;
+  QLabel *cellDataModeLabel;
+  QComboBox *cellDataModeCombo;
+  HistogramWidget *histogramWidget;
+
+  /* Deformed Shape */
+  QGroupBox *warpGroupBox;
+  QLabel *warpScaleLabel;
+  QSlider *warpScaleSlider;
+
+  /* Clip and Slice */
+  QGroupBox *cutGroupBox;
+  QComboBox *cutModeCombo;
+
+  /* Isosurfaces */
+  QGroupBox *isoGroupBox;
+  QSlider *isoValueSlider;
+  QLabel *isoValueLabel;
+  QPushButton *keepIsoValueButton;
+  QPushButton *clearIsoValuesButton;
+
+  /* Memory */
+  QGroupBox *memoryGroupBox;
+  QLabel *memoryUsageLabel;
+  QDoubleSpinBox *memoryBudgetSpinBox;
+  QDoubleSpinBox *cacheBudgetSpinBox;
+
+  /* Time Series */
+  QGroupBox *timeSeriesGroupBox;
+  QPushButton *playButton;
+  QLabel *timeStepLabel;
+  QSlider *timeStepSlider;
+  QTimer *playbackTimer;
 
   /* VTK */
   QVTKOpenGLNativeWidget *vtkVisualizer;
 
+  /* Probe */
+  QLabel *probeLabel;
+
+  /* Performance Overlay */
+  QLabel *perfOverlayLabel;
+  QTimer *perfOverlayTimer;
+
   /* VTK COMPONENTS */
   vtkSmartPointer<vtkRenderer> renderer;
   vtkSmartPointer<vtkActor> modelActor;
-  vtkSmartPointer<vtkDataSetMapper> modelMapper;
+  vtkSmartPointer<vtkPolyDataMapper> modelMapper;
   vtkSmartPointer<vtkScalarBarActor> scalarBar;
+  vtkSmartPointer<vtkLookupTable> colorLookupTable;
+  vtkSmartPointer<vtkPolyData> coloredSurface;
+  // Coordinates of the deformed surface, updated in place
+  vtkSmartPointer<vtkPoints> warpedSurfacePoints;
+  // Held while the shape is deformed, so scale changes neither decode it
+  // again nor reorder the array LRU (which could evict the colored array)
+  vtkSmartPointer<vtkDataArray> warpDisplacement;
+  vtkSmartPointer<vtkPolyDataMapper> proxyMapper;
+  vtkSmartPointer<vtkPolyData> proxySurface;
+  // Clip/slice plane, its handle and the cut of the grid by it
+  vtkSmartPointer<vtkPlane> cutPlane;
+  vtkSmartPointer<vtkImplicitPlaneWidget2> cutPlaneWidget;
+  vtkSmartPointer<vtkImplicitPlaneRepresentation> cutPlaneRepresentation;
+  vtkSmartPointer<vtkPolyDataMapper> cutMapper;
+  vtkSmartPointer<vtkActor> cutActor;
+  vtkSmartPointer<vtkPolyDataMapper> isoMapper;
+  vtkSmartPointer<vtkActor> isoActor;
+  vtkSmartPointer<vtkEventQtSlotConnect> vtkEventConnections;
+
+  /* CACHES */
+  ColorBufferCache colorBufferCache;
 
   /* HELPERS */
   VtuModelLoader modelLoader;
+  ModelComparer modelComparer;
+  ModelFileWatcher modelFileWatcher;
+  SurfaceProxyBuilder proxyBuilder;
+  PlaneCutter planeCutter;
+  SurfaceProbe surfaceProbe;
+  IsosurfaceExtractor isosurfaceExtractor;
+  TimeStepPrefetcher timeStepPrefetcher;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,341 @@
+#include "ModelComparer.h"
+
+#include <QFileInfo>
+
+#include <vtkArrayDispatch.h>
+#include <vtkCellArray.h>
+#include <vtkDataArrayRange.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPointData.h>
+#include <vtkSMPTools.h>
+#include <vtkUnsignedCharArray.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "PerfTrace.h"
+#include "VtuModelLoader.h"
+
+namespace {
+/* TOPOLOGY HASH */
+const vtkIdType hashChunkValues = 1 << 20;
+
+inline quint64 mixHash(quint64 hash, quint64 value) {
+  hash = (hash ^ value) * 0x9e3779b97f4a7c15ULL;
+  return hash ^ (hash >> 29);
+}
+
+// One hash per fixed chunk of values, chunks hashed concurrently
+struct ChunkHashWorker {
+  template <typename ArrayT>
+  void operator()(ArrayT *array, std::vector<quint64> &chunkHashes) const {
+    const auto values = vtk::DataArrayValueRange<1>(array);
+    const vtkIdType numberOfValues = values.size();
+    const vtkIdType numberOfChunks =
+        (numberOfValues + hashChunkValues - 1) / hashChunkValues;
+    chunkHashes.assign(numberOfChunks, 0);
+    vtkSMPTools::For(0, numberOfChunks, 1, [&](vtkIdType begin, vtkIdType end) {
+      for (vtkIdType chunk = begin; chunk < end; ++chunk) {
+        const vtkIdType first = chunk * hashChunkValues;
+        const vtkIdType last =
+            std::min(numberOfValues, first + hashChunkValues);
+        quint64 hash = mixHash(0xcbf29ce484222325ULL, chunk);
+        for (vtkIdType i = first; i < last; ++i) {
+          // Ids hash alike whatever their storage type
+          hash = mixHash(hash, static_cast<quint64>(
+                                   static_cast<vtkIdType>(values[i])));
+        }
+        chunkHashes[chunk] = hash;
+      }
+    });
+  }
+};
+
+quint64 mixArrayHash(quint64 hash, vtkDataArray *array) {
+  if (array == nullptr) {
+    return mixHash(hash, 0);
+  }
+  std::vector<quint64> chunkHashes;
+  ChunkHashWorker worker;
+  if (!vtkArrayDispatch::Dispatch::Execute(array, worker, chunkHashes)) {
+    worker(array, chunkHashes); // Generic fallback
+  }
+  hash = mixHash(hash, static_cast<quint64>(array->GetNumberOfValues()));
+  for (const quint64 chunkHash : chunkHashes) {
+    hash = mixHash(hash, chunkHash);
+  }
+  return hash;
+}
+
+/* DIFFERENCE FIELDS */
+const vtkIdType valuesPerTask = 64 * 1024;
+
+// A single branch-free pass per value over contiguous ranges, which
+// compilers vectorize for the common Float32/Float64 layouts
+template <typename OutT> struct DifferenceWorker {
+  OutT *difference;
+  OutT *absoluteDifference;
+  OutT *relativeError;
+
+  template <typename ReferenceArrayT, typename OtherArrayT>
+  void operator()(ReferenceArrayT *referenceArray,
+                  OtherArrayT *otherArray) const {
+    const auto reference = vtk::DataArrayValueRange(referenceArray);
+    const auto other = vtk::DataArrayValueRange(otherArray);
+    OutT *const differenceValues = difference;
+    OutT *const absoluteValues = absoluteDifference;
+    OutT *const relativeValues = relativeError;
+    vtkSMPTools::For(
+        0, reference.size(), valuesPerTask,
+        [&](vtkIdType begin, vtkIdType end) {
+          for (vtkIdType i = begin; i < end; ++i) {
+            const OutT x = static_cast<OutT>(reference[i]);
+            const OutT y = static_cast<OutT>(other[i]);
+            const OutT delta = y - x;
+            const OutT absoluteDelta = std::abs(delta);
+            const OutT scale = std::max(std::abs(x), std::abs(y));
+            differenceValues[i] = delta;
+            absoluteValues[i] = absoluteDelta;
+            relativeValues[i] =
+                (scale > OutT(0)) ? absoluteDelta / scale : OutT(0);
+          }
+        });
+  }
+};
+
+template <typename OutArrayT>
+QVector<vtkSmartPointer<vtkDataArray>>
+computeDifferenceFields(vtkDataArray *reference, vtkDataArray *other) {
+  using OutT = typename OutArrayT::ValueType;
+  const QString arrayName = QString::fromStdString(reference->GetName());
+  const QString fieldNames[3] = {QString("%1 (difference)").arg(arrayName),
+                                 QString("%1 (abs. difference)").arg(arrayName),
+                                 QString("%1 (relative error)").arg(arrayName)};
+  vtkSmartPointer<OutArrayT> fields[3];
+  for (int f = 0; f < 3; ++f) {
+    fields[f] = vtkSmartPointer<OutArrayT>::New();
+    fields[f]->SetName(fieldNames[f].toStdString().c_str());
+    fields[f]->SetNumberOfComponents(reference->GetNumberOfComponents());
+    for (int c = 0; c < reference->GetNumberOfComponents(); ++c) {
+      if (reference->GetComponentName(c) != nullptr) {
+        fields[f]->SetComponentName(c, reference->GetComponentName(c));
+      }
+    }
+    fields[f]->SetNumberOfTuples(reference->GetNumberOfTuples());
+  }
+
+  DifferenceWorker<OutT> worker{fields[0]->GetPointer(0),
+                                fields[1]->GetPointer(0),
+                                fields[2]->GetPointer(0)};
+  using Dispatcher =
+      vtkArrayDispatch::Dispatch2ByValueType<vtkArrayDispatch::Reals,
+                                             vtkArrayDispatch::Reals>;
+  if (!Dispatcher::Execute(reference, other, worker)) {
+    worker(reference, other); // Generic fallback (e.g. integer arrays)
+  }
+  return {fields[0], fields[1], fields[2]};
+}
+} // namespace
+
+ModelComparer::ModelComparer(QObject *parent) : QObject(parent) {}
+
+ModelComparer::~ModelComparer() = default;
+
+void ModelComparer::compareAsync(const LoadedVtuModel &model,
+                                 const QString &otherFilePath) {
+  const ComparisonReference comparisonReference = reference(model);
+  worker.start([this, comparisonReference,
+                otherFilePath](const LatestRequestWorker::Job &job) {
+    // Forward only whole-percent or stage changes to keep the queue light
+    int lastReportedPercent = -1;
+    QString lastReportedStage;
+    ProgressCallback progressCallback = [this, &job, &lastReportedPercent,
+                                         &lastReportedStage](
+                                            double progress,
+                                            const QString &stage) {
+      const int percent = static_cast<int>(progress * 100.0);
+      if (percent == lastReportedPercent && stage == lastReportedStage) {
+        return;
+      }
+      lastReportedPercent = percent;
+      lastReportedStage = stage;
+      job.post([this, progress, stage]() {
+        emit comparisonProgressChanged(progress, stage);
+      });
+    };
+
+    std::shared_ptr<ComparisonResult> result =
+        std::make_shared<ComparisonResult>();
+    QString errorMessage;
+    const bool ok = compare(comparisonReference, otherFilePath,
+                            progressCallback, job.cancelFlag(), *result,
+                            errorMessage);
+
+    // A dropped result is freed with the last copy of the closure
+    job.post([this, job, ok, result, errorMessage]() {
+      if (job.isCancelled()) {
+        return;
+      }
+      if (!ok) {
+        emit comparisonFailed(errorMessage);
+        return;
+      }
+      emit comparisonFinished(new ComparisonResult(std::move(*result)));
+    });
+  });
+}
+
+void ModelComparer::cancel() { worker.cancel(); }
+
+bool ModelComparer::isComparing() const { return worker.isBusy(); }
+
+ComparisonReference ModelComparer::reference(const LoadedVtuModel &model) {
+  ComparisonReference comparisonReference;
+  comparisonReference.filePath = model.filePath;
+  comparisonReference.header = model.header;
+  if (model.grid == nullptr) {
+    return comparisonReference;
+  }
+  comparisonReference.structure = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  comparisonReference.structure->CopyStructure(model.grid);
+
+  // Fields of an earlier comparison are not compared again
+  vtkPointData *pointData = model.grid->GetPointData();
+  for (const PointArrayInfo &arrayInfo : model.pointArraysInfo) {
+    if (model.derivedPointArrays.contains(arrayInfo.name)) {
+      continue;
+    }
+    comparisonReference.arrayNames.push_back(arrayInfo.name);
+    vtkDataArray *array =
+        pointData->GetArray(arrayInfo.name.toStdString().c_str());
+    // Float32 display copies of Float64 arrays are read again at full
+    // precision, as the other file's arrays are
+    const VtuDataArrayDescriptor *descriptor =
+        model.header.findPointDataArray(arrayInfo.name);
+    const bool convertedToFloat32 =
+        array != nullptr && array->GetDataType() == VTK_FLOAT &&
+        descriptor != nullptr && descriptor->type == "Float64";
+    if (array != nullptr && !convertedToFloat32) {
+      comparisonReference.residentArrays.insert(arrayInfo.name, array);
+    }
+  }
+  return comparisonReference;
+}
+
+bool ModelComparer::compare(const ComparisonReference &reference,
+                            const QString &otherFilePath,
+                            const ProgressCallback &progressCallback,
+                            const std::atomic_bool &cancelRequested,
+                            ComparisonResult &result, QString &errorMessage) {
+  PerfTrace::Scope scope("compare", "Compare models");
+  result = ComparisonResult();
+  result.otherFilePath = otherFilePath;
+  if (reference.structure == nullptr) {
+    errorMessage = "No model to compare with.";
+    return false;
+  }
+
+  // Mismatched sizes are caught from the header alone
+  progressCallback(0.0, "Reading comparison mesh");
+  VtuHeader otherHeader;
+  if (!VtuHeaderScanner::scan(otherFilePath, otherHeader, errorMessage)) {
+    return false;
+  }
+  if (otherHeader.numberOfPoints != reference.structure->GetNumberOfPoints() ||
+      otherHeader.numberOfCells != reference.structure->GetNumberOfCells()) {
+    errorMessage =
+        QString("The meshes differ (%1 points and %2 cells instead of %3 and "
+                "%4):\n%5")
+            .arg(otherHeader.numberOfPoints)
+            .arg(otherHeader.numberOfCells)
+            .arg(reference.structure->GetNumberOfPoints())
+            .arg(reference.structure->GetNumberOfCells())
+            .arg(otherFilePath);
+    return false;
+  }
+
+  vtkSmartPointer<vtkUnstructuredGrid> otherStructure =
+      VtuModelLoader::readGrid(otherFilePath, otherHeader, progressCallback,
+                               cancelRequested, errorMessage, false);
+  if (otherStructure == nullptr || cancelRequested.load()) {
+    return false;
+  }
+  {
+    PerfTrace::Scope hashScope("compare", "Hash topology");
+    progressCallback(0.0, "Matching topology");
+    if (topologyHash(reference.structure) != topologyHash(otherStructure)) {
+      errorMessage = "The mesh topology differs from the opened model:\n" +
+                     otherFilePath;
+      return false;
+    }
+  }
+  otherStructure = nullptr;
+
+  const QString otherName = QFileInfo(otherFilePath).fileName();
+  for (int i = 0; i < reference.arrayNames.size(); ++i) {
+    if (cancelRequested.load()) {
+      return false;
+    }
+    const QString &arrayName = reference.arrayNames[i];
+    const VtuDataArrayDescriptor *otherDescriptor =
+        otherHeader.findPointDataArray(arrayName);
+    if (otherDescriptor == nullptr) {
+      continue;
+    }
+    progressCallback(static_cast<double>(i) / reference.arrayNames.size(),
+                     "Comparing with " + otherName);
+
+    vtkSmartPointer<vtkDataArray> referenceArray =
+        reference.residentArrays.value(arrayName);
+    if (referenceArray == nullptr) {
+      referenceArray = VtuModelLoader::readPointArray(
+          reference.filePath, reference.header, arrayName, errorMessage);
+      if (referenceArray == nullptr) {
+        return false;
+      }
+    }
+    if (otherDescriptor->numberOfComponents !=
+        referenceArray->GetNumberOfComponents()) {
+      result.skippedArrays.push_back(arrayName);
+      continue;
+    }
+    vtkSmartPointer<vtkDataArray> otherArray = VtuModelLoader::readPointArray(
+        otherFilePath, otherHeader, arrayName, errorMessage);
+    if (otherArray == nullptr) {
+      return false;
+    }
+    if (otherArray->GetNumberOfTuples() !=
+        referenceArray->GetNumberOfTuples()) {
+      result.skippedArrays.push_back(arrayName);
+      continue;
+    }
+
+    PerfTrace::Scope fieldsScope("compare", "Compute difference fields");
+    result.arrays += differenceFields(referenceArray, otherArray);
+  }
+  return !cancelRequested.load();
+}
+
+quint64 ModelComparer::topologyHash(vtkUnstructuredGrid *grid) {
+  quint64 hash = mixHash(0xcbf29ce484222325ULL,
+                         static_cast<quint64>(grid->GetNumberOfPoints()));
+  hash = mixHash(hash, static_cast<quint64>(grid->GetNumberOfCells()));
+  vtkCellArray *cells = grid->GetCells();
+  if (cells == nullptr) {
+    return hash;
+  }
+  hash = mixArrayHash(hash, cells->GetOffsetsArray());
+  hash = mixArrayHash(hash, cells->GetConnectivityArray());
+  return mixArrayHash(hash, grid->GetCellTypesArray());
+}
+
+QVector<vtkSmartPointer<vtkDataArray>>
+ModelComparer::differenceFields(vtkDataArray *reference, vtkDataArray *other) {
+  if (reference->GetDataType() == VTK_FLOAT &&
+      other->GetDataType() == VTK_FLOAT) {
+    return computeDifferenceFields<vtkFloatArray>(reference, other);
+  }
+  return computeDifferenceFields<vtkDoubleArray>(reference, other);
+}
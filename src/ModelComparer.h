@@ -0,0 +1,90 @@
+#ifndef MODEL_COMPARER_H
+#define MODEL_COMPARER_H
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <vtkDataArray.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "LatestRequestWorker.h"
+#include "VtuHeaderScanner.h"
+
+struct LoadedVtuModel;
+
+// What a comparison reads from the opened model. Taking one only adds
+// references, so the model may keep changing (e.g. evicting arrays) while
+// the comparison runs.
+struct ComparisonReference {
+  QString filePath;
+  VtuHeader header;
+  vtkSmartPointer<vtkUnstructuredGrid> structure; // Points and cells only
+  QStringList arrayNames; // Decoded point arrays of the catalog, in order
+  // Decoded arrays at the precision of the file; the others are read again
+  QHash<QString, vtkSmartPointer<vtkDataArray>> residentArrays;
+};
+
+struct ComparisonResult {
+  QString otherFilePath;
+  // Difference, absolute difference and relative error of every point array
+  // both files have with the same number of components
+  QVector<vtkSmartPointer<vtkDataArray>> arrays;
+  QStringList skippedArrays; // Same name, different number of components
+};
+
+// Compares the opened model with a second result on the same mesh (another
+// load case or solver version). Topology is matched by hash; the fields are
+// computed on the VTK SMP thread pool on a worker thread.
+class ModelComparer : public QObject {
+  Q_OBJECT
+
+public:
+  using ProgressCallback =
+      std::function<void(double progress, const QString &stage)>;
+
+  explicit ModelComparer(QObject *parent = nullptr);
+  ~ModelComparer() override;
+
+  // Starting a new comparison cancels the one in progress
+  void compareAsync(const LoadedVtuModel &model, const QString &otherFilePath);
+  void cancel();
+  bool isComparing() const;
+
+  static ComparisonReference reference(const LoadedVtuModel &model);
+
+  // Returns false on failure (errorMessage set) or cancellation (empty)
+  static bool compare(const ComparisonReference &reference,
+                      const QString &otherFilePath,
+                      const ProgressCallback &progressCallback,
+                      const std::atomic_bool &cancelRequested,
+                      ComparisonResult &result, QString &errorMessage);
+
+  // Order-sensitive hash of the number of points and the cell offsets,
+  // connectivity and types, computed over fixed chunks in parallel (so it
+  // does not depend on the number of threads or on the id storage type)
+  static quint64 topologyHash(vtkUnstructuredGrid *grid);
+
+  // other - reference, |other - reference| and the relative error
+  // |other - reference| / max(|reference|, |other|) (0 where both are 0),
+  // per component. Float32 only if both inputs are, Float64 otherwise.
+  static QVector<vtkSmartPointer<vtkDataArray>>
+  differenceFields(vtkDataArray *reference, vtkDataArray *other);
+
+signals:
+  void comparisonFinished(ComparisonResult *result); // Ownership transferred
+  void comparisonFailed(const QString &errorMessage);
+  void comparisonProgressChanged(double progress, const QString &stage);
+
+private:
+  LatestRequestWorker worker{LatestRequestWorker::Policy::CancelRunning};
+};
+
+#endif // MODEL_COMPARER_H
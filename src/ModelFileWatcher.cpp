@@ -0,0 +1,80 @@
+#include "ModelFileWatcher.h"
+
+#include <QFileInfo>
+
+namespace {
+// Writers flush large results in several chunks; half a second without a
+// change is taken as done
+const int settleIntervalMs = 500;
+} // namespace
+
+ModelFileWatcher::ModelFileWatcher(QObject *parent) : QObject(parent) {
+  settleTimer.setSingleShot(true);
+  settleTimer.setInterval(settleIntervalMs);
+  connect(&fileSystemWatcher, &QFileSystemWatcher::fileChanged, this,
+          [this]() { onFileChanged(); });
+  connect(&settleTimer, &QTimer::timeout, this,
+          [this]() { onSettleTimeout(); });
+}
+
+void ModelFileWatcher::watch(const QString &filePath) {
+  stop();
+  if (filePath.isEmpty()) {
+    return;
+  }
+  this->filePath = filePath;
+  const QFileInfo fileInfo(filePath);
+  reportedSize = checkedSize = fileInfo.size();
+  reportedModified = checkedModified = fileInfo.lastModified();
+  fileSystemWatcher.addPath(filePath);
+}
+
+void ModelFileWatcher::stop() {
+  settleTimer.stop();
+  if (!fileSystemWatcher.files().isEmpty()) {
+    fileSystemWatcher.removePaths(fileSystemWatcher.files());
+  }
+  filePath.clear();
+}
+
+QString ModelFileWatcher::watchedFilePath() const { return filePath; }
+
+void ModelFileWatcher::onFileChanged() {
+  if (filePath.isEmpty()) {
+    return;
+  }
+  // Every further change restarts the interval
+  settleTimer.start();
+}
+
+void ModelFileWatcher::onSettleTimeout() {
+  if (filePath.isEmpty()) {
+    return;
+  }
+  const QFileInfo fileInfo(filePath);
+  if (!fileInfo.exists()) {
+    // Removed before being replaced; check again until it is back
+    settleTimer.start();
+    return;
+  }
+  // A replaced file is no longer watched by the system watcher
+  if (!fileSystemWatcher.files().contains(filePath)) {
+    fileSystemWatcher.addPath(filePath);
+  }
+
+  const qint64 size = fileInfo.size();
+  const QDateTime modified = fileInfo.lastModified();
+  if (size != checkedSize || modified != checkedModified) {
+    // Still being written
+    checkedSize = size;
+    checkedModified = modified;
+    settleTimer.start();
+    return;
+  }
+  if (size == reportedSize && modified == reportedModified) {
+    return;
+  }
+  reportedSize = size;
+  reportedModified = modified;
+  emit fileRewritten(filePath);
+}
@@ -0,0 +1,45 @@
+#ifndef MODEL_FILE_WATCHER_H
+#define MODEL_FILE_WATCHER_H
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+// Notices when the opened file is rewritten, e.g. by a running solver.
+// Change notifications are held back until the size and modification time of
+// the file have stayed the same for one settle interval, so a file that is
+// still being written is not reported. Writers that replace the file (write
+// a temporary file and rename it) are followed as well.
+class ModelFileWatcher : public QObject {
+  Q_OBJECT
+
+public:
+  explicit ModelFileWatcher(QObject *parent = nullptr);
+
+  // The file as it is now counts as seen; an empty path stops watching
+  void watch(const QString &filePath);
+  void stop();
+  QString watchedFilePath() const;
+
+signals:
+  void fileRewritten(const QString &filePath);
+
+private:
+  void onFileChanged();
+  void onSettleTimeout();
+
+private:
+  QFileSystemWatcher fileSystemWatcher;
+  QTimer settleTimer;
+  QString filePath;
+
+  // File state at the previous check and at the last report
+  qint64 checkedSize = -1;
+  QDateTime checkedModified;
+  qint64 reportedSize = -1;
+  QDateTime reportedModified;
+};
+
+#endif // MODEL_FILE_WATCHER_H
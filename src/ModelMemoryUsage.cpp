@@ -0,0 +1,102 @@
+#include "ModelMemoryUsage.h"
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkUnsignedCharArray.h>
+
+#include "VtuModelLoader.h"
+
+namespace {
+qint64 cellArrayBytes(vtkCellArray *cells) {
+  return (cells != nullptr) ? cells->GetActualMemorySize() * 1024LL : 0;
+}
+
+qint64 attributeBytes(vtkDataSetAttributes *attributes) {
+  qint64 bytes = 0;
+  for (int i = 0; i < attributes->GetNumberOfArrays(); ++i) {
+    bytes += ModelMemoryUsage::arrayBytes(attributes->GetArray(i));
+  }
+  return bytes;
+}
+} // namespace
+
+qint64 ModelMemoryUsage::pointArrayBytes() const {
+  qint64 bytes = 0;
+  for (const QPair<QString, qint64> &pointArray : pointArrays) {
+    bytes += pointArray.second;
+  }
+  return bytes;
+}
+
+qint64 ModelMemoryUsage::modelBytes() const {
+  return pointArrayBytes() + points + topology + cellData + surface;
+}
+
+qint64 ModelMemoryUsage::totalBytes() const {
+  return modelBytes() + colorBuffers + gpuBuffers;
+}
+
+ModelMemoryUsage ModelMemoryUsage::measure(const LoadedVtuModel &model) {
+  ModelMemoryUsage usage;
+  if (model.grid != nullptr) {
+    vtkPointData *pointData = model.grid->GetPointData();
+    for (int i = 0; i < pointData->GetNumberOfArrays(); ++i) {
+      vtkDataArray *array = pointData->GetArray(i);
+      if (array != nullptr && array->GetName() != nullptr) {
+        usage.pointArrays.push_back(
+            {QString::fromStdString(array->GetName()), arrayBytes(array)});
+      }
+    }
+    if (model.grid->GetPoints() != nullptr) {
+      usage.points = arrayBytes(model.grid->GetPoints()->GetData());
+    }
+    usage.topology = cellArrayBytes(model.grid->GetCells()) +
+                     arrayBytes(model.grid->GetCellTypesArray());
+    // Cell arrays and their interpolations to the points
+    usage.cellData = attributeBytes(model.grid->GetCellData()) +
+                     model.cellToPointArrays.totalBytes();
+  }
+  if (model.surface != nullptr) {
+    usage.surface = model.surface->GetActualMemorySize() * 1024LL;
+  }
+  usage.surface += arrayBytes(model.surfacePointIds) +
+                   arrayBytes(model.surfaceCellIds);
+  return usage;
+}
+
+qint64 ModelMemoryUsage::estimateGpuBytes(vtkPolyData *surface) {
+  if (surface == nullptr || surface->GetPoints() == nullptr) {
+    return 0;
+  }
+  // Vertex positions are uploaded as floats
+  qint64 bytes = surface->GetNumberOfPoints() * 3 * sizeof(float);
+  bytes += arrayBytes(surface->GetPointData()->GetScalars()) +
+           arrayBytes(surface->GetCellData()->GetScalars());
+  vtkCellArray *polys = surface->GetPolys();
+  if (polys != nullptr) {
+    const qint64 triangles =
+        polys->GetNumberOfConnectivityIds() - 2 * polys->GetNumberOfCells();
+    bytes += triangles * 3 * sizeof(quint32);
+  }
+  return bytes;
+}
+
+qint64 ModelMemoryUsage::arrayBytes(vtkDataArray *array) {
+  // GetActualMemorySize() reports KiB
+  return (array != nullptr) ? array->GetActualMemorySize() * 1024LL : 0;
+}
+
+QString ModelMemoryUsage::formatBytes(qint64 bytes) {
+  const double kib = 1024.0;
+  if (bytes < kib * kib) {
+    return QString("%1 KiB").arg(bytes / kib, 0, 'f', 0);
+  }
+  if (bytes < kib * kib * kib) {
+    return QString("%1 MiB").arg(bytes / (kib * kib), 0, 'f', 1);
+  }
+  return QString("%1 GiB").arg(bytes / (kib * kib * kib), 0, 'f', 2);
+}
@@ -0,0 +1,38 @@
+#ifndef MODEL_MEMORY_USAGE_H
+#define MODEL_MEMORY_USAGE_H
+
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+class vtkDataArray;
+class vtkPolyData;
+struct LoadedVtuModel;
+
+// Bytes held for an opened model, by category. The model's own data is
+// measured here; color and GPU buffers belong to the viewer, which fills
+// them in.
+struct ModelMemoryUsage {
+  QVector<QPair<QString, qint64>> pointArrays; // Resident point arrays
+  qint64 points = 0;
+  qint64 topology = 0; // Connectivity, offsets and cell types
+  qint64 cellData = 0; // Including cell arrays interpolated to the points
+  qint64 surface = 0; // Extracted surface and its point and cell ids
+  qint64 colorBuffers = 0;
+  qint64 gpuBuffers = 0; // Estimated, see estimateGpuBytes()
+
+  qint64 pointArrayBytes() const;
+  qint64 modelBytes() const; // Everything but color and GPU buffers
+  qint64 totalBytes() const;
+
+  static ModelMemoryUsage measure(const LoadedVtuModel &model);
+
+  // Vertex, color and triangle index buffers uploaded for a rendered surface
+  // (polygons are drawn as triangle fans, with 32-bit indices)
+  static qint64 estimateGpuBytes(vtkPolyData *surface);
+
+  static qint64 arrayBytes(vtkDataArray *array);
+  static QString formatBytes(qint64 bytes);
+};
+
+#endif // MODEL_MEMORY_USAGE_H
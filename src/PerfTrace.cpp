@@ -0,0 +1,126 @@
+#include "PerfTrace.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+std::atomic_bool PerfTrace::enabled(false);
+
+namespace {
+// Enough for a long interactive session of frames plus a few loads
+const int ringCapacity = 1 << 16;
+
+struct TraceRing {
+  std::mutex mutex;
+  std::vector<PerfTraceEvent> events;
+  size_t next = 0; // Slot of the next event
+  size_t size = 0;
+};
+
+TraceRing &traceRing() {
+  static TraceRing ring;
+  return ring;
+}
+
+const QElapsedTimer &traceClock() {
+  static const QElapsedTimer clock = []() {
+    QElapsedTimer timer;
+    timer.start();
+    return timer;
+  }();
+  return clock;
+}
+
+int currentThreadId() {
+  static std::atomic_int nextThreadId(0);
+  thread_local const int threadId = nextThreadId.fetch_add(1);
+  return threadId;
+}
+} // namespace
+
+void PerfTrace::setEnabled(bool enable) {
+  traceClock(); // Start the clock before the first event
+  enabled.store(enable, std::memory_order_relaxed);
+}
+
+qint64 PerfTrace::nowNs() { return traceClock().nsecsElapsed(); }
+
+void PerfTrace::record(const char *category, const char *name,
+                       qint64 startNs, qint64 durationNs) {
+  PerfTraceEvent event{category, name, startNs, durationNs, currentThreadId()};
+  TraceRing &ring = traceRing();
+  std::lock_guard<std::mutex> lock(ring.mutex);
+  if (ring.events.empty()) {
+    ring.events.resize(ringCapacity);
+  }
+  ring.events[ring.next] = event;
+  ring.next = (ring.next + 1) % ring.events.size();
+  ring.size = std::min(ring.size + 1, ring.events.size());
+}
+
+QVector<PerfTraceEvent> PerfTrace::recentEvents(
+    int count, const std::function<bool(const PerfTraceEvent &)> &filter) {
+  TraceRing &ring = traceRing();
+  std::lock_guard<std::mutex> lock(ring.mutex);
+
+  // Walk backwards from the newest event
+  QVector<PerfTraceEvent> events;
+  for (size_t i = 0; i < ring.size && events.size() < count; ++i) {
+    const size_t slot =
+        (ring.next + ring.events.size() - 1 - i) % ring.events.size();
+    const PerfTraceEvent &event = ring.events[slot];
+    if (!filter || filter(event)) {
+      events.push_back(event);
+    }
+  }
+  std::reverse(events.begin(), events.end());
+  return events;
+}
+
+void PerfTrace::clear() {
+  TraceRing &ring = traceRing();
+  std::lock_guard<std::mutex> lock(ring.mutex);
+  ring.next = 0;
+  ring.size = 0;
+}
+
+bool PerfTrace::writeChromeTrace(const QString &filePath,
+                                 QString &errorMessage) {
+  const QVector<PerfTraceEvent> events =
+      recentEvents(std::numeric_limits<int>::max());
+
+  // Complete ("X") events; timestamps are in microseconds
+  QJsonArray traceEvents;
+  const qint64 processId = QCoreApplication::applicationPid();
+  for (const PerfTraceEvent &event : events) {
+    QJsonObject traceEvent;
+    traceEvent["name"] = event.name;
+    traceEvent["cat"] = event.category;
+    traceEvent["ph"] = "X";
+    traceEvent["ts"] = event.startNs / 1000.0;
+    traceEvent["dur"] = event.durationNs / 1000.0;
+    traceEvent["pid"] = processId;
+    traceEvent["tid"] = event.threadId;
+    traceEvents.push_back(traceEvent);
+  }
+
+  QJsonObject trace;
+  trace["traceEvents"] = traceEvents;
+  trace["displayTimeUnit"] = "ms";
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    errorMessage = "Cannot write trace file:\n" + filePath;
+    return false;
+  }
+  file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+  return true;
+}
@@ -0,0 +1,69 @@
+#ifndef PERF_TRACE_H
+#define PERF_TRACE_H
+
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+// One completed timed operation; times are in nanoseconds since the trace
+// clock started
+struct PerfTraceEvent {
+  const char *category = "";
+  const char *name = "";
+  qint64 startNs = 0;
+  qint64 durationNs = 0;
+  int threadId = 0; // Small per-thread number, 0 for the first thread seen
+};
+
+// Process-wide ring of the most recent timed operations, written from any
+// thread. While tracing is off a Scope costs one relaxed atomic load.
+class PerfTrace {
+public:
+  // Times the enclosing block. Category and name must be string literals
+  // (or otherwise outlive the trace); they are stored, not copied.
+  class Scope {
+  public:
+    Scope(const char *category, const char *name)
+        : category(category), name(name),
+          startNs(PerfTrace::isEnabled() ? PerfTrace::nowNs() : -1) {}
+    ~Scope() {
+      if (startNs >= 0) {
+        PerfTrace::record(category, name, startNs,
+                          PerfTrace::nowNs() - startNs);
+      }
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    const char *category;
+    const char *name;
+    qint64 startNs;
+  };
+
+  static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+  static void setEnabled(bool enable);
+
+  static qint64 nowNs();
+  // Adds an operation timed elsewhere (e.g. between two VTK events)
+  static void record(const char *category, const char *name, qint64 startNs,
+                     qint64 durationNs);
+
+  // The newest count events accepted by the filter (all without one),
+  // oldest first
+  static QVector<PerfTraceEvent> recentEvents(
+      int count,
+      const std::function<bool(const PerfTraceEvent &)> &filter = nullptr);
+  static void clear();
+
+  // Writes every buffered event as Chrome trace event JSON, which
+  // chrome://tracing and ui.perfetto.dev open
+  static bool writeChromeTrace(const QString &filePath, QString &errorMessage);
+
+private:
+  static std::atomic_bool enabled;
+};
+
+#endif // PERF_TRACE_H
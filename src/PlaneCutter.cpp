@@ -0,0 +1,149 @@
+#include "PlaneCutter.h"
+
+#include <vtkAppendPolyData.h>
+#include <vtkCellData.h>
+#include <vtkCompositeDataIterator.h>
+#include <vtkCompositeDataSet.h>
+#include <vtkDataSetAttributes.h>
+#include <vtkNew.h>
+#include <vtkPlane.h>
+#include <vtkPlaneCutter.h>
+#include <vtkPointData.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <algorithm>
+#include <array>
+
+#include "PerfTrace.h"
+
+namespace {
+// Makes array the only array of attributes. Setting the array a previous cut
+// used again leaves the input unmodified, which keeps the cutter's sphere
+// tree.
+void setOnlyArray(vtkDataSetAttributes *attributes, vtkDataArray *array) {
+  if (array == nullptr) {
+    if (attributes->GetNumberOfArrays() > 0) {
+      attributes->Initialize();
+    }
+    return;
+  }
+  if (attributes->GetNumberOfArrays() == 1 &&
+      attributes->GetAbstractArray(0) == array) {
+    return;
+  }
+  attributes->Initialize();
+  attributes->AddArray(array);
+}
+} // namespace
+
+// A cutter with its own copy of the grid structure; only the thread running a
+// cut touches it
+struct PlaneCutter::CutContext {
+  vtkSmartPointer<vtkPlaneCutter> cutter;
+  vtkSmartPointer<vtkUnstructuredGrid> input;
+};
+
+PlaneCutter::PlaneCutter(QObject *parent) : QObject(parent) {}
+
+PlaneCutter::~PlaneCutter() = default;
+
+void PlaneCutter::setGrid(vtkUnstructuredGrid *grid) {
+  cancel();
+  context.reset();
+  if (grid == nullptr) {
+    return;
+  }
+
+  context = std::make_shared<CutContext>();
+  context->input = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  context->input->CopyStructure(grid);
+  context->cutter = vtkSmartPointer<vtkPlaneCutter>::New();
+  context->cutter->SetInputData(context->input);
+  context->cutter->BuildTreeOn();
+  context->cutter->BuildHierarchyOn();
+  context->cutter->ComputeNormalsOff();
+  context->cutter->InterpolateAttributesOn();
+}
+
+void PlaneCutter::cutAsync(const double origin[3], const double normal[3],
+                           vtkDataArray *array, bool cellArray) {
+  if (context == nullptr) {
+    return;
+  }
+  std::shared_ptr<CutContext> cutContext = context;
+  vtkSmartPointer<vtkDataArray> cutArray = array;
+  std::array<double, 3> planeOrigin;
+  std::array<double, 3> planeNormal;
+  std::copy_n(origin, 3, planeOrigin.begin());
+  std::copy_n(normal, 3, planeNormal.begin());
+
+  // Only the latest request waits for the running cut; setGrid() cancels
+  // the waiting one before the context changes
+  worker.start([this, cutContext, cutArray, cellArray, planeOrigin,
+                planeNormal](const LatestRequestWorker::Job &job) {
+    vtkUnstructuredGrid *input = cutContext->input;
+    setOnlyArray(input->GetPointData(),
+                 cellArray ? nullptr : cutArray.GetPointer());
+    setOnlyArray(input->GetCellData(),
+                 cellArray ? cutArray.GetPointer() : nullptr);
+    vtkSmartPointer<vtkPolyData> result = cut(
+        cutContext->cutter, input, planeOrigin.data(), planeNormal.data());
+
+    job.post([this, job, result]() {
+      if (job.isCancelled()) {
+        return; // Model closed or cut cancelled meanwhile
+      }
+      emit cutFinished(result);
+    });
+  });
+}
+
+void PlaneCutter::cancel() { worker.cancel(); }
+
+vtkSmartPointer<vtkPolyData> PlaneCutter::cut(vtkPlaneCutter *cutter,
+                                              vtkUnstructuredGrid *input,
+                                              const double origin[3],
+                                              const double normal[3]) {
+  PerfTrace::Scope scope("cut", "Cut grid by plane");
+  if (cutter == nullptr || input == nullptr) {
+    return nullptr;
+  }
+
+  // vtkPlaneCutter runs on the SMP thread pool; the sphere tree it builds on
+  // the first execution is reused while the input is unmodified
+  vtkNew<vtkPlane> plane;
+  plane->SetOrigin(origin[0], origin[1], origin[2]);
+  plane->SetNormal(normal[0], normal[1], normal[2]);
+  cutter->SetInputData(input);
+  cutter->SetPlane(plane);
+  cutter->Update();
+
+  // Depending on the VTK version the cut is one polydata or a piece per
+  // thread
+  vtkDataObject *output = cutter->GetOutputDataObject(0);
+  vtkSmartPointer<vtkPolyData> result = vtkSmartPointer<vtkPolyData>::New();
+  if (vtkPolyData *polyData = vtkPolyData::SafeDownCast(output)) {
+    result->ShallowCopy(polyData);
+  } else if (vtkCompositeDataSet *pieces =
+                 vtkCompositeDataSet::SafeDownCast(output)) {
+    vtkNew<vtkAppendPolyData> append;
+    vtkSmartPointer<vtkCompositeDataIterator> iterator =
+        vtkSmartPointer<vtkCompositeDataIterator>::Take(pieces->NewIterator());
+    for (iterator->InitTraversal(); !iterator->IsDoneWithTraversal();
+         iterator->GoToNextItem()) {
+      vtkPolyData *piece =
+          vtkPolyData::SafeDownCast(iterator->GetCurrentDataObject());
+      if (piece != nullptr && piece->GetNumberOfCells() > 0) {
+        append->AddInputData(piece);
+      }
+    }
+    if (append->GetNumberOfInputConnections(0) > 0) {
+      append->Update();
+      result->ShallowCopy(append->GetOutput());
+    }
+  }
+  if (result->GetNumberOfCells() == 0) {
+    return nullptr;
+  }
+  return result;
+}
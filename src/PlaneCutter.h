@@ -0,0 +1,57 @@
+#ifndef PLANE_CUTTER_H
+#define PLANE_CUTTER_H
+
+#include <QObject>
+
+#include <vtkDataArray.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include <memory>
+
+#include "LatestRequestWorker.h"
+
+class vtkPlaneCutter;
+class vtkUnstructuredGrid;
+
+// Plane cuts of a model grid for the clip and slice views, computed on a
+// worker thread while the plane is dragged. At most one cut runs at a time;
+// requests made meanwhile collapse into the latest one, so the cut follows
+// the plane at whatever rate the cutter sustains. The cutter is kept per
+// grid, so its cell classification (a sphere tree over the cells) is built by
+// the first cut and only looked up by later plane positions.
+class PlaneCutter : public QObject {
+  Q_OBJECT
+
+public:
+  explicit PlaneCutter(QObject *parent = nullptr);
+  ~PlaneCutter() override;
+
+  // Later cuts are taken from the structure of grid (nullptr drops it)
+  void setGrid(vtkUnstructuredGrid *grid);
+
+  // Cuts the grid by the plane on a worker thread, interpolating array (point
+  // data, or cell data if cellArray is set) onto the cut
+  void cutAsync(const double origin[3], const double normal[3],
+                vtkDataArray *array, bool cellArray);
+  void cancel(); // Drops the pending cut and the result of the running one
+
+  // The cut as a single polydata; nullptr if the plane misses the grid.
+  // input carries the structure and the arrays to interpolate.
+  static vtkSmartPointer<vtkPolyData> cut(vtkPlaneCutter *cutter,
+                                          vtkUnstructuredGrid *input,
+                                          const double origin[3],
+                                          const double normal[3]);
+
+signals:
+  void cutFinished(vtkSmartPointer<vtkPolyData> cut);
+
+private:
+  struct CutContext;
+
+private:
+  std::shared_ptr<CutContext> context; // Shared with the running cut
+  LatestRequestWorker worker{LatestRequestWorker::Policy::QueueLatest};
+};
+
+#endif // PLANE_CUTTER_H
@@ -0,0 +1,455 @@
+#include "PvtuReader.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QXmlStreamReader>
+
+#include <vtkArrayDispatch.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkDataArrayRange.h>
+#include <vtkIdTypeArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkUnsignedCharArray.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "VtuModelLoader.h"
+
+namespace {
+// Copies every tuple of source into destination, starting at tuple
+// destinationStart. Ranges of different pieces never overlap, so pieces
+// can be copied concurrently.
+void copyTuples(vtkDataArray *source, vtkDataArray *destination,
+                vtkIdType destinationStart) {
+  const vtkIdType numberOfTuples = source->GetNumberOfTuples();
+  if (source->GetDataType() == destination->GetDataType() &&
+      source->HasStandardMemoryLayout() &&
+      destination->HasStandardMemoryLayout()) {
+    const size_t tupleBytes =
+        static_cast<size_t>(destination->GetNumberOfComponents()) *
+        destination->GetDataTypeSize();
+    std::memcpy(static_cast<char *>(destination->GetVoidPointer(0)) +
+                    destinationStart * tupleBytes,
+                source->GetVoidPointer(0), numberOfTuples * tupleBytes);
+    return;
+  }
+  for (vtkIdType t = 0; t < numberOfTuples; ++t) {
+    destination->SetTuple(destinationStart + t, t, source);
+  }
+}
+
+// Writes the first count values of an id array, shifted by shift
+struct ShiftedIdsWorker {
+  template <typename ArrayT>
+  void operator()(ArrayT *source, vtkIdType count, vtkIdType *destination,
+                  vtkIdType shift) const {
+    for (const auto value : vtk::DataArrayValueRange<1>(source, 0, count)) {
+      *destination++ = static_cast<vtkIdType>(value) + shift;
+    }
+  }
+};
+
+void copyShiftedIds(vtkDataArray *source, vtkIdType count,
+                    vtkIdType *destination, vtkIdType shift) {
+  ShiftedIdsWorker worker;
+  if (!vtkArrayDispatch::Dispatch::Execute(source, worker, count, destination,
+                                           shift)) {
+    worker(source, count, destination, shift); // Generic fallback
+  }
+}
+
+// Arrays of the first piece that every piece has with the same number of
+// components; the merged arrays are allocated at their final size
+std::vector<vtkSmartPointer<vtkDataArray>> allocateMergedArrays(
+    const std::vector<vtkSmartPointer<vtkUnstructuredGrid>> &pieces,
+    vtkDataSetAttributes *(*attributesOf)(vtkUnstructuredGrid *),
+    vtkIdType numberOfTuples) {
+  std::vector<vtkSmartPointer<vtkDataArray>> mergedArrays;
+  vtkDataSetAttributes *firstAttributes = attributesOf(pieces.front());
+  for (int i = 0; i < firstAttributes->GetNumberOfArrays(); ++i) {
+    vtkDataArray *array = firstAttributes->GetArray(i);
+    if (array == nullptr || array->GetName() == nullptr) {
+      continue;
+    }
+    const bool inEveryPiece = std::all_of(
+        pieces.cbegin(), pieces.cend(),
+        [array, attributesOf](const vtkSmartPointer<vtkUnstructuredGrid> &p) {
+          vtkDataArray *pieceArray =
+              attributesOf(p)->GetArray(array->GetName());
+          return pieceArray != nullptr && pieceArray->GetNumberOfComponents() ==
+                                              array->GetNumberOfComponents();
+        });
+    if (!inEveryPiece) {
+      continue;
+    }
+    vtkSmartPointer<vtkDataArray> mergedArray =
+        vtkSmartPointer<vtkDataArray>::Take(array->NewInstance());
+    mergedArray->SetName(array->GetName());
+    mergedArray->SetNumberOfComponents(array->GetNumberOfComponents());
+    for (int c = 0; c < array->GetNumberOfComponents(); ++c) {
+      if (array->GetComponentName(c) != nullptr) {
+        mergedArray->SetComponentName(c, array->GetComponentName(c));
+      }
+    }
+    mergedArray->SetNumberOfTuples(numberOfTuples);
+    mergedArrays.push_back(mergedArray);
+  }
+  return mergedArrays;
+}
+
+vtkDataSetAttributes *pointDataOf(vtkUnstructuredGrid *grid) {
+  return grid->GetPointData();
+}
+
+vtkDataSetAttributes *cellDataOf(vtkUnstructuredGrid *grid) {
+  return grid->GetCellData();
+}
+
+// Concatenates the pieces, releasing each one as soon as it is copied
+vtkSmartPointer<vtkUnstructuredGrid>
+mergePieces(std::vector<vtkSmartPointer<vtkUnstructuredGrid>> &pieces,
+            QString &errorMessage) {
+  const size_t numberOfPieces = pieces.size();
+  std::vector<vtkIdType> pointStarts(numberOfPieces + 1, 0);
+  std::vector<vtkIdType> cellStarts(numberOfPieces + 1, 0);
+  std::vector<vtkIdType> connectivityStarts(numberOfPieces + 1, 0);
+  for (size_t p = 0; p < numberOfPieces; ++p) {
+    vtkUnstructuredGrid *piece = pieces[p];
+    if (piece->GetPoints() == nullptr && piece->GetNumberOfCells() > 0) {
+      errorMessage = "Piece without points";
+      return nullptr;
+    }
+    pointStarts[p + 1] = pointStarts[p] + piece->GetNumberOfPoints();
+    cellStarts[p + 1] = cellStarts[p] + piece->GetNumberOfCells();
+    connectivityStarts[p + 1] =
+        connectivityStarts[p] +
+        ((piece->GetCells() != nullptr)
+             ? piece->GetCells()->GetNumberOfConnectivityIds()
+             : 0);
+  }
+  const vtkIdType numberOfPoints = pointStarts.back();
+  const vtkIdType numberOfCells = cellStarts.back();
+
+  // Points keep the precision of the first piece with points
+  vtkDataArray *firstPoints = nullptr;
+  for (const vtkSmartPointer<vtkUnstructuredGrid> &piece : pieces) {
+    if (piece->GetPoints() != nullptr) {
+      firstPoints = piece->GetPoints()->GetData();
+      break;
+    }
+  }
+  if (firstPoints == nullptr) {
+    errorMessage = "Partitioned grid has no points";
+    return nullptr;
+  }
+  vtkSmartPointer<vtkDataArray> mergedPoints =
+      vtkSmartPointer<vtkDataArray>::Take(firstPoints->NewInstance());
+  mergedPoints->SetNumberOfComponents(3);
+  mergedPoints->SetNumberOfTuples(numberOfPoints);
+
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfTuples(numberOfCells + 1);
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfTuples(connectivityStarts.back());
+  vtkNew<vtkUnsignedCharArray> cellTypes;
+  cellTypes->SetNumberOfTuples(numberOfCells);
+
+  const std::vector<vtkSmartPointer<vtkDataArray>> mergedPointData =
+      allocateMergedArrays(pieces, pointDataOf, numberOfPoints);
+  const std::vector<vtkSmartPointer<vtkDataArray>> mergedCellData =
+      allocateMergedArrays(pieces, cellDataOf, numberOfCells);
+
+  // One task per piece; nested SMP loops inside run serially
+  vtkIdType *offsetValues = offsets->GetPointer(0);
+  vtkIdType *connectivityValues = connectivity->GetPointer(0);
+  unsigned char *typeValues = cellTypes->GetPointer(0);
+  vtkSMPTools::For(0, static_cast<vtkIdType>(numberOfPieces), 1,
+                   [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType p = begin; p < end; ++p) {
+      vtkUnstructuredGrid *piece = pieces[p];
+      if (piece->GetPoints() != nullptr) {
+        copyTuples(piece->GetPoints()->GetData(), mergedPoints, pointStarts[p]);
+      }
+      const vtkIdType pieceCells = piece->GetNumberOfCells();
+      if (pieceCells > 0) {
+        vtkCellArray *cells = piece->GetCells();
+        copyShiftedIds(cells->GetOffsetsArray(), pieceCells,
+                       offsetValues + cellStarts[p], connectivityStarts[p]);
+        copyShiftedIds(cells->GetConnectivityArray(),
+                       cells->GetNumberOfConnectivityIds(),
+                       connectivityValues + connectivityStarts[p],
+                       pointStarts[p]);
+        std::memcpy(typeValues + cellStarts[p],
+                    piece->GetCellTypesArray()->GetPointer(0), pieceCells);
+      }
+      for (vtkDataArray *mergedArray : mergedPointData) {
+        copyTuples(piece->GetPointData()->GetArray(mergedArray->GetName()),
+                   mergedArray, pointStarts[p]);
+      }
+      for (vtkDataArray *mergedArray : mergedCellData) {
+        copyTuples(piece->GetCellData()->GetArray(mergedArray->GetName()),
+                   mergedArray, cellStarts[p]);
+      }
+      pieces[p] = nullptr;
+    }
+  });
+  offsetValues[numberOfCells] = connectivityStarts.back();
+
+  // Polyhedra would also need their face streams merged
+  if (std::find(typeValues, typeValues + numberOfCells,
+                static_cast<unsigned char>(VTK_POLYHEDRON)) !=
+      typeValues + numberOfCells) {
+    errorMessage = "Polyhedral cells in partitioned files are not supported";
+    return nullptr;
+  }
+
+  vtkNew<vtkPoints> points;
+  points->SetData(mergedPoints);
+  vtkNew<vtkCellArray> cells;
+  cells->SetData(offsets, connectivity);
+
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+      vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points);
+  grid->SetCells(cellTypes, cells);
+  for (vtkDataArray *array : mergedPointData) {
+    grid->GetPointData()->AddArray(array);
+  }
+  for (vtkDataArray *array : mergedCellData) {
+    grid->GetCellData()->AddArray(array);
+  }
+  return grid;
+}
+
+// A declared range covers the grid only if every piece declares one
+void mergeDeclaredRanges(
+    QVector<VtuDataArrayDescriptor> &descriptors,
+    const std::vector<VtuHeader> &pieceHeaders,
+    const VtuDataArrayDescriptor *(VtuHeader::*findArray)(const QString &)
+        const) {
+  for (VtuDataArrayDescriptor &descriptor : descriptors) {
+    for (const VtuHeader &pieceHeader : pieceHeaders) {
+      const VtuDataArrayDescriptor *pieceDescriptor =
+          (pieceHeader.*findArray)(descriptor.name);
+      if (pieceDescriptor == nullptr || !pieceDescriptor->hasDeclaredRange) {
+        descriptor.hasDeclaredRange = false;
+        break;
+      }
+      descriptor.rangeMin =
+          std::min(descriptor.rangeMin, pieceDescriptor->rangeMin);
+      descriptor.rangeMax =
+          std::max(descriptor.rangeMax, pieceDescriptor->rangeMax);
+    }
+  }
+}
+} // namespace
+
+bool PvtuReader::isPvtuPath(const QString &filePath) {
+  return QFileInfo(filePath).suffix().compare("pvtu", Qt::CaseInsensitive) ==
+         0;
+}
+
+bool PvtuReader::readPieceFilePaths(const QString &filePath,
+                                    QStringList &pieceFilePaths,
+                                    QString &errorMessage) {
+  pieceFilePaths.clear();
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    errorMessage = "Failed to open PVTU file:\n" + filePath;
+    return false;
+  }
+
+  const QDir directory = QFileInfo(filePath).absoluteDir();
+  QXmlStreamReader xml(&file);
+  bool sawGrid = false;
+  while (!xml.atEnd() && !xml.hasError()) {
+    if (xml.readNext() != QXmlStreamReader::StartElement) {
+      continue;
+    }
+    if (xml.name() == QLatin1String("PUnstructuredGrid")) {
+      sawGrid = true;
+    } else if (xml.name() == QLatin1String("Piece")) {
+      const QString source = xml.attributes().value("Source").toString();
+      if (!source.isEmpty()) {
+        pieceFilePaths.push_back(
+            QDir::cleanPath(directory.absoluteFilePath(source)));
+      }
+    }
+  }
+
+  if (xml.hasError() || !sawGrid) {
+    errorMessage = QString("Failed to parse PVTU file (%1):\n%2")
+                       .arg(xml.hasError()
+                                ? xml.errorString()
+                                : QString("no PUnstructuredGrid element"))
+                       .arg(filePath);
+    return false;
+  }
+  if (pieceFilePaths.isEmpty()) {
+    errorMessage = "PVTU file lists no pieces:\n" + filePath;
+    return false;
+  }
+  return true;
+}
+
+bool PvtuReader::scanHeader(const QString &filePath, VtuHeader &header,
+                            QString &errorMessage) {
+  header = VtuHeader();
+  QStringList pieceFilePaths;
+  if (!readPieceFilePaths(filePath, pieceFilePaths, errorMessage)) {
+    return false;
+  }
+
+  const vtkIdType numberOfPieces = pieceFilePaths.size();
+  std::vector<VtuHeader> pieceHeaders(numberOfPieces);
+  std::vector<QString> pieceErrors(numberOfPieces);
+  vtkSMPTools::For(0, numberOfPieces, 1, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType p = begin; p < end; ++p) {
+      VtuHeaderScanner::scan(pieceFilePaths[p], pieceHeaders[p],
+                             pieceErrors[p]);
+    }
+  });
+  for (const QString &pieceError : pieceErrors) {
+    if (!pieceError.isEmpty()) {
+      errorMessage = pieceError;
+      return false;
+    }
+  }
+
+  // Layout and arrays of the first piece, counts of all pieces
+  header = pieceHeaders.front();
+  header.numberOfPoints = 0;
+  header.numberOfCells = 0;
+  for (const VtuHeader &pieceHeader : pieceHeaders) {
+    header.numberOfPoints += pieceHeader.numberOfPoints;
+    header.numberOfCells += pieceHeader.numberOfCells;
+  }
+  mergeDeclaredRanges(header.pointDataArrays, pieceHeaders,
+                      &VtuHeader::findPointDataArray);
+  mergeDeclaredRanges(header.cellDataArrays, pieceHeaders,
+                      &VtuHeader::findCellDataArray);
+  header.pieceFilePaths = pieceFilePaths;
+  header.pieceHeaders = std::move(pieceHeaders);
+  return true;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid>
+PvtuReader::readGrid(const VtuHeader &header,
+                     const ProgressCallback &progressCallback,
+                     const std::atomic_bool &cancelRequested,
+                     QString &errorMessage, bool includePointData) {
+  const vtkIdType numberOfPieces = header.pieceFilePaths.size();
+  if (numberOfPieces == 0 ||
+      header.pieceHeaders.size() != static_cast<size_t>(numberOfPieces)) {
+    errorMessage = "Partitioned file has no scanned pieces.";
+    return nullptr;
+  }
+
+  // Progress is reported per finished piece; the callback is not reentrant
+  std::mutex progressMutex;
+  vtkIdType finishedPieces = 0;
+  const VtuModelLoader::ProgressCallback noProgress =
+      [](double /*progress*/, const QString & /*stage*/) {};
+  if (progressCallback) {
+    progressCallback(0.0, "Reading pieces");
+  }
+
+  std::vector<vtkSmartPointer<vtkUnstructuredGrid>> pieces(numberOfPieces);
+  std::vector<QString> pieceErrors(numberOfPieces);
+  vtkSMPTools::For(0, numberOfPieces, 1, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType p = begin; p < end && !cancelRequested.load(); ++p) {
+      pieces[p] = VtuModelLoader::readGrid(
+          header.pieceFilePaths[p], header.pieceHeaders[p], noProgress,
+          cancelRequested, pieceErrors[p], includePointData);
+      if (pieces[p] == nullptr && pieceErrors[p].isEmpty() &&
+          !cancelRequested.load()) {
+        pieceErrors[p] = "Failed to read piece:\n" + header.pieceFilePaths[p];
+      }
+      std::lock_guard<std::mutex> lock(progressMutex);
+      ++finishedPieces;
+      if (progressCallback) {
+        progressCallback(static_cast<double>(finishedPieces) / numberOfPieces,
+                         "Reading pieces");
+      }
+    }
+  });
+  if (cancelRequested.load()) {
+    return nullptr;
+  }
+  for (const QString &pieceError : pieceErrors) {
+    if (!pieceError.isEmpty()) {
+      errorMessage = pieceError;
+      return nullptr;
+    }
+  }
+
+  if (progressCallback) {
+    progressCallback(0.0, "Merging pieces");
+  }
+  QString mergeErrorMessage;
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+      mergePieces(pieces, mergeErrorMessage);
+  if (grid == nullptr) {
+    errorMessage = mergeErrorMessage + ":\n" + header.pieceFilePaths.front();
+  }
+  return grid;
+}
+
+vtkSmartPointer<vtkDataArray>
+PvtuReader::readPointArray(const VtuHeader &header, const QString &arrayName,
+                           QString &errorMessage) {
+  const vtkIdType numberOfPieces = header.pieceFilePaths.size();
+  std::vector<vtkSmartPointer<vtkDataArray>> pieceArrays(numberOfPieces);
+  std::vector<QString> pieceErrors(numberOfPieces);
+  vtkSMPTools::For(0, numberOfPieces, 1, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType p = begin; p < end; ++p) {
+      pieceArrays[p] = VtuModelLoader::readPointArray(
+          header.pieceFilePaths[p], header.pieceHeaders[p], arrayName,
+          pieceErrors[p]);
+    }
+  });
+  for (vtkIdType p = 0; p < numberOfPieces; ++p) {
+    if (pieceArrays[p] == nullptr) {
+      errorMessage = pieceErrors[p];
+      return nullptr;
+    }
+    if (pieceArrays[p]->GetNumberOfComponents() !=
+        pieceArrays.front()->GetNumberOfComponents()) {
+      errorMessage = QString("Point array '%1' differs between pieces:\n%2")
+                         .arg(arrayName, header.pieceFilePaths[p]);
+      return nullptr;
+    }
+  }
+
+  std::vector<vtkIdType> tupleStarts(numberOfPieces + 1, 0);
+  for (vtkIdType p = 0; p < numberOfPieces; ++p) {
+    tupleStarts[p + 1] = tupleStarts[p] + pieceArrays[p]->GetNumberOfTuples();
+  }
+  vtkDataArray *firstArray = pieceArrays.front();
+  vtkSmartPointer<vtkDataArray> array =
+      vtkSmartPointer<vtkDataArray>::Take(firstArray->NewInstance());
+  array->SetName(firstArray->GetName());
+  array->SetNumberOfComponents(firstArray->GetNumberOfComponents());
+  for (int c = 0; c < firstArray->GetNumberOfComponents(); ++c) {
+    if (firstArray->GetComponentName(c) != nullptr) {
+      array->SetComponentName(c, firstArray->GetComponentName(c));
+    }
+  }
+  array->SetNumberOfTuples(tupleStarts.back());
+  vtkSMPTools::For(0, numberOfPieces, 1, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType p = begin; p < end; ++p) {
+      copyTuples(pieceArrays[p], array, tupleStarts[p]);
+      pieceArrays[p] = nullptr;
+    }
+  });
+  return array;
+}
@@ -0,0 +1,50 @@
+#ifndef PVTU_READER_H
+#define PVTU_READER_H
+
+#include <QString>
+#include <QStringList>
+
+#include <vtkDataArray.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <atomic>
+#include <functional>
+
+#include "VtuHeaderScanner.h"
+
+// Reads partitioned unstructured grids (.pvtu, e.g. one piece per MPI rank).
+// Pieces are read at the same time on the VTK SMP thread pool and
+// concatenated into a single grid whose arrays are allocated once, at their
+// final size. Points shared by pieces are not merged. Only when the solver
+// wrote ghost layers (vtkGhostType) does surface extraction skip the faces
+// between pieces; otherwise those faces are part of the surface.
+class PvtuReader {
+public:
+  using ProgressCallback =
+      std::function<void(double progress, const QString &stage)>;
+
+  static bool isPvtuPath(const QString &filePath);
+
+  // Piece files in the order of the .pvtu, resolved against its directory
+  static bool readPieceFilePaths(const QString &filePath,
+                                 QStringList &pieceFilePaths,
+                                 QString &errorMessage);
+
+  // Scans the header of every piece and combines them (see VtuHeader)
+  static bool scanHeader(const QString &filePath, VtuHeader &header,
+                         QString &errorMessage);
+
+  // Returns nullptr on failure (errorMessage set) or cancellation (empty)
+  static vtkSmartPointer<vtkUnstructuredGrid>
+  readGrid(const VtuHeader &header, const ProgressCallback &progressCallback,
+           const std::atomic_bool &cancelRequested, QString &errorMessage,
+           bool includePointData);
+
+  // Reads the named point array of every piece and concatenates them
+  static vtkSmartPointer<vtkDataArray>
+  readPointArray(const VtuHeader &header, const QString &arrayName,
+                 QString &errorMessage);
+};
+
+#endif // PVTU_READER_H
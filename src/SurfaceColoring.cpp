@@ -0,0 +1,152 @@
+#include "SurfaceColoring.h"
+
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkLookupTable.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkUnsignedCharArray.h>
+
+#include "ColorBufferCache.h"
+#include "PerfTrace.h"
+#include "VtuModelLoader.h"
+
+namespace {
+// Sets range to the cached range of the array clipped to the percentiles and
+// configures the lookup table shared by the color buffers and scalar bar
+void setupLookupTable(vtkDataArray *array, int componentIndex,
+                      ArrayRangeCache &ranges, ArrayHistogramCache &histograms,
+                      const PercentileRange &percentiles,
+                      vtkLookupTable *lookupTable, double range[2]) {
+  // Scalar range (cached per array/component, computed at load time)
+  range[0] = 0.0;
+  range[1] = 1.0;
+  ranges.getRange(array, componentIndex, range);
+
+  // Percentile clipping locates the values with the histogram over the
+  // full range and selects them exactly (both cached too)
+  histograms.clipRange(array, componentIndex, percentiles, range);
+
+  if (componentIndex < 0) {
+    lookupTable->SetVectorModeToMagnitude();
+  } else {
+    lookupTable->SetVectorModeToComponent();
+    lookupTable->SetVectorComponent(componentIndex);
+  }
+  lookupTable->SetTableRange(range);
+}
+} // namespace
+
+bool SurfaceColoring::apply(LoadedVtuModel &model, int arrayIndex,
+                            int componentIndex, vtkLookupTable *lookupTable,
+                            const QString &lookupTableId,
+                            ColorBufferCache &colorBufferCache,
+                            vtkPolyData *coloredSurface,
+                            const PercentileRange &percentiles,
+                            double range[2], QString &errorMessage) {
+  PerfTrace::Scope scope("color", "Apply surface coloring");
+
+  if (model.grid == nullptr || model.surfacePointIds == nullptr ||
+      lookupTable == nullptr || coloredSurface == nullptr) {
+    errorMessage = "No model surface to color.";
+    return false;
+  }
+
+  // Lazily loaded models decode the array on first use
+  if (!VtuModelLoader::ensurePointArrayLoaded(model, arrayIndex,
+                                              errorMessage)) {
+    return false;
+  }
+
+  const QString &arrayName = model.pointArraysInfo[arrayIndex].name;
+  vtkDataArray *array =
+      model.grid->GetPointData()->GetArray(arrayName.toStdString().c_str());
+  if (array == nullptr) {
+    errorMessage =
+        QString("Array '%1' is unavailable in point data.").arg(arrayName);
+    return false;
+  }
+
+  setupLookupTable(array, componentIndex, model.pointArrayRanges,
+                   model.pointArrayHistograms, percentiles, lookupTable, range);
+
+  // Reuse the mapped colors of previously viewed fields; only surface points
+  // are mapped
+  vtkSmartPointer<vtkUnsignedCharArray> colors =
+      colorBufferCache.colors(array, componentIndex, range, lookupTable,
+                              lookupTableId, model.surfacePointIds);
+  if (colors == nullptr) {
+    errorMessage =
+        QString("Failed to map array '%1' to colors.").arg(arrayName);
+    return false;
+  }
+  coloredSurface->GetPointData()->SetScalars(colors);
+  coloredSurface->GetCellData()->SetScalars(nullptr);
+  return true;
+}
+
+bool SurfaceColoring::applyCellData(LoadedVtuModel &model, int cellArrayIndex,
+                                    int componentIndex, CellDataMode mode,
+                                    vtkLookupTable *lookupTable,
+                                    const QString &lookupTableId,
+                                    ColorBufferCache &colorBufferCache,
+                                    vtkPolyData *coloredSurface,
+                                    const PercentileRange &percentiles,
+                                    double range[2], QString &errorMessage) {
+  PerfTrace::Scope scope("color", "Apply surface cell coloring");
+
+  if (model.grid == nullptr || model.surfacePointIds == nullptr ||
+      model.surfaceCellIds == nullptr || lookupTable == nullptr ||
+      coloredSurface == nullptr) {
+    errorMessage = "No model surface to color.";
+    return false;
+  }
+  if (cellArrayIndex < 0 || cellArrayIndex >= model.cellArraysInfo.size()) {
+    errorMessage = "Invalid cell array index.";
+    return false;
+  }
+
+  const QString &arrayName = model.cellArraysInfo[cellArrayIndex].name;
+  vtkDataArray *array =
+      model.grid->GetCellData()->GetArray(arrayName.toStdString().c_str());
+  if (array == nullptr) {
+    errorMessage =
+        QString("Array '%1' is unavailable in cell data.").arg(arrayName);
+    return false;
+  }
+
+  // The interpolated values stay within the cell range, so both modes share
+  // the range and color scale of the cell array
+  setupLookupTable(array, componentIndex, model.cellArrayRanges,
+                   model.cellArrayHistograms, percentiles, lookupTable, range);
+
+  vtkSmartPointer<vtkUnsignedCharArray> colors;
+  if (mode == CellDataMode::Flat) {
+    colors = colorBufferCache.colors(array, componentIndex, range, lookupTable,
+                                     lookupTableId, model.surfaceCellIds,
+                                     "cells");
+  } else {
+    vtkDataArray *pointArray =
+        model.cellToPointArrays.interpolate(model.grid, array);
+    if (pointArray != nullptr) {
+      colors = colorBufferCache.colors(pointArray, componentIndex, range,
+                                       lookupTable, lookupTableId,
+                                       model.surfacePointIds,
+                                       "cells to points");
+    }
+  }
+  if (colors == nullptr) {
+    errorMessage =
+        QString("Failed to map array '%1' to colors.").arg(arrayName);
+    return false;
+  }
+
+  if (mode == CellDataMode::Flat) {
+    coloredSurface->GetCellData()->SetScalars(colors);
+    coloredSurface->GetPointData()->SetScalars(nullptr);
+  } else {
+    coloredSurface->GetPointData()->SetScalars(colors);
+    coloredSurface->GetCellData()->SetScalars(nullptr);
+  }
+  return true;
+}
@@ -0,0 +1,48 @@
+#ifndef SURFACE_COLORING_H
+#define SURFACE_COLORING_H
+
+#include <QString>
+
+#include "ArrayHistogram.h"
+
+class ColorBufferCache;
+class vtkLookupTable;
+class vtkPolyData;
+struct LoadedVtuModel;
+
+// The coloring pipeline shared by the viewer and the batch renderer: maps one
+// point or cell array component of a model onto the colors of its extracted
+// surface
+class SurfaceColoring {
+public:
+  enum class CellDataMode {
+    Flat,        // One color per surface cell
+    Interpolated // Averaged to the points, then colored like point data
+  };
+
+  // componentIndex -1 selects the magnitude. Decodes the array if needed,
+  // sets the lookup table up for the cached range clipped to the percentiles
+  // (returned in range) and stores the RGBA colors of the surface points as
+  // the point scalars of coloredSurface, which must share the structure of
+  // model.surface. Values beyond a clipped range take the end colors.
+  static bool apply(LoadedVtuModel &model, int arrayIndex, int componentIndex,
+                    vtkLookupTable *lookupTable, const QString &lookupTableId,
+                    ColorBufferCache &colorBufferCache,
+                    vtkPolyData *coloredSurface,
+                    const PercentileRange &percentiles, double range[2],
+                    QString &errorMessage);
+
+  // Same for the cell array model.cellArraysInfo[cellArrayIndex]. Flat colors
+  // become the cell scalars of coloredSurface, interpolated ones its point
+  // scalars. Both modes share the range of the cell array.
+  static bool applyCellData(LoadedVtuModel &model, int cellArrayIndex,
+                            int componentIndex, CellDataMode mode,
+                            vtkLookupTable *lookupTable,
+                            const QString &lookupTableId,
+                            ColorBufferCache &colorBufferCache,
+                            vtkPolyData *coloredSurface,
+                            const PercentileRange &percentiles,
+                            double range[2], QString &errorMessage);
+};
+
+#endif // SURFACE_COLORING_H
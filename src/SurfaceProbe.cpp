@@ -0,0 +1,136 @@
+#include "SurfaceProbe.h"
+
+#include <vtkDataArray.h>
+#include <vtkGenericCell.h>
+#include <vtkIdTypeArray.h>
+#include <vtkStaticCellLocator.h>
+#include <vtkStaticPointLocator.h>
+
+#include <cmath>
+#include <vector>
+
+#include "PerfTrace.h"
+
+struct SurfaceProbe::Locators {
+  vtkSmartPointer<vtkPolyData> surface; // Structure only
+  vtkSmartPointer<vtkStaticCellLocator> cellLocator;
+  vtkSmartPointer<vtkStaticPointLocator> pointLocator;
+  vtkSmartPointer<vtkGenericCell> cell; // Scratch cell of the probes
+};
+
+SurfaceProbe::SurfaceProbe(QObject *parent) : QObject(parent) {}
+
+SurfaceProbe::~SurfaceProbe() = default;
+
+void SurfaceProbe::buildAsync(vtkPolyData *surface) {
+  clear();
+  if (surface == nullptr) {
+    return;
+  }
+  // The worker gets its own dataset object; the points and cells are shared
+  // and only read
+  vtkSmartPointer<vtkPolyData> input = vtkSmartPointer<vtkPolyData>::New();
+  input->CopyStructure(surface);
+
+  worker.start([this, input](const LatestRequestWorker::Job &job) {
+    std::shared_ptr<Locators> built = buildLocators(input);
+
+    job.post([this, job, built]() {
+      if (job.isCancelled()) {
+        return; // Cleared meanwhile
+      }
+      locators = built;
+      emit locatorsBuilt();
+    });
+  });
+}
+
+void SurfaceProbe::clear() {
+  worker.cancel();
+  locators.reset();
+}
+
+bool SurfaceProbe::isReady() const { return locators != nullptr; }
+
+std::shared_ptr<SurfaceProbe::Locators>
+SurfaceProbe::buildLocators(vtkPolyData *surface) {
+  PerfTrace::Scope scope("probe", "Build surface locators");
+  std::shared_ptr<Locators> built = std::make_shared<Locators>();
+  built->surface = surface;
+  // Build the cell links up front; polydata builds them lazily otherwise
+  built->surface->BuildCells();
+
+  // Both locators bin in parallel with vtkSMPTools
+  built->cellLocator = vtkSmartPointer<vtkStaticCellLocator>::New();
+  built->cellLocator->SetDataSet(built->surface);
+  built->cellLocator->BuildLocator();
+  built->pointLocator = vtkSmartPointer<vtkStaticPointLocator>::New();
+  built->pointLocator->SetDataSet(built->surface);
+  built->pointLocator->BuildLocator();
+  built->cell = vtkSmartPointer<vtkGenericCell>::New();
+  return built;
+}
+
+bool SurfaceProbe::probe(const double rayStart[3], const double rayEnd[3],
+                         vtkIdTypeArray *surfacePointIds,
+                         vtkIdTypeArray *surfaceCellIds, vtkDataArray *array,
+                         bool cellArray, int componentIndex,
+                         SurfaceProbeResult &result) const {
+  if (locators == nullptr || surfacePointIds == nullptr ||
+      surfaceCellIds == nullptr || array == nullptr ||
+      componentIndex >= array->GetNumberOfComponents()) {
+    return false;
+  }
+
+  double t = 0.0;
+  double pcoords[3];
+  int subId = 0;
+  vtkIdType surfaceCellId = -1;
+  if (locators->cellLocator->IntersectWithLine(
+          rayStart, rayEnd, 0.0, t, result.position, pcoords, subId,
+          surfaceCellId, locators->cell) == 0 ||
+      surfaceCellId < 0) {
+    return false;
+  }
+
+  const vtkIdType *pointIds = surfacePointIds->GetPointer(0);
+  const vtkIdType nearestPoint =
+      locators->pointLocator->FindClosestPoint(result.position);
+  result.nodeId = (nearestPoint >= 0) ? pointIds[nearestPoint] : -1;
+  result.cellId = surfaceCellIds->GetValue(surfaceCellId);
+
+  const int numberOfComponents = array->GetNumberOfComponents();
+  std::vector<double> tuple(numberOfComponents, 0.0);
+  if (cellArray) {
+    array->GetTuple(result.cellId, tuple.data());
+  } else {
+    // Interpolation weights of the hit position within its surface cell
+    vtkGenericCell *cell = locators->cell;
+    locators->surface->GetCell(surfaceCellId, cell);
+    const vtkIdType numberOfPoints = cell->GetNumberOfPoints();
+    std::vector<double> weights(numberOfPoints);
+    double closestPoint[3];
+    double distance2 = 0.0;
+    cell->EvaluatePosition(result.position, closestPoint, subId, pcoords,
+                           distance2, weights.data());
+
+    std::vector<double> pointTuple(numberOfComponents);
+    for (vtkIdType i = 0; i < numberOfPoints; ++i) {
+      array->GetTuple(pointIds[cell->GetPointId(i)], pointTuple.data());
+      for (int c = 0; c < numberOfComponents; ++c) {
+        tuple[c] += weights[i] * pointTuple[c];
+      }
+    }
+  }
+
+  if (componentIndex >= 0) {
+    result.value = tuple[componentIndex];
+  } else {
+    double sum = 0.0;
+    for (const double value : tuple) {
+      sum += value * value;
+    }
+    result.value = std::sqrt(sum);
+  }
+  return true;
+}
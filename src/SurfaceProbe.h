@@ -0,0 +1,64 @@
+#ifndef SURFACE_PROBE_H
+#define SURFACE_PROBE_H
+
+#include <QObject>
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include <memory>
+
+#include "LatestRequestWorker.h"
+
+class vtkDataArray;
+class vtkIdTypeArray;
+
+// What lies under the cursor on the model surface
+struct SurfaceProbeResult {
+  double position[3] = {0.0, 0.0, 0.0};
+  vtkIdType cellId = -1; // Grid cell the surface cell was extracted from
+  vtkIdType nodeId = -1; // Grid point nearest to position
+  double value = 0.0;    // Of the probed array at position
+};
+
+// Value probing on the extracted surface. A static cell locator (for the ray
+// cast) and a static point locator (for the nearest node) are built once per
+// surface on a worker thread; a probe then costs a tree descent instead of a
+// scan over the surface.
+class SurfaceProbe : public QObject {
+  Q_OBJECT
+
+public:
+  explicit SurfaceProbe(QObject *parent = nullptr);
+  ~SurfaceProbe() override;
+
+  // Starts building the locators of a copy of the surface structure;
+  // probing is available once locatorsBuilt is emitted
+  void buildAsync(vtkPolyData *surface);
+  void clear();
+  bool isReady() const;
+
+  // Casts the ray from rayStart to rayEnd onto the surface and reads the
+  // array at the first hit: point arrays are interpolated within the hit
+  // cell, cell arrays take the value of its grid cell. componentIndex -1
+  // reads the magnitude. surfacePointIds and surfaceCellIds map the surface
+  // to the grid the array belongs to. Returns false if the ray misses.
+  bool probe(const double rayStart[3], const double rayEnd[3],
+             vtkIdTypeArray *surfacePointIds, vtkIdTypeArray *surfaceCellIds,
+             vtkDataArray *array, bool cellArray, int componentIndex,
+             SurfaceProbeResult &result) const;
+
+signals:
+  void locatorsBuilt();
+
+private:
+  struct Locators;
+
+  static std::shared_ptr<Locators> buildLocators(vtkPolyData *surface);
+
+private:
+  std::shared_ptr<Locators> locators; // nullptr until built
+  LatestRequestWorker worker{LatestRequestWorker::Policy::CancelRunning};
+};
+
+#endif // SURFACE_PROBE_H
@@ -0,0 +1,165 @@
+#include "SurfaceProxyBuilder.h"
+
+#include <vtkCallbackCommand.h>
+#include <vtkCommand.h>
+#include <vtkDecimatePro.h>
+#include <vtkIdTypeArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSMPTools.h>
+#include <vtkTriangleFilter.h>
+
+#include <algorithm>
+
+#include "PerfTrace.h"
+
+namespace {
+struct DecimationAbortContext {
+  vtkAlgorithm *algorithm;
+  const std::atomic_bool *cancelRequested;
+};
+
+void onDecimationProgress(vtkObject * /*caller*/, unsigned long /*eventId*/,
+                          void *clientData, void * /*callData*/) {
+  auto *context = static_cast<DecimationAbortContext *>(clientData);
+  if (context->cancelRequested->load()) {
+    context->algorithm->SetAbortExecute(1);
+  }
+}
+} // namespace
+
+const char *const SurfaceProxyBuilder::surfacePointIdsName = "SurfacePointIds";
+
+SurfaceProxyBuilder::SurfaceProxyBuilder(QObject *parent) : QObject(parent) {}
+
+SurfaceProxyBuilder::~SurfaceProxyBuilder() = default;
+
+void SurfaceProxyBuilder::buildAsync(vtkPolyData *surface,
+                                     vtkIdType targetTriangles) {
+  cancel();
+  if (surface == nullptr) {
+    return;
+  }
+
+  // The worker gets its own dataset object; the point and cell arrays are
+  // shared and only read
+  vtkSmartPointer<vtkPolyData> input = vtkSmartPointer<vtkPolyData>::New();
+  input->ShallowCopy(surface);
+
+  worker.start(
+      [this, input, targetTriangles](const LatestRequestWorker::Job &job) {
+        vtkSmartPointer<vtkPolyData> proxy =
+            buildProxy(input, targetTriangles, job.cancelFlag());
+
+        job.post([this, job, proxy]() {
+          if (job.isCancelled() || proxy == nullptr) {
+            return;
+          }
+          emit proxyBuilt(proxy);
+        });
+      });
+}
+
+void SurfaceProxyBuilder::cancel() { worker.cancel(); }
+
+vtkSmartPointer<vtkPolyData>
+SurfaceProxyBuilder::buildProxy(vtkPolyData *surface,
+                                vtkIdType targetTriangles,
+                                const std::atomic_bool &cancelRequested) {
+  PerfTrace::Scope scope("lod", "Build surface proxy");
+  vtkNew<vtkPolyData> input;
+  input->CopyStructure(surface);
+
+  // Tag every surface point with its index; decimation keeps a subset of the
+  // original points together with their point data
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  vtkNew<vtkIdTypeArray> pointIds;
+  pointIds->SetName(surfacePointIdsName);
+  pointIds->SetNumberOfTuples(numberOfPoints);
+  vtkIdType *ids = pointIds->GetPointer(0);
+  vtkSMPTools::For(0, numberOfPoints, [ids](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType i = begin; i < end; ++i) {
+      ids[i] = i;
+    }
+  });
+  input->GetPointData()->AddArray(pointIds);
+
+  vtkNew<vtkTriangleFilter> triangleFilter;
+  triangleFilter->SetInputData(input);
+  triangleFilter->PassVertsOff();
+  triangleFilter->PassLinesOff();
+  triangleFilter->Update();
+  if (cancelRequested.load()) {
+    return nullptr;
+  }
+  vtkPolyData *triangles = triangleFilter->GetOutput();
+  const vtkIdType numberOfTriangles = triangles->GetNumberOfCells();
+
+  vtkSmartPointer<vtkPolyData> proxy = vtkSmartPointer<vtkPolyData>::New();
+  if (numberOfTriangles <= targetTriangles) {
+    proxy->ShallowCopy(triangles);
+    return proxy;
+  }
+
+  // Topology is not preserved so that the target reduction is always reached
+  vtkNew<vtkDecimatePro> decimate;
+  decimate->SetInputConnection(triangleFilter->GetOutputPort());
+  decimate->SetTargetReduction(
+      1.0 - static_cast<double>(std::max<vtkIdType>(targetTriangles, 1)) /
+                numberOfTriangles);
+  decimate->PreserveTopologyOff();
+  decimate->SplittingOn();
+  decimate->BoundaryVertexDeletionOn();
+
+  DecimationAbortContext abortContext{decimate.GetPointer(), &cancelRequested};
+  vtkNew<vtkCallbackCommand> progressCommand;
+  progressCommand->SetCallback(onDecimationProgress);
+  progressCommand->SetClientData(&abortContext);
+  decimate->AddObserver(vtkCommand::ProgressEvent,
+                        progressCommand.GetPointer());
+
+  decimate->Update();
+  decimate->RemoveObserver(progressCommand.GetPointer());
+  if (cancelRequested.load()) {
+    return nullptr;
+  }
+
+  proxy->ShallowCopy(decimate->GetOutput());
+  if (proxy->GetPointData()->GetArray(surfacePointIdsName) == nullptr) {
+    return nullptr;
+  }
+  return proxy;
+}
+
+vtkSmartPointer<vtkUnsignedCharArray>
+SurfaceProxyBuilder::proxyColors(vtkPolyData *proxy,
+                                 vtkUnsignedCharArray *surfaceColors) {
+  if (proxy == nullptr || surfaceColors == nullptr) {
+    return nullptr;
+  }
+  vtkIdTypeArray *pointIds = vtkIdTypeArray::SafeDownCast(
+      proxy->GetPointData()->GetArray(surfacePointIdsName));
+  if (pointIds == nullptr) {
+    return nullptr;
+  }
+
+  const int numberOfComponents = surfaceColors->GetNumberOfComponents();
+  vtkSmartPointer<vtkUnsignedCharArray> colors =
+      vtkSmartPointer<vtkUnsignedCharArray>::New();
+  colors->SetName(surfaceColors->GetName());
+  colors->SetNumberOfComponents(numberOfComponents);
+  colors->SetNumberOfTuples(pointIds->GetNumberOfTuples());
+
+  const vtkIdType *ids = pointIds->GetPointer(0);
+  const unsigned char *source = surfaceColors->GetPointer(0);
+  unsigned char *destination = colors->GetPointer(0);
+  vtkSMPTools::For(0, pointIds->GetNumberOfTuples(),
+                   [&](vtkIdType begin, vtkIdType end) {
+                     for (vtkIdType i = begin; i < end; ++i) {
+                       std::copy_n(source + ids[i] * numberOfComponents,
+                                   numberOfComponents,
+                                   destination + i * numberOfComponents);
+                     }
+                   });
+  return colors;
+}
@@ -0,0 +1,49 @@
+#ifndef SURFACE_PROXY_BUILDER_H
+#define SURFACE_PROXY_BUILDER_H
+
+#include <QObject>
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+
+#include <atomic>
+#include <memory>
+
+#include "LatestRequestWorker.h"
+
+// Builds decimated level-of-detail proxies of an extracted surface on worker
+// threads. Proxy points are a subset of the surface points and carry their
+// surface point index, so proxies are recolored from the surface colors.
+class SurfaceProxyBuilder : public QObject {
+  Q_OBJECT
+
+public:
+  // Point data array of the proxy holding the source surface point index
+  static const char *const surfacePointIdsName;
+
+  explicit SurfaceProxyBuilder(QObject *parent = nullptr);
+  ~SurfaceProxyBuilder() override;
+
+  // Decimates a copy of the surface down to about targetTriangles triangles
+  // on a worker thread. Starting a new build cancels the one in progress.
+  void buildAsync(vtkPolyData *surface, vtkIdType targetTriangles);
+  void cancel();
+
+  // Returns nullptr on cancellation
+  static vtkSmartPointer<vtkPolyData>
+  buildProxy(vtkPolyData *surface, vtkIdType targetTriangles,
+             const std::atomic_bool &cancelRequested);
+
+  // Picks the colors of the proxy points out of the surface colors
+  static vtkSmartPointer<vtkUnsignedCharArray>
+  proxyColors(vtkPolyData *proxy, vtkUnsignedCharArray *surfaceColors);
+
+signals:
+  void proxyBuilt(vtkSmartPointer<vtkPolyData> proxy);
+
+private:
+  LatestRequestWorker worker{LatestRequestWorker::Policy::CancelRunning};
+};
+
+#endif // SURFACE_PROXY_BUILDER_H
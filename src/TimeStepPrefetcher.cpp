@@ -0,0 +1,196 @@
+#include "TimeStepPrefetcher.h"
+
+#include <algorithm>
+
+#include "PerfTrace.h"
+#include "VtuModelLoader.h"
+
+TimeStepPrefetcher::TimeStepPrefetcher(QObject *parent)
+    : QObject(parent), ring(defaultCapacity),
+      cancelFlag(std::make_shared<std::atomic_bool>(false)) {
+  // Every worker inflates its blocks on the SMP pool already; two workers
+  // keep the disk busy while one step is being decompressed
+  threadPool.setMaxThreadCount(2);
+}
+
+TimeStepPrefetcher::~TimeStepPrefetcher() {
+  cancelFlag->store(true);
+  threadPool.clear();
+  threadPool.waitForDone();
+}
+
+void TimeStepPrefetcher::setTimeSeries(const VtuTimeSeries &series,
+                                       const VtuHeader &meshHeader) {
+  this->series = series;
+  meshShape = MeshShape::of(meshHeader);
+  playhead = 0;
+  resetBuffer();
+}
+
+void TimeStepPrefetcher::setArrayName(const QString &arrayName) {
+  if (arrayName == this->arrayName) {
+    return;
+  }
+  this->arrayName = arrayName;
+  resetBuffer();
+}
+
+void TimeStepPrefetcher::setCapacity(int capacity) {
+  capacity = std::max(capacity, 1);
+  if (capacity == ring.size()) {
+    return;
+  }
+  ring = QVector<PrefetchedTimeStep>(capacity);
+  resetBuffer();
+}
+
+int TimeStepPrefetcher::capacity() const { return ring.size(); }
+
+void TimeStepPrefetcher::setPlayhead(int step) {
+  if (series.isEmpty() || arrayName.isEmpty()) {
+    return;
+  }
+  playhead = std::clamp(step, 0, series.size() - 1);
+  const int windowSize = std::min(ring.size(), series.size());
+  for (int i = 0; i < windowSize; ++i) {
+    const int windowStep = (playhead + i) % series.size();
+    if (find(windowStep) == nullptr && !pendingSteps.contains(windowStep)) {
+      requestStep(windowStep);
+    }
+  }
+}
+
+const PrefetchedTimeStep *TimeStepPrefetcher::find(int step) const {
+  if (step < 0 || ring.isEmpty()) {
+    return nullptr;
+  }
+  const PrefetchedTimeStep &slot = ring[step % ring.size()];
+  return (slot.step == step && slot.array != nullptr) ? &slot : nullptr;
+}
+
+void TimeStepPrefetcher::clear() {
+  series = VtuTimeSeries();
+  meshShape = MeshShape();
+  arrayName.clear();
+  playhead = 0;
+  resetBuffer();
+}
+
+bool TimeStepPrefetcher::isInWindow(int step) const {
+  if (series.isEmpty()) {
+    return false;
+  }
+  const int distance = (step - playhead + series.size()) % series.size();
+  return distance < std::min(ring.size(), series.size());
+}
+
+void TimeStepPrefetcher::requestStep(int step) {
+  pendingSteps.insert(step);
+
+  const quint64 requestGeneration = generation;
+  std::shared_ptr<std::atomic_bool> requestCancelFlag = cancelFlag;
+  const QString filePath = series.filePaths[step];
+  const QString requestArrayName = arrayName;
+  const MeshShape requestMeshShape = meshShape;
+  threadPool.start([this, step, requestGeneration, requestCancelFlag, filePath,
+                    requestArrayName, requestMeshShape]() {
+    if (requestCancelFlag->load()) {
+      return;
+    }
+    PrefetchedTimeStep timeStep;
+    QString errorMessage;
+    const bool ok = fetchStep(filePath, requestArrayName, requestMeshShape,
+                              timeStep, errorMessage);
+    timeStep.step = step;
+
+    // Deliver the result on the prefetcher's thread
+    QMetaObject::invokeMethod(
+        this,
+        [this, step, requestGeneration, ok, timeStep, errorMessage]() {
+          if (requestGeneration != generation) {
+            return; // Buffer was reset in the meantime
+          }
+          pendingSteps.remove(step);
+          if (!ok) {
+            emit stepFailed(step, errorMessage);
+            return;
+          }
+          // The playhead may have moved past the step while it was decoded
+          if (!isInWindow(step)) {
+            return;
+          }
+          ring[step % ring.size()] = timeStep;
+          emit stepReady(step);
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+void TimeStepPrefetcher::resetBuffer() {
+  // Queued fetches of the old generation are skipped, running ones dropped
+  cancelFlag->store(true);
+  cancelFlag = std::make_shared<std::atomic_bool>(false);
+  ++generation;
+  pendingSteps.clear();
+  for (PrefetchedTimeStep &slot : ring) {
+    slot = PrefetchedTimeStep();
+  }
+}
+
+TimeStepPrefetcher::MeshShape
+TimeStepPrefetcher::MeshShape::of(const VtuHeader &header) {
+  MeshShape shape;
+  shape.numberOfPoints = header.numberOfPoints;
+  shape.numberOfCells = header.numberOfCells;
+  if (const VtuDataArrayDescriptor *connectivity =
+          header.findCellArray("connectivity")) {
+    shape.connectivityExtent = connectivity->extent;
+  }
+  if (const VtuDataArrayDescriptor *offsets = header.findCellArray("offsets")) {
+    shape.offsetsExtent = offsets->extent;
+  }
+  return shape;
+}
+
+QString TimeStepPrefetcher::MeshShape::mismatch(const MeshShape &step) const {
+  if (step.numberOfPoints != numberOfPoints) {
+    return QString("%1 points instead of %2")
+        .arg(step.numberOfPoints)
+        .arg(numberOfPoints);
+  }
+  if (step.numberOfCells != numberOfCells) {
+    return QString("%1 cells instead of %2")
+        .arg(step.numberOfCells)
+        .arg(numberOfCells);
+  }
+  const auto differs = [](qint64 a, qint64 b) {
+    return a >= 0 && b >= 0 && a != b;
+  };
+  if (differs(step.connectivityExtent, connectivityExtent) ||
+      differs(step.offsetsExtent, offsetsExtent)) {
+    return "different connectivity";
+  }
+  return QString();
+}
+
+bool TimeStepPrefetcher::fetchStep(const QString &filePath,
+                                   const QString &arrayName,
+                                   const MeshShape &meshShape,
+                                   PrefetchedTimeStep &timeStep,
+                                   QString &errorMessage) {
+  PerfTrace::Scope scope("load", "Prefetch time step");
+  timeStep.filePath = filePath;
+  if (!VtuHeaderScanner::scan(filePath, timeStep.header, errorMessage)) {
+    return false;
+  }
+  const QString mismatch = meshShape.mismatch(MeshShape::of(timeStep.header));
+  if (!mismatch.isEmpty()) {
+    errorMessage =
+        QString("Time step does not share the loaded mesh (%1):\n%2")
+            .arg(mismatch, filePath);
+    return false;
+  }
+  timeStep.array = VtuModelLoader::readPointArray(filePath, timeStep.header,
+                                                  arrayName, errorMessage);
+  return timeStep.array != nullptr;
+}
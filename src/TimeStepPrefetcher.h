@@ -0,0 +1,95 @@
+#ifndef TIME_STEP_PREFETCHER_H
+#define TIME_STEP_PREFETCHER_H
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include <vtkDataArray.h>
+#include <vtkSmartPointer.h>
+
+#include <atomic>
+#include <memory>
+
+#include "VtuHeaderScanner.h"
+#include "VtuTimeSeries.h"
+
+// One decoded point array of one time step
+struct PrefetchedTimeStep {
+  int step = -1;
+  QString filePath;
+  VtuHeader header;
+  vtkSmartPointer<vtkDataArray> array;
+};
+
+// Decodes the selected point array of the steps ahead of the playhead on a
+// small worker pool into a ring buffer of fixed capacity (16 steps unless
+// set otherwise). Step s lives in slot s % capacity, so the window
+// [playhead, playhead + capacity) never competes for a slot and steps behind
+// the playhead are overwritten first.
+class TimeStepPrefetcher : public QObject {
+  Q_OBJECT
+
+public:
+  static constexpr int defaultCapacity = 16;
+
+  explicit TimeStepPrefetcher(QObject *parent = nullptr);
+  ~TimeStepPrefetcher() override;
+
+  // Steps must share the mesh of the loaded model, whose header is given
+  void setTimeSeries(const VtuTimeSeries &series, const VtuHeader &meshHeader);
+  // Changing the array or the capacity drops every buffered step
+  void setArrayName(const QString &arrayName);
+  void setCapacity(int capacity);
+  int capacity() const;
+
+  // Requests every step of the window starting at the playhead (wrapping
+  // around the end of the series) that is neither buffered nor in flight
+  void setPlayhead(int step);
+
+  // Returns nullptr unless the step is buffered
+  const PrefetchedTimeStep *find(int step) const;
+  void clear();
+
+signals:
+  void stepReady(int step);
+  void stepFailed(int step, const QString &errorMessage);
+
+private:
+  // What a step's header must repeat to share the loaded mesh. Extents of
+  // the connectivity and offsets are only compared where both are known.
+  struct MeshShape {
+    qint64 numberOfPoints = 0;
+    qint64 numberOfCells = 0;
+    qint64 connectivityExtent = -1;
+    qint64 offsetsExtent = -1;
+
+    static MeshShape of(const VtuHeader &header);
+    // Empty if shared, otherwise why not
+    QString mismatch(const MeshShape &step) const;
+  };
+
+  bool isInWindow(int step) const;
+  void requestStep(int step);
+  void resetBuffer();
+
+  static bool fetchStep(const QString &filePath, const QString &arrayName,
+                        const MeshShape &meshShape,
+                        PrefetchedTimeStep &timeStep, QString &errorMessage);
+
+private:
+  VtuTimeSeries series;
+  MeshShape meshShape;
+  QString arrayName;
+  int playhead = 0;
+
+  QVector<PrefetchedTimeStep> ring;
+  QSet<int> pendingSteps;
+  QThreadPool threadPool;
+  quint64 generation = 0; // Results of older generations are dropped
+  std::shared_ptr<std::atomic_bool> cancelFlag;
+};
+
+#endif // TIME_STEP_PREFETCHER_H
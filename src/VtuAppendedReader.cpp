@@ -0,0 +1,667 @@
+#include "VtuAppendedReader.h"
+
+#include <QtGlobal>
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkType.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtk_zlib.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+// Uncompressed payloads are split so that copies also run in parallel
+const size_t rawChunkSize = 4 * 1024 * 1024;
+// Blocks decoded between two progress/cancellation checks
+const size_t blocksPerBatch = 1024;
+
+// VTU type name to VTK data type; -1 for types this reader does not handle
+int vtkTypeFromVtuType(const QString &type) {
+  if (type == "Int8") {
+    return VTK_TYPE_INT8;
+  } else if (type == "UInt8") {
+    return VTK_TYPE_UINT8;
+  } else if (type == "Int16") {
+    return VTK_TYPE_INT16;
+  } else if (type == "UInt16") {
+    return VTK_TYPE_UINT16;
+  } else if (type == "Int32") {
+    return VTK_TYPE_INT32;
+  } else if (type == "UInt32") {
+    return VTK_TYPE_UINT32;
+  } else if (type == "Int64") {
+    return VTK_TYPE_INT64;
+  } else if (type == "UInt64") {
+    return VTK_TYPE_UINT64;
+  } else if (type == "Float32") {
+    return VTK_TYPE_FLOAT32;
+  } else if (type == "Float64") {
+    return VTK_TYPE_FLOAT64;
+  }
+  return -1;
+}
+
+bool isReadableArray(const VtuDataArrayDescriptor &descriptor) {
+  return descriptor.isAppended() && descriptor.offset >= 0 &&
+         vtkTypeFromVtuType(descriptor.type) != -1;
+}
+
+// Number of base64 characters that encode the given number of bytes
+quint64 base64Length(quint64 numberOfBytes) {
+  return (numberOfBytes + 2) / 3 * 4;
+}
+
+int base64Value(uchar character) {
+  if (character >= 'A' && character <= 'Z') {
+    return character - 'A';
+  } else if (character >= 'a' && character <= 'z') {
+    return character - 'a' + 26;
+  } else if (character >= '0' && character <= '9') {
+    return character - '0' + 52;
+  } else if (character == '+') {
+    return 62;
+  } else if (character == '/') {
+    return 63;
+  } else if (character == '=') {
+    return 0; // Padding, trimmed by the caller
+  }
+  return -1;
+}
+
+// Decodes numberOfBytes bytes from complete 4-character base64 quanta.
+// Quanta are independent, so large payloads are decoded in parallel.
+bool decodeBase64(const uchar *source, quint64 numberOfBytes,
+                  uchar *destination) {
+  const vtkIdType numberOfQuanta =
+      static_cast<vtkIdType>((numberOfBytes + 2) / 3);
+  std::atomic_bool failed(false);
+  auto decodeQuanta = [=, &failed](vtkIdType first, vtkIdType last) {
+    for (vtkIdType q = first; q < last; ++q) {
+      const uchar *quantum = source + 4 * q;
+      const int a = base64Value(quantum[0]);
+      const int b = base64Value(quantum[1]);
+      const int c = base64Value(quantum[2]);
+      const int d = base64Value(quantum[3]);
+      if ((a | b | c | d) < 0) {
+        failed.store(true);
+        return;
+      }
+      const uchar bytes[3] = {static_cast<uchar>((a << 2) | (b >> 4)),
+                              static_cast<uchar>((b << 4) | (c >> 2)),
+                              static_cast<uchar>((c << 6) | d)};
+      const quint64 byteOffset = 3 * static_cast<quint64>(q);
+      const quint64 count = std::min<quint64>(3, numberOfBytes - byteOffset);
+      std::memcpy(destination + byteOffset, bytes, count);
+    }
+  };
+  vtkSMPTools::For(0, numberOfQuanta, 64 * 1024, decodeQuanta);
+  return !failed.load();
+}
+} // namespace
+
+// Location of one array's payload, read from its binary header
+struct VtuAppendedReader::ArrayLayout {
+  quint64 uncompressedSize = 0;
+  // Compressed layout; for uncompressed data a single block is reported
+  quint64 blockSize = 0;
+  quint64 lastBlockSize = 0;
+  std::vector<quint64> compressedBlockSizes;
+  // Start of the data in the file (raw bytes or base64 characters) and the
+  // number of decoded bytes it holds
+  const uchar *data = nullptr;
+  quint64 dataSize = 0;
+  // Base64 uncompressed streams interleave the header with the data; this is
+  // the number of decoded header bytes that precede the data
+  quint64 leadingHeaderBytes = 0;
+};
+
+struct VtuAppendedReader::DecodeTarget {
+  const VtuDataArrayDescriptor *descriptor;
+  char *destination;
+  size_t destinationSize; // Bytes expected after decoding
+};
+
+struct VtuAppendedReader::Block {
+  const uchar *source;
+  size_t sourceSize;
+  char *destination;
+  size_t destinationSize;
+};
+
+VtuAppendedReader::VtuAppendedReader(const QString &filePath,
+                                     const VtuHeader &header)
+    : filePath(filePath), header(header) {}
+
+VtuAppendedReader::~VtuAppendedReader() {
+  if (mappedData != nullptr) {
+    file.unmap(const_cast<uchar *>(mappedData));
+  }
+}
+
+bool VtuAppendedReader::canRead(const VtuHeader &header) {
+  if (header.isPartitioned()) {
+    return false; // Pieces are read one by one
+  }
+  // The header only describes the first piece; the XML reader merges them
+  if (header.numberOfPieces > 1) {
+    return false;
+  }
+  if (Q_BYTE_ORDER != Q_LITTLE_ENDIAN || header.byteOrder != "LittleEndian") {
+    return false;
+  }
+  if (header.headerType != "UInt32" && header.headerType != "UInt64") {
+    return false;
+  }
+  if (!header.compressor.isEmpty() &&
+      header.compressor != "vtkZLibDataCompressor") {
+    return false;
+  }
+  if (header.appendedEncoding != "raw" &&
+      header.appendedEncoding != "base64") {
+    return false;
+  }
+  if (!isReadableArray(header.points) ||
+      header.points.numberOfComponents != 3) {
+    return false;
+  }
+  // Polyhedra (faces/faceoffsets) are left to the VTK reader
+  if (header.cellArrays.size() != 3) {
+    return false;
+  }
+  for (const char *name : {"connectivity", "offsets", "types"}) {
+    const VtuDataArrayDescriptor *descriptor = header.findCellArray(name);
+    if (descriptor == nullptr || !isReadableArray(*descriptor)) {
+      return false;
+    }
+  }
+  for (const VtuDataArrayDescriptor &descriptor : header.pointDataArrays) {
+    if (!isReadableArray(descriptor)) {
+      return false;
+    }
+  }
+  for (const VtuDataArrayDescriptor &descriptor : header.cellDataArrays) {
+    if (!isReadableArray(descriptor)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool VtuAppendedReader::open(QString &errorMessage) {
+  headerWordSize = (header.headerType == "UInt64") ? 8 : 4;
+  compressed = (header.compressor == "vtkZLibDataCompressor");
+  base64Encoded = (header.appendedEncoding == "base64");
+
+  file.setFileName(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    errorMessage = "Failed to open VTU file:\n" + filePath;
+    return false;
+  }
+  mappedSize = file.size();
+  mappedData = file.map(0, mappedSize);
+  if (mappedData == nullptr) {
+    errorMessage = "Failed to memory-map VTU file:\n" + filePath;
+    return false;
+  }
+
+  // The payload starts right after the '_' that follows <AppendedData ...>
+  const char *begin = reinterpret_cast<const char *>(mappedData);
+  const char *end = begin + mappedSize;
+  const char tag[] = "<AppendedData";
+  const char *position =
+      std::search(begin, end, tag, tag + sizeof(tag) - 1);
+  position = std::find(position, end, '>');
+  position = std::find(position, end, '_');
+  if (position == end) {
+    errorMessage = "Failed to locate appended data in VTU file:\n" + filePath;
+    return false;
+  }
+  payloadOffset = (position - begin) + 1;
+  return true;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid>
+VtuAppendedReader::readGrid(const ProgressCallback &progressCallback,
+                            const std::atomic_bool &cancelRequested,
+                            QString &errorMessage, bool includePointData) {
+  if (mappedData == nullptr) {
+    errorMessage = "VTU file is not open:\n" + filePath;
+    return nullptr;
+  }
+
+  const vtkIdType numberOfPoints = header.numberOfPoints;
+  const vtkIdType numberOfCells = header.numberOfCells;
+  const VtuDataArrayDescriptor *connectivityDescriptor =
+      header.findCellArray("connectivity");
+  const VtuDataArrayDescriptor *offsetsDescriptor =
+      header.findCellArray("offsets");
+  const VtuDataArrayDescriptor *typesDescriptor = header.findCellArray("types");
+
+  // The connectivity length is only known from its payload header
+  ArrayLayout connectivityLayout;
+  if (!readLayout(*connectivityDescriptor, connectivityLayout, errorMessage)) {
+    return nullptr;
+  }
+  const quint64 connectivityBytes = connectivityLayout.uncompressedSize;
+
+  // Allocate every array at its final size, then decode into it in place
+  std::vector<DecodeTarget> targets;
+  auto addTarget = [&targets](const VtuDataArrayDescriptor &descriptor,
+                              vtkDataArray *array, vtkIdType leadingTuples) {
+    const vtkIdType leadingValues =
+        leadingTuples * array->GetNumberOfComponents();
+    char *destination =
+        static_cast<char *>(array->GetVoidPointer(leadingValues));
+    const size_t destinationSize =
+        static_cast<size_t>(array->GetNumberOfValues() - leadingValues) *
+        array->GetDataTypeSize();
+    targets.push_back(DecodeTarget{&descriptor, destination, destinationSize});
+  };
+
+  vtkSmartPointer<vtkDataArray> pointsArray =
+      allocateArray(header.points, numberOfPoints, 0, errorMessage);
+  if (pointsArray == nullptr) {
+    return nullptr;
+  }
+  addTarget(header.points, pointsArray, 0);
+
+  const int connectivityTypeSize =
+      vtkDataArray::GetDataTypeSize(
+          vtkTypeFromVtuType(connectivityDescriptor->type));
+  vtkSmartPointer<vtkDataArray> connectivityArray = allocateArray(
+      *connectivityDescriptor,
+      static_cast<vtkIdType>(connectivityBytes / connectivityTypeSize), 0,
+      errorMessage);
+  // VTU offsets omit the leading zero that vtkCellArray expects
+  vtkSmartPointer<vtkDataArray> offsetsArray =
+      allocateArray(*offsetsDescriptor, numberOfCells, 1, errorMessage);
+  vtkSmartPointer<vtkDataArray> typesArray =
+      allocateArray(*typesDescriptor, numberOfCells, 0, errorMessage);
+  if (connectivityArray == nullptr || offsetsArray == nullptr ||
+      typesArray == nullptr) {
+    return nullptr;
+  }
+  addTarget(*connectivityDescriptor, connectivityArray, 0);
+  addTarget(*offsetsDescriptor, offsetsArray, 1);
+  addTarget(*typesDescriptor, typesArray, 0);
+
+  std::vector<vtkSmartPointer<vtkDataArray>> pointDataArrays;
+  for (const VtuDataArrayDescriptor &descriptor : header.pointDataArrays) {
+    if (!includePointData) {
+      break;
+    }
+    vtkSmartPointer<vtkDataArray> array =
+        allocateArray(descriptor, numberOfPoints, 0, errorMessage);
+    if (array == nullptr) {
+      return nullptr;
+    }
+    addTarget(descriptor, array, 0);
+    pointDataArrays.push_back(array);
+  }
+  std::vector<vtkSmartPointer<vtkDataArray>> cellDataArrays;
+  for (const VtuDataArrayDescriptor &descriptor : header.cellDataArrays) {
+    vtkSmartPointer<vtkDataArray> array =
+        allocateArray(descriptor, numberOfCells, 0, errorMessage);
+    if (array == nullptr) {
+      return nullptr;
+    }
+    addTarget(descriptor, array, 0);
+    cellDataArrays.push_back(array);
+  }
+
+  if (!decodeTargets(targets, progressCallback, cancelRequested,
+                     errorMessage)) {
+    return nullptr;
+  }
+
+  // Assemble the grid around the decoded buffers (no further copies)
+  vtkNew<vtkPoints> points;
+  points->SetData(pointsArray);
+
+  vtkNew<vtkCellArray> cells;
+  if (!cells->SetData(offsetsArray, connectivityArray)) {
+    errorMessage = "Unsupported cell array layout in VTU file:\n" + filePath;
+    unsupportedLayout = true;
+    return nullptr;
+  }
+  vtkUnsignedCharArray *cellTypes =
+      vtkUnsignedCharArray::SafeDownCast(typesArray);
+  if (cellTypes == nullptr) {
+    errorMessage = "Unsupported cell types array in VTU file:\n" + filePath;
+    unsupportedLayout = true;
+    return nullptr;
+  }
+
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+      vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points);
+  grid->SetCells(cellTypes, cells);
+  for (vtkDataArray *array : pointDataArrays) {
+    grid->GetPointData()->AddArray(array);
+  }
+  for (vtkDataArray *array : cellDataArrays) {
+    grid->GetCellData()->AddArray(array);
+  }
+  return grid;
+}
+
+vtkSmartPointer<vtkDataArray>
+VtuAppendedReader::readPointArray(const VtuDataArrayDescriptor &descriptor,
+                                  QString &errorMessage) {
+  if (mappedData == nullptr) {
+    errorMessage = "VTU file is not open:\n" + filePath;
+    return nullptr;
+  }
+  vtkSmartPointer<vtkDataArray> array =
+      allocateArray(descriptor, header.numberOfPoints, 0, errorMessage);
+  if (array == nullptr) {
+    return nullptr;
+  }
+  const size_t destinationSize =
+      static_cast<size_t>(array->GetNumberOfValues()) *
+      array->GetDataTypeSize();
+  const std::vector<DecodeTarget> targets{DecodeTarget{
+      &descriptor, static_cast<char *>(array->GetVoidPointer(0)),
+      destinationSize}};
+  const std::atomic_bool notCancelled(false);
+  if (!decodeTargets(targets, nullptr, notCancelled, errorMessage)) {
+    return nullptr;
+  }
+  return array;
+}
+
+qint64
+VtuAppendedReader::storedSize(const VtuDataArrayDescriptor &descriptor) const {
+  if (mappedData == nullptr || descriptor.offset < 0) {
+    return -1;
+  }
+  ArrayLayout layout;
+  QString errorMessage;
+  if (!readLayout(descriptor, layout, errorMessage)) {
+    return -1;
+  }
+  // The block header precedes layout.data, except in uncompressed base64
+  // streams, which encode it together with the data
+  const uchar *arrayData = mappedData + payloadOffset + descriptor.offset;
+  const quint64 encodedDataSize =
+      base64Encoded ? base64Length(layout.dataSize) : layout.dataSize;
+  return static_cast<qint64>((layout.data - arrayData) + encodedDataSize);
+}
+
+vtkSmartPointer<vtkDataArray>
+VtuAppendedReader::allocateArray(const VtuDataArrayDescriptor &descriptor,
+                                 vtkIdType numberOfTuples,
+                                 vtkIdType leadingTuples,
+                                 QString &errorMessage) const {
+  const int dataType = vtkTypeFromVtuType(descriptor.type);
+  if (dataType == -1) {
+    errorMessage = QString("Unsupported data type '%1' of array '%2':\n%3")
+                       .arg(descriptor.type, descriptor.name, filePath);
+    return nullptr;
+  }
+
+  vtkSmartPointer<vtkDataArray> array =
+      vtkSmartPointer<vtkDataArray>::Take(
+          vtkDataArray::CreateDataArray(dataType));
+  array->SetName(descriptor.name.toStdString().c_str());
+  array->SetNumberOfComponents(descriptor.numberOfComponents);
+  array->SetNumberOfTuples(numberOfTuples + leadingTuples);
+  for (int i = 0; i < descriptor.componentNames.size(); ++i) {
+    if (!descriptor.componentNames[i].isEmpty()) {
+      array->SetComponentName(
+          i, descriptor.componentNames[i].toStdString().c_str());
+    }
+  }
+  for (vtkIdType i = 0; i < leadingTuples; ++i) {
+    for (int j = 0; j < descriptor.numberOfComponents; ++j) {
+      array->SetComponent(i, j, 0.0);
+    }
+  }
+  return array;
+}
+
+bool VtuAppendedReader::readLayout(const VtuDataArrayDescriptor &descriptor,
+                                   ArrayLayout &layout,
+                                   QString &errorMessage) const {
+  const uchar *end = mappedData + mappedSize;
+  const uchar *arrayData = mappedData + payloadOffset + descriptor.offset;
+  auto fail = [&]() {
+    errorMessage = QString("Corrupt appended data for array '%1':\n%2")
+                       .arg(descriptor.name, filePath);
+    return false;
+  };
+  auto available = [end](const uchar *from) {
+    return static_cast<quint64>(end - from);
+  };
+  if (descriptor.offset > mappedSize - payloadOffset) {
+    return fail();
+  }
+
+  // Decoded header words; base64 headers are decoded into this buffer
+  std::vector<uchar> decodedHeader;
+  const uchar *words = arrayData;
+  auto decodeHeaderPrefix = [&](quint64 numberOfBytes) {
+    if (base64Length(numberOfBytes) > available(arrayData)) {
+      return false;
+    }
+    decodedHeader.resize(numberOfBytes);
+    if (!decodeBase64(arrayData, numberOfBytes, decodedHeader.data())) {
+      return false;
+    }
+    words = decodedHeader.data();
+    return true;
+  };
+
+  if (!compressed) {
+    // Uncompressed: [numberOfBytes] followed by the data
+    if (base64Encoded) {
+      if (!decodeHeaderPrefix(headerWordSize)) {
+        return fail();
+      }
+    } else if (static_cast<quint64>(headerWordSize) > available(arrayData)) {
+      return fail();
+    }
+    layout.uncompressedSize = readHeaderWord(words);
+    layout.blockSize = layout.uncompressedSize;
+    if (base64Encoded) {
+      // One base64 stream covers both the header word and the data
+      layout.data = arrayData;
+      layout.dataSize = headerWordSize + layout.uncompressedSize;
+      layout.leadingHeaderBytes = headerWordSize;
+      if (base64Length(layout.dataSize) > available(arrayData)) {
+        return fail();
+      }
+    } else {
+      layout.data = arrayData + headerWordSize;
+      layout.dataSize = layout.uncompressedSize;
+      if (layout.dataSize > available(layout.data)) {
+        return fail();
+      }
+    }
+    return true;
+  }
+
+  // vtkZLibDataCompressor header: [nblocks][blockSize][lastBlockSize]
+  // followed by the compressed size of every block
+  if (base64Encoded) {
+    if (!decodeHeaderPrefix(3 * headerWordSize)) {
+      return fail();
+    }
+  } else if (3 * static_cast<quint64>(headerWordSize) > available(arrayData)) {
+    return fail();
+  }
+  const quint64 numberOfBlocks = readHeaderWord(words);
+  layout.blockSize = readHeaderWord(words + headerWordSize);
+  layout.lastBlockSize = readHeaderWord(words + 2 * headerWordSize);
+  if (numberOfBlocks > available(arrayData)) {
+    return fail();
+  }
+  const quint64 headerSize = (3 + numberOfBlocks) * headerWordSize;
+  quint64 encodedHeaderSize = headerSize;
+  if (base64Encoded) {
+    // The whole header is one base64 stream, separate from the data
+    if (!decodeHeaderPrefix(headerSize)) {
+      return fail();
+    }
+    encodedHeaderSize = base64Length(headerSize);
+  } else if (headerSize > available(arrayData)) {
+    return fail();
+  }
+
+  layout.uncompressedSize =
+      (numberOfBlocks == 0)
+          ? 0
+          : (numberOfBlocks - 1) * layout.blockSize +
+                (layout.lastBlockSize != 0 ? layout.lastBlockSize
+                                           : layout.blockSize);
+  layout.compressedBlockSizes.resize(numberOfBlocks);
+  layout.dataSize = 0;
+  for (quint64 i = 0; i < numberOfBlocks; ++i) {
+    layout.compressedBlockSizes[i] =
+        readHeaderWord(words + (3 + i) * headerWordSize);
+    layout.dataSize += layout.compressedBlockSizes[i];
+  }
+  layout.data = arrayData + encodedHeaderSize;
+  const quint64 encodedDataSize =
+      base64Encoded ? base64Length(layout.dataSize) : layout.dataSize;
+  if (encodedHeaderSize > available(arrayData) ||
+      encodedDataSize > available(layout.data)) {
+    return fail();
+  }
+  return true;
+}
+
+bool VtuAppendedReader::collectBlocks(
+    const DecodeTarget &target, std::vector<Block> &blocks,
+    std::vector<std::vector<uchar>> &scratchBuffers,
+    QString &errorMessage) const {
+  const VtuDataArrayDescriptor &descriptor = *target.descriptor;
+  ArrayLayout layout;
+  if (!readLayout(descriptor, layout, errorMessage)) {
+    return false;
+  }
+  if (layout.uncompressedSize != target.destinationSize) {
+    errorMessage =
+        QString("Size mismatch in appended data for array '%1':\n%2")
+            .arg(descriptor.name, filePath);
+    return false;
+  }
+
+  // Base64 payloads are decoded once into a scratch buffer; the blocks are
+  // then copied or inflated from there
+  const uchar *source = layout.data;
+  if (base64Encoded) {
+    scratchBuffers.emplace_back(static_cast<size_t>(layout.dataSize));
+    std::vector<uchar> &scratch = scratchBuffers.back();
+    if (!decodeBase64(layout.data, layout.dataSize, scratch.data())) {
+      errorMessage = QString("Invalid base64 data for array '%1':\n%2")
+                         .arg(descriptor.name, filePath);
+      return false;
+    }
+    source = scratch.data() + layout.leadingHeaderBytes;
+  }
+
+  if (!compressed) {
+    for (quint64 chunkOffset = 0; chunkOffset < layout.uncompressedSize;
+         chunkOffset += rawChunkSize) {
+      const size_t chunkSize = static_cast<size_t>(std::min<quint64>(
+          rawChunkSize, layout.uncompressedSize - chunkOffset));
+      blocks.push_back(Block{source + chunkOffset, chunkSize,
+                             target.destination + chunkOffset, chunkSize});
+    }
+    return true;
+  }
+
+  size_t destinationOffset = 0;
+  const size_t numberOfBlocks = layout.compressedBlockSizes.size();
+  for (size_t i = 0; i < numberOfBlocks; ++i) {
+    const quint64 uncompressedSize =
+        (i + 1 == numberOfBlocks && layout.lastBlockSize != 0)
+            ? layout.lastBlockSize
+            : layout.blockSize;
+    blocks.push_back(
+        Block{source, static_cast<size_t>(layout.compressedBlockSizes[i]),
+              target.destination + destinationOffset,
+              static_cast<size_t>(uncompressedSize)});
+    source += layout.compressedBlockSizes[i];
+    destinationOffset += uncompressedSize;
+  }
+  return true;
+}
+
+bool VtuAppendedReader::decodeTargets(
+    const std::vector<DecodeTarget> &targets,
+    const ProgressCallback &progressCallback,
+    const std::atomic_bool &cancelRequested, QString &errorMessage) const {
+  std::vector<Block> blocks;
+  std::vector<std::vector<uchar>> scratchBuffers;
+  scratchBuffers.reserve(targets.size());
+  for (const DecodeTarget &target : targets) {
+    if (cancelRequested.load()) {
+      return false;
+    }
+    if (!collectBlocks(target, blocks, scratchBuffers, errorMessage)) {
+      return false;
+    }
+  }
+
+  std::atomic_bool failed(false);
+  const bool inflate = compressed;
+  auto decodeRange = [&blocks, &failed, inflate](vtkIdType first,
+                                                 vtkIdType last) {
+    for (vtkIdType i = first; i < last; ++i) {
+      const Block &block = blocks[i];
+      if (!inflate) {
+        std::memcpy(block.destination, block.source, block.sourceSize);
+        continue;
+      }
+      uLongf destinationSize = static_cast<uLongf>(block.destinationSize);
+      const int status = uncompress(
+          reinterpret_cast<Bytef *>(block.destination), &destinationSize,
+          reinterpret_cast<const Bytef *>(block.source),
+          static_cast<uLong>(block.sourceSize));
+      if (status != Z_OK || destinationSize != block.destinationSize) {
+        failed.store(true);
+      }
+    }
+  };
+
+  // Decode in batches so progress and cancellation stay responsive
+  for (size_t batchBegin = 0; batchBegin < blocks.size();
+       batchBegin += blocksPerBatch) {
+    if (cancelRequested.load()) {
+      return false;
+    }
+    const size_t batchEnd =
+        std::min(blocks.size(), batchBegin + blocksPerBatch);
+    vtkSMPTools::For(static_cast<vtkIdType>(batchBegin),
+                     static_cast<vtkIdType>(batchEnd), 1, decodeRange);
+    if (failed.load()) {
+      errorMessage = "Failed to decompress appended data in VTU file:\n" +
+                     filePath;
+      return false;
+    }
+    if (progressCallback) {
+      progressCallback(static_cast<double>(batchEnd) / blocks.size(),
+                       "Decoding mesh and point data");
+    }
+  }
+  return !cancelRequested.load();
+}
+
+quint64 VtuAppendedReader::readHeaderWord(const uchar *data) const {
+  if (headerWordSize == 8) {
+    quint64 value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+  }
+  quint32 value = 0;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
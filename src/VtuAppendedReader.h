@@ -0,0 +1,90 @@
+#ifndef VTU_APPENDED_READER_H
+#define VTU_APPENDED_READER_H
+
+#include <QFile>
+#include <QString>
+
+#include <vtkDataArray.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "VtuHeaderScanner.h"
+
+// Reads VTU files whose arrays are all stored in <AppendedData> (raw or
+// base64), uncompressed or compressed with vtkZLibDataCompressor. The file is
+// memory-mapped and every compressed block is inflated on the VTK SMP thread
+// pool directly into the buffer of the final vtkDataArray.
+class VtuAppendedReader {
+public:
+  using ProgressCallback =
+      std::function<void(double progress, const QString &stage)>;
+
+  VtuAppendedReader(const QString &filePath, const VtuHeader &header);
+  ~VtuAppendedReader();
+
+  // Whether the header describes a layout this reader supports; files that
+  // are not supported should go through vtkXMLUnstructuredGridReader
+  static bool canRead(const VtuHeader &header);
+
+  // Maps the file and locates the appended payload
+  bool open(QString &errorMessage);
+
+  // Returns nullptr on failure (errorMessage set) or cancellation (empty).
+  // Without point data only geometry, topology and cell data are decoded.
+  vtkSmartPointer<vtkUnstructuredGrid>
+  readGrid(const ProgressCallback &progressCallback,
+           const std::atomic_bool &cancelRequested, QString &errorMessage,
+           bool includePointData = true);
+  // Whether readGrid failed on a cell layout vtkCellArray cannot take as
+  // decoded; the file is readable by vtkXMLUnstructuredGridReader
+  bool hasUnsupportedLayout() const { return unsupportedLayout; }
+
+  // Decodes a single point array straight from its appended offset
+  vtkSmartPointer<vtkDataArray>
+  readPointArray(const VtuDataArrayDescriptor &descriptor,
+                 QString &errorMessage);
+
+  // Bytes the array occupies in the appended payload, as its own block
+  // header gives them (header and data, base64 characters if encoded); -1 if
+  // the block header is corrupt
+  qint64 storedSize(const VtuDataArrayDescriptor &descriptor) const;
+
+private:
+  struct ArrayLayout;
+  struct DecodeTarget;
+  struct Block;
+
+  vtkSmartPointer<vtkDataArray>
+  allocateArray(const VtuDataArrayDescriptor &descriptor,
+                vtkIdType numberOfTuples, vtkIdType leadingTuples,
+                QString &errorMessage) const;
+  bool readLayout(const VtuDataArrayDescriptor &descriptor,
+                  ArrayLayout &layout, QString &errorMessage) const;
+  bool collectBlocks(const DecodeTarget &target, std::vector<Block> &blocks,
+                     std::vector<std::vector<uchar>> &scratchBuffers,
+                     QString &errorMessage) const;
+  bool decodeTargets(const std::vector<DecodeTarget> &targets,
+                     const ProgressCallback &progressCallback,
+                     const std::atomic_bool &cancelRequested,
+                     QString &errorMessage) const;
+
+  quint64 readHeaderWord(const uchar *data) const;
+
+private:
+  QString filePath;
+  VtuHeader header;
+  QFile file;
+  const uchar *mappedData = nullptr;
+  qint64 mappedSize = 0;
+  qint64 payloadOffset = -1; // File offset of the byte after '_'
+  int headerWordSize = 4;
+  bool compressed = false;
+  bool base64Encoded = false;
+  bool unsupportedLayout = false;
+};
+
+#endif // VTU_APPENDED_READER_H
@@ -0,0 +1,211 @@
+#include "VtuHeaderScanner.h"
+
+#include <QFile>
+#include <QXmlStreamReader>
+
+#include "PvtuReader.h"
+#include "VtuAppendedReader.h"
+
+namespace {
+VtuDataArrayDescriptor readDescriptor(const QXmlStreamAttributes &attrs) {
+  VtuDataArrayDescriptor descriptor;
+  descriptor.name = attrs.value("Name").toString();
+  descriptor.type = attrs.value("type").toString();
+  descriptor.format = attrs.value("format").toString();
+
+  // Writers pad numeric attributes with spaces so they can be patched in place
+  bool ok = false;
+  const int numComponents =
+      attrs.value("NumberOfComponents").trimmed().toInt(&ok);
+  descriptor.numberOfComponents = (ok && numComponents > 0) ? numComponents : 1;
+
+  const qint64 offset = attrs.value("offset").trimmed().toLongLong(&ok);
+  descriptor.offset = ok ? offset : -1;
+
+  bool minOk = false;
+  bool maxOk = false;
+  const double rangeMin = attrs.value("RangeMin").trimmed().toDouble(&minOk);
+  const double rangeMax = attrs.value("RangeMax").trimmed().toDouble(&maxOk);
+  if (minOk && maxOk) {
+    descriptor.hasDeclaredRange = true;
+    descriptor.rangeMin = rangeMin;
+    descriptor.rangeMax = rangeMax;
+  }
+
+  // Extract ComponentName0, ComponentName1, etc. (kept positional)
+  bool anyComponentName = false;
+  QVector<QString> componentNames;
+  for (int i = 0; i < descriptor.numberOfComponents; ++i) {
+    const QString componentName =
+        attrs.value(QString("ComponentName%1").arg(i)).toString();
+    anyComponentName = anyComponentName || !componentName.isEmpty();
+    componentNames.push_back(componentName);
+  }
+  if (anyComponentName) {
+    descriptor.componentNames = componentNames;
+  }
+  return descriptor;
+}
+
+bool isSectionElement(QStringView name) {
+  return name == QLatin1String("Points") || name == QLatin1String("Cells") ||
+         name == QLatin1String("PointData") ||
+         name == QLatin1String("CellData") ||
+         name == QLatin1String("FieldData");
+}
+
+// Sets the extent of every appended array from its own block header. The
+// reader locates the payload by scanning the raw bytes for the '_' marker,
+// so no XML stream position (counted in characters) is involved.
+void assignAppendedExtents(const QString &filePath, VtuHeader &header) {
+  if (!VtuAppendedReader::canRead(header)) {
+    return; // Extents stay unknown; such files are always loaded again
+  }
+  VtuAppendedReader reader(filePath, header);
+  QString errorMessage;
+  if (!reader.open(errorMessage)) {
+    return;
+  }
+  auto assign = [&reader](VtuDataArrayDescriptor &descriptor) {
+    if (descriptor.isAppended()) {
+      descriptor.extent = reader.storedSize(descriptor);
+    }
+  };
+  assign(header.points);
+  for (QVector<VtuDataArrayDescriptor> *descriptors :
+       {&header.cellArrays, &header.pointDataArrays, &header.cellDataArrays}) {
+    for (VtuDataArrayDescriptor &descriptor : *descriptors) {
+      assign(descriptor);
+    }
+  }
+}
+} // namespace
+
+bool VtuDataArrayDescriptor::isNumeric() const {
+  static const QVector<QString> numericTypes = {
+      "Int8",  "UInt8",  "Int16", "UInt16",  "Int32",
+      "UInt32", "Int64", "UInt64", "Float32", "Float64"};
+  return numericTypes.contains(type);
+}
+
+bool VtuDataArrayDescriptor::declaresSameData(
+    const VtuDataArrayDescriptor &other) const {
+  return isAppended() && other.isAppended() && extent >= 0 &&
+         name == other.name && type == other.type &&
+         numberOfComponents == other.numberOfComponents &&
+         offset == other.offset && extent == other.extent &&
+         hasDeclaredRange == other.hasDeclaredRange &&
+         rangeMin == other.rangeMin && rangeMax == other.rangeMax;
+}
+
+const VtuDataArrayDescriptor *
+VtuHeader::findPointDataArray(const QString &name) const {
+  for (const VtuDataArrayDescriptor &descriptor : pointDataArrays) {
+    if (descriptor.name == name) {
+      return &descriptor;
+    }
+  }
+  return nullptr;
+}
+
+const VtuDataArrayDescriptor *
+VtuHeader::findCellDataArray(const QString &name) const {
+  for (const VtuDataArrayDescriptor &descriptor : cellDataArrays) {
+    if (descriptor.name == name) {
+      return &descriptor;
+    }
+  }
+  return nullptr;
+}
+
+const VtuDataArrayDescriptor *
+VtuHeader::findCellArray(const QString &name) const {
+  for (const VtuDataArrayDescriptor &descriptor : cellArrays) {
+    if (descriptor.name == name) {
+      return &descriptor;
+    }
+  }
+  return nullptr;
+}
+
+bool VtuHeaderScanner::scan(const QString &filePath, VtuHeader &header,
+                            QString &errorMessage) {
+  if (PvtuReader::isPvtuPath(filePath)) {
+    return PvtuReader::scanHeader(filePath, header, errorMessage);
+  }
+  header = VtuHeader();
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    errorMessage = "Failed to open VTU file:\n" + filePath;
+    return false;
+  }
+
+  QXmlStreamReader xml(&file);
+  QString section;
+  bool sawVtkFile = false;
+  while (!xml.atEnd() && !xml.hasError()) {
+    const QXmlStreamReader::TokenType token = xml.readNext();
+    if (token == QXmlStreamReader::EndElement) {
+      if (isSectionElement(xml.name())) {
+        section.clear();
+      }
+      continue;
+    }
+    if (token != QXmlStreamReader::StartElement) {
+      continue;
+    }
+
+    const QStringView name = xml.name();
+    const QXmlStreamAttributes attrs = xml.attributes();
+    if (name == QLatin1String("VTKFile")) {
+      sawVtkFile = true;
+      header.byteOrder = attrs.value("byte_order").toString();
+      header.headerType = attrs.value("header_type").toString();
+      header.compressor = attrs.value("compressor").toString();
+      if (header.headerType.isEmpty()) {
+        header.headerType = "UInt32"; // Default of VTK file version 0.1
+      }
+    } else if (name == QLatin1String("AppendedData")) {
+      // Everything after this point is payload
+      header.appendedEncoding = attrs.value("encoding").toString();
+      break;
+    } else if (name == QLatin1String("Piece")) {
+      ++header.numberOfPieces;
+      if (header.numberOfPieces == 1) {
+        header.numberOfPoints =
+            attrs.value("NumberOfPoints").trimmed().toLongLong();
+        header.numberOfCells =
+            attrs.value("NumberOfCells").trimmed().toLongLong();
+      }
+    } else if (isSectionElement(name)) {
+      section = name.toString();
+    } else if (name == QLatin1String("DataArray")) {
+      if (header.numberOfPieces == 1) {
+        const VtuDataArrayDescriptor descriptor = readDescriptor(attrs);
+        if (section == "Points") {
+          header.points = descriptor;
+        } else if (section == "Cells") {
+          header.cellArrays.push_back(descriptor);
+        } else if (section == "PointData") {
+          header.pointDataArrays.push_back(descriptor);
+        } else if (section == "CellData") {
+          header.cellDataArrays.push_back(descriptor);
+        }
+      }
+      // Skip inline payload and nested <InformationKey> elements
+      xml.skipCurrentElement();
+    }
+  }
+
+  if (xml.hasError() || !sawVtkFile) {
+    errorMessage = QString("Failed to parse VTU header (%1):\n%2")
+                       .arg(xml.hasError() ? xml.errorString()
+                                           : QString("no VTKFile element"))
+                       .arg(filePath);
+    return false;
+  }
+  file.close();
+  assignAppendedExtents(filePath, header);
+  return true;
+}
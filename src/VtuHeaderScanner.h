@@ -0,0 +1,71 @@
+#ifndef VTU_HEADER_SCANNER_H
+#define VTU_HEADER_SCANNER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <vector>
+
+// Declared layout of a single <DataArray> as written in the VTU header
+struct VtuDataArrayDescriptor {
+  QString name;
+  QString type; // VTU type name, e.g. "Float64", "Int64", "UInt8"
+  QString format; // "ascii", "binary" or "appended"
+  int numberOfComponents = 1;
+  QVector<QString> componentNames;
+  qint64 offset = -1; // Offset into <AppendedData>; -1 for inline data
+  // Bytes of the array's block in <AppendedData> (header and data), read
+  // from its block header; -1 for inline data and for files
+  // VtuAppendedReader cannot read. Set by VtuHeaderScanner::scan.
+  qint64 extent = -1;
+  bool hasDeclaredRange = false;
+  double rangeMin = 0.0;
+  double rangeMax = 0.0;
+
+  bool isAppended() const { return format == "appended"; }
+  bool isNumeric() const;
+  // Whether both descriptors declare the same appended bytes: name, type,
+  // components, offset, extent and declared range are equal. Inline data is
+  // never considered the same, as its values are not compared.
+  bool declaresSameData(const VtuDataArrayDescriptor &other) const;
+};
+
+// Everything the VTU header declares about the first <Piece>
+struct VtuHeader {
+  QString byteOrder;
+  QString headerType;
+  QString compressor;
+  QString appendedEncoding; // "raw" or "base64"; empty without <AppendedData>
+  qint64 numberOfPoints = 0;
+  qint64 numberOfCells = 0;
+  int numberOfPieces = 0; // <Piece> elements; only the first is described
+
+  VtuDataArrayDescriptor points;
+  QVector<VtuDataArrayDescriptor> cellArrays; // connectivity, offsets, types...
+  QVector<VtuDataArrayDescriptor> pointDataArrays;
+  QVector<VtuDataArrayDescriptor> cellDataArrays;
+
+  // Pieces of a partitioned (.pvtu) file and their own headers. The fields
+  // above then describe the combined grid: counts are summed and arrays and
+  // their layout are those of the first piece.
+  QStringList pieceFilePaths;
+  std::vector<VtuHeader> pieceHeaders;
+
+  bool isPartitioned() const { return !pieceFilePaths.isEmpty(); }
+
+  const VtuDataArrayDescriptor *findPointDataArray(const QString &name) const;
+  const VtuDataArrayDescriptor *findCellDataArray(const QString &name) const;
+  const VtuDataArrayDescriptor *findCellArray(const QString &name) const;
+};
+
+class VtuHeaderScanner {
+public:
+  // Parses the XML header only. Scanning stops at <AppendedData>, so the
+  // binary payload of appended files is never read. Inline arrays are
+  // skipped without being decoded. A .pvtu file is scanned piece by piece.
+  static bool scan(const QString &filePath, VtuHeader &header,
+                   QString &errorMessage);
+};
+
+#endif // VTU_HEADER_SCANNER_H
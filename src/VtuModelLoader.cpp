@@ -1,75 +1,925 @@
 ﻿#include "VtuModelLoader.h"
 
-#include <QFile>
-#include <QMap>
 #include <QScopedPointer.h>
-#include <QXmlStreamReader>
 
+#include <vtkCallbackCommand.h>
+#include <vtkCellData.h>
+#include <vtkCommand.h>
 #include <vtkDataArray.h>
+#include <vtkDataArraySelection.h>
+#include <vtkFloatArray.h>
+#include <vtkGeometryFilter.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkUnstructuredGrid.h>
 #include <vtkXMLUnstructuredGridReader.h>
 
-VtuModelLoader::VtuModelLoader(QObject *parent) : QObject(parent) {}
+#include <algorithm>
+#include <cstring>
 
-void VtuModelLoader::load(const QString &filePath) {
-  // Allocate a new model instance; ownership is transferred to the receiver
-  QScopedPointer<LoadedVtuModel> outModel(new LoadedVtuModel());
+#include "DecodedModelCache.h"
+#include "ModelMemoryUsage.h"
+#include "PerfTrace.h"
+#include "PvtuReader.h"
+#include "VtuAppendedReader.h"
+
+namespace {
+struct AlgorithmProgressContext {
+  vtkAlgorithm *algorithm;
+  const std::atomic_bool *cancelRequested;
+  std::function<void(double, const QString &)> reportProgress;
+  QString stage;
+};
+
+void onAlgorithmProgress(vtkObject * /*caller*/, unsigned long /*eventId*/,
+                         void *clientData, void *callData) {
+  auto *context = static_cast<AlgorithmProgressContext *>(clientData);
+  if (context->cancelRequested->load()) {
+    // Readers and filters check this flag between pieces of work
+    context->algorithm->SetAbortExecute(1);
+    return;
+  }
+  const double progress = *static_cast<double *>(callData);
+  context->reportProgress(progress, context->stage);
+}
 
+vtkSmartPointer<vtkUnstructuredGrid>
+readGridWithXmlReader(const QString &filePath,
+                      const VtuModelLoader::ProgressCallback &reportProgress,
+                      const std::atomic_bool &cancelRequested,
+                      QString &errorMessage, bool includePointData) {
   vtkNew<vtkXMLUnstructuredGridReader> reader;
   reader->SetFileName(filePath.toStdString().c_str());
+  if (!includePointData) {
+    reader->UpdateInformation();
+    reader->GetPointDataArraySelection()->DisableAllArrays();
+  }
+
+  // Forward reader progress and abort it once cancellation is requested
+  AlgorithmProgressContext progressContext{reader.GetPointer(),
+                                           &cancelRequested, reportProgress,
+                                           "Reading mesh and point data"};
+  vtkNew<vtkCallbackCommand> progressCommand;
+  progressCommand->SetCallback(onAlgorithmProgress);
+  progressCommand->SetClientData(&progressContext);
+  reader->AddObserver(vtkCommand::ProgressEvent, progressCommand.GetPointer());
+
+  reportProgress(0.0, "Reading mesh and point data");
   reader->Update();
+  reader->RemoveObserver(progressCommand.GetPointer());
+  if (cancelRequested.load()) {
+    return nullptr;
+  }
 
   vtkUnstructuredGrid *output = reader->GetOutput();
   if (output == nullptr) {
-    emit modelLoadingErrorOccured("Failed to read VTU file (no output):\n" +
-                                  filePath);
+    errorMessage = "Failed to read VTU file (no output):\n" + filePath;
+    return nullptr;
+  }
+
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+      vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->ShallowCopy(output);
+  return grid;
+}
+
+bool readPointArraysWithXmlReader(
+    const QString &filePath, const QStringList &arrayNames,
+    const VtuModelLoader::ProgressCallback &reportProgress,
+    const std::atomic_bool &cancelRequested,
+    QVector<vtkSmartPointer<vtkDataArray>> &arrays, QString &errorMessage) {
+  // The XML reader cannot skip geometry, so all arrays are decoded in one
+  // pass; only the selected ones are decoded
+  vtkNew<vtkXMLUnstructuredGridReader> reader;
+  reader->SetFileName(filePath.toStdString().c_str());
+  reader->UpdateInformation();
+  reader->GetPointDataArraySelection()->DisableAllArrays();
+  for (const QString &arrayName : arrayNames) {
+    reader->GetPointDataArraySelection()->EnableArray(
+        arrayName.toStdString().c_str());
+  }
+  reader->GetCellDataArraySelection()->DisableAllArrays();
+
+  AlgorithmProgressContext progressContext{
+      reader.GetPointer(), &cancelRequested,
+      [&reportProgress](double progress, const QString &stage) {
+        if (reportProgress) {
+          reportProgress(progress, stage);
+        }
+      },
+      "Decoding point arrays"};
+  vtkNew<vtkCallbackCommand> progressCommand;
+  progressCommand->SetCallback(onAlgorithmProgress);
+  progressCommand->SetClientData(&progressContext);
+  reader->AddObserver(vtkCommand::ProgressEvent, progressCommand.GetPointer());
+  reader->Update();
+  reader->RemoveObserver(progressCommand.GetPointer());
+  if (cancelRequested.load()) {
+    return false;
+  }
+
+  vtkUnstructuredGrid *output = reader->GetOutput();
+  for (const QString &arrayName : arrayNames) {
+    vtkDataArray *array =
+        (output != nullptr)
+            ? output->GetPointData()->GetArray(arrayName.toStdString().c_str())
+            : nullptr;
+    if (array == nullptr) {
+      errorMessage = QString("Failed to read point array '%1':\n%2")
+                         .arg(arrayName, filePath);
+      arrays.clear();
+      return false;
+    }
+    arrays.push_back(array);
+  }
+  return true;
+}
+
+PointArrayInfo makePointArrayInfo(const QString &arrayName,
+                                  int numberOfComponents, vtkDataArray *arr,
+                                  const VtuDataArrayDescriptor *descriptor) {
+  QVector<QString> componentNames;
+
+  // For multi-component arrays, add "Magnitude" as first option (maps to
+  // componentIndex -1)
+  if (numberOfComponents > 1) {
+    componentNames.push_back("Magnitude");
+  }
+
+  // Use component names already read by VTK, otherwise from the header
+  // descriptor, otherwise default
+  for (int j = 0; j < numberOfComponents; ++j) {
+    QString componentName;
+    const char *vtkComponentName =
+        (arr != nullptr) ? arr->GetComponentName(j) : nullptr;
+    if (vtkComponentName != nullptr) {
+      componentName = QString::fromStdString(vtkComponentName);
+    } else if (descriptor != nullptr &&
+               j < descriptor->componentNames.size() &&
+               !descriptor->componentNames[j].isEmpty()) {
+      componentName = descriptor->componentNames[j];
+    } else {
+      // Default naming
+      if (numberOfComponents == 1) {
+        componentName = "Magnitude";
+      } else {
+        componentName = QString("Component %1").arg(j);
+      }
+    }
+    componentNames.push_back(componentName);
+  }
+  return PointArrayInfo(arrayName, componentNames);
+}
+} // namespace
+
+VtuModelLoader::VtuModelLoader(QObject *parent) : QObject(parent) {}
+
+VtuModelLoader::~VtuModelLoader() = default;
+
+void VtuModelLoader::load(const QString &filePath) {
+  const std::atomic_bool notCancelled(false);
+  ProgressCallback progressCallback = [this](double progress,
+                                             const QString &stage) {
+    emit modelLoadingProgressChanged(progress, stage);
+  };
+
+  QString errorMessage;
+  std::unique_ptr<DecodedModelSnapshot> cacheSnapshot;
+  LoadedVtuModel *model =
+      readModelCached(filePath, options, progressCallback, notCancelled,
+                      errorMessage, cacheSnapshot);
+  if (model == nullptr) {
+    emit modelLoadingErrorOccured(errorMessage);
     return;
   }
+  // Ownership is transferred to the receiver
+  emit modelLoaded(model, filePath);
+  storeInCache(options, cacheSnapshot.get(), notCancelled);
+}
+
+void VtuModelLoader::loadAsync(const QString &filePath) {
+  // Only one load is delivered at a time; a superseded load is cancelled
+  // (which also stops its cache write) and its result is dropped
+  loading = true;
+  const VtuLoadOptions loadOptions = options;
+  worker.start([this, filePath,
+                loadOptions](const LatestRequestWorker::Job &job) {
+    ProgressCallback progressCallback = [this, &job](double progress,
+                                                     const QString &stage) {
+      job.post([this, progress, stage]() {
+        emit modelLoadingProgressChanged(progress, stage);
+      });
+    };
+
+    QString errorMessage;
+    std::unique_ptr<DecodedModelSnapshot> cacheSnapshot;
+    std::shared_ptr<LoadedVtuModel> model(
+        readModelCached(filePath, loadOptions, progressCallback,
+                        job.cancelFlag(), errorMessage, cacheSnapshot));
+
+    // A dropped model is freed with the last copy of the closure
+    job.post([this, job, filePath, model, errorMessage]() {
+      loading = false;
+      if (job.isCancelled()) {
+        emit modelLoadingCancelled(filePath);
+        return;
+      }
+      if (model == nullptr) {
+        emit modelLoadingErrorOccured(errorMessage);
+        return;
+      }
+      // Ownership is transferred to the receiver
+      emit modelLoaded(new LoadedVtuModel(std::move(*model)), filePath);
+    });
 
-  const vtkIdType numPoints = output->GetNumberOfPoints();
-  if (numPoints == 0) {
-    emit modelLoadingErrorOccured("Failed to read VTU file (no points):\n" +
-                                  filePath);
+    // The snapshot holds its own references, so the entry is written while
+    // the model is already in use; a newer load cancels the write
+    storeInCache(loadOptions, cacheSnapshot.get(), job.cancelFlag());
+  });
+}
+
+void VtuModelLoader::decodePointArraysAsync(const LoadedVtuModel &model,
+                                            const QStringList &arrayNames) {
+  const QString filePath = model.filePath;
+  const VtuHeader header = model.header;
+  decodeWorker.start([this, filePath, header,
+                      arrayNames](const LatestRequestWorker::Job &job) {
+    ProgressCallback progressCallback = [this, &job](double progress,
+                                                     const QString &stage) {
+      job.post([this, progress, stage]() {
+        emit modelLoadingProgressChanged(progress, stage);
+      });
+    };
+
+    QVector<vtkSmartPointer<vtkDataArray>> arrays;
+    QString errorMessage;
+    const bool ok = readPointArrays(filePath, header, arrayNames,
+                                    progressCallback, job.cancelFlag(),
+                                    arrays, errorMessage);
+
+    job.post([this, job, filePath, ok, arrays, errorMessage]() {
+      if (job.isCancelled()) {
+        emit pointArrayDecodingCancelled();
+        return;
+      }
+      if (!ok) {
+        emit pointArrayDecodingFailed(errorMessage);
+        return;
+      }
+      emit pointArraysDecoded(filePath, arrays);
+    });
+  });
+}
+
+void VtuModelLoader::cancelPointArrayDecode() { decodeWorker.cancel(); }
+
+void VtuModelLoader::cancel() {
+  worker.cancel();
+  decodeWorker.cancel();
+}
+
+bool VtuModelLoader::isLoading() const { return loading; }
+
+void VtuModelLoader::setLoadOptions(const VtuLoadOptions &options) {
+  this->options = options;
+}
+
+const VtuLoadOptions &VtuModelLoader::loadOptions() const { return options; }
+
+bool VtuModelLoader::ensurePointArrayLoaded(LoadedVtuModel &model,
+                                            int arrayIndex,
+                                            QString &errorMessage) {
+  if (model.grid == nullptr || arrayIndex < 0 ||
+      arrayIndex >= model.pointArraysInfo.size()) {
+    errorMessage = QString("Invalid array index: %1").arg(arrayIndex);
+    return false;
+  }
+  const QString &arrayName = model.pointArraysInfo[arrayIndex].name;
+  vtkPointData *pointData = model.grid->GetPointData();
+
+  if (pointData->GetArray(arrayName.toStdString().c_str()) == nullptr) {
+    PerfTrace::Scope scope("load", "Decode point array");
+    vtkSmartPointer<vtkDataArray> array = readPointArray(
+        model.filePath, model.header, arrayName, errorMessage);
+    if (array == nullptr) {
+      return false;
+    }
+    addPointArray(model, array);
+  }
+
+  model.recentlyUsedPointArrays.removeAll(arrayName);
+  model.recentlyUsedPointArrays.prepend(arrayName);
+  evictPointArrays(model);
+  return true;
+}
+
+QStringList
+VtuModelLoader::missingPointArrays(const LoadedVtuModel &model,
+                                   const QVector<int> &arrayIndices) {
+  QStringList arrayNames;
+  if (model.grid == nullptr) {
+    return arrayNames;
+  }
+  vtkPointData *pointData = model.grid->GetPointData();
+  for (const int arrayIndex : arrayIndices) {
+    if (arrayIndex < 0 || arrayIndex >= model.pointArraysInfo.size()) {
+      continue;
+    }
+    const QString &arrayName = model.pointArraysInfo[arrayIndex].name;
+    if (pointData->GetArray(arrayName.toStdString().c_str()) == nullptr &&
+        !arrayNames.contains(arrayName)) {
+      arrayNames.push_back(arrayName);
+    }
+  }
+  return arrayNames;
+}
+
+void VtuModelLoader::installPointArrays(
+    LoadedVtuModel &model,
+    const QVector<vtkSmartPointer<vtkDataArray>> &arrays) {
+  if (model.grid == nullptr) {
     return;
   }
+  for (vtkDataArray *array : arrays) {
+    if (array == nullptr || array->GetName() == nullptr) {
+      continue;
+    }
+    const QString arrayName = QString::fromStdString(array->GetName());
+    addPointArray(model, array);
+    model.recentlyUsedPointArrays.removeAll(arrayName);
+    model.recentlyUsedPointArrays.prepend(arrayName);
+  }
+}
 
-  outModel->grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
-  outModel->grid->ShallowCopy(output);
-
-  // Parse XML to extract component names directly
-  QMap<QString, QVector<QString>> arrayComponentNames;
-  QFile file(filePath);
-  if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    QXmlStreamReader xml(&file);
-    while (!xml.atEnd() && !xml.hasError()) {
-      QXmlStreamReader::TokenType token = xml.readNext();
-      if (token == QXmlStreamReader::StartElement &&
-          xml.name() == QString("DataArray")) {
-        QXmlStreamAttributes attrs = xml.attributes();
-        QString arrayName = attrs.value("Name").toString();
-        int numComponents = attrs.value("NumberOfComponents").toInt();
-
-        if (!arrayName.isEmpty() && numComponents > 0) {
-          QVector<QString> componentNames;
-          // Extract ComponentName0, ComponentName1, etc.
-          for (int i = 0; i < numComponents; ++i) {
-            QString attrName = QString("ComponentName%1").arg(i);
-            QString componentName = attrs.value(attrName).toString();
-            if (!componentName.isEmpty()) {
-              componentNames.push_back(componentName);
-            }
-          }
-          if (!componentNames.isEmpty()) {
-            arrayComponentNames[arrayName] = componentNames;
-          }
-        }
+void VtuModelLoader::switchPointDataFile(LoadedVtuModel &model,
+                                         const QString &filePath,
+                                         const VtuHeader &header,
+                                         vtkDataArray *pointArray) {
+  vtkPointData *pointData = model.grid->GetPointData();
+  while (pointData->GetNumberOfArrays() > 0) {
+    pointData->RemoveArray(0);
+  }
+  model.recentlyUsedPointArrays.clear();
+  model.filePath = filePath;
+  model.header = header;
+  model.mappedFromCache = false; // Point arrays now come from the file
+
+  // Ranges of the previous file no longer apply
+  model.pointArrayRanges.clear();
+  model.pointArrayRanges.seedFromHeader(header.pointDataArrays);
+  model.pointArrayHistograms.clear();
+  if (pointArray != nullptr && pointArray->GetName() != nullptr) {
+    addPointArray(model, pointArray);
+    model.recentlyUsedPointArrays.prepend(
+        QString::fromStdString(pointArray->GetName()));
+  }
+}
+
+bool VtuModelLoader::findChangedPointArrays(const VtuHeader &loadedHeader,
+                                            const VtuHeader &rewrittenHeader,
+                                            QStringList &changedPointArrays) {
+  changedPointArrays.clear();
+  // Pieces are not compared; partitioned files are always loaded again
+  if (loadedHeader.isPartitioned() || rewrittenHeader.isPartitioned() ||
+      loadedHeader.byteOrder != rewrittenHeader.byteOrder ||
+      loadedHeader.headerType != rewrittenHeader.headerType ||
+      loadedHeader.compressor != rewrittenHeader.compressor ||
+      loadedHeader.appendedEncoding != rewrittenHeader.appendedEncoding ||
+      loadedHeader.numberOfPoints != rewrittenHeader.numberOfPoints ||
+      loadedHeader.numberOfCells != rewrittenHeader.numberOfCells ||
+      !loadedHeader.points.declaresSameData(rewrittenHeader.points)) {
+    return false;
+  }
+  // Cell data is decoded with the mesh, and values rewritten in place keep
+  // their declared layout, so a file with cell data is loaded again
+  if (!loadedHeader.cellDataArrays.isEmpty() ||
+      !rewrittenHeader.cellDataArrays.isEmpty() ||
+      loadedHeader.pointDataArrays.isEmpty() ||
+      loadedHeader.cellArrays.size() != rewrittenHeader.cellArrays.size() ||
+      loadedHeader.pointDataArrays.size() !=
+          rewrittenHeader.pointDataArrays.size()) {
+    return false;
+  }
+  // Arrays are matched by name; writers may reorder them
+  for (const VtuDataArrayDescriptor &loaded : loadedHeader.cellArrays) {
+    const VtuDataArrayDescriptor *rewritten =
+        rewrittenHeader.findCellArray(loaded.name);
+    if (rewritten == nullptr || !loaded.declaresSameData(*rewritten)) {
+      return false;
+    }
+  }
+
+  for (const VtuDataArrayDescriptor &loaded : loadedHeader.pointDataArrays) {
+    const VtuDataArrayDescriptor *rewritten =
+        rewrittenHeader.findPointDataArray(loaded.name);
+    // The catalog of the model lists the arrays as they were loaded
+    if (rewritten == nullptr || loaded.type != rewritten->type ||
+        loaded.numberOfComponents != rewritten->numberOfComponents ||
+        loaded.componentNames != rewritten->componentNames) {
+      return false;
+    }
+    if (!loaded.declaresSameData(*rewritten)) {
+      changedPointArrays.push_back(loaded.name);
+    }
+  }
+
+  // Nothing declares a change, yet the file was rewritten: values were
+  // written in place, and any array may hold new ones
+  if (changedPointArrays.isEmpty()) {
+    for (const VtuDataArrayDescriptor &loaded :
+         loadedHeader.pointDataArrays) {
+      changedPointArrays.push_back(loaded.name);
+    }
+  }
+  return true;
+}
+
+bool VtuModelLoader::reloadChangedPointArrays(
+    LoadedVtuModel &model, const VtuHeader &header,
+    const QStringList &changedPointArrays, QString &errorMessage) {
+  PerfTrace::Scope scope("load", "Reload changed point arrays");
+  vtkPointData *pointData = model.grid->GetPointData();
+
+  // Decode every resident array first, so a failure changes nothing
+  QStringList residentArrays;
+  for (const QString &arrayName : changedPointArrays) {
+    if (pointData->GetArray(arrayName.toStdString().c_str()) != nullptr) {
+      residentArrays.push_back(arrayName);
+    }
+  }
+  const std::atomic_bool notCancelled(false);
+  QVector<vtkSmartPointer<vtkDataArray>> reloadedArrays;
+  if (!readPointArrays(model.filePath, header, residentArrays, nullptr,
+                       notCancelled, reloadedArrays, errorMessage)) {
+    return false;
+  }
+
+  for (const QString &arrayName : changedPointArrays) {
+    pointData->RemoveArray(arrayName.toStdString().c_str());
+    model.pointArrayRanges.remove(arrayName);
+    model.pointArrayHistograms.remove(arrayName);
+  }
+  model.header = header;
+  // Arrays mapped from a cache entry stay valid, but any array may now be
+  // decoded from the file again
+  model.mappedFromCache = false;
+  model.pointArrayRanges.seedFromHeader(header.pointDataArrays);
+  for (vtkDataArray *array : reloadedArrays) {
+    addPointArray(model, array);
+  }
+  // Arrays that were not resident are decoded on first use
+  for (const QString &arrayName : changedPointArrays) {
+    if (pointData->GetArray(arrayName.toStdString().c_str()) == nullptr) {
+      model.recentlyUsedPointArrays.removeAll(arrayName);
+    }
+  }
+  evictPointArrays(model);
+  return true;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid>
+VtuModelLoader::readGrid(const QString &filePath, const VtuHeader &header,
+                         const ProgressCallback &progressCallback,
+                         const std::atomic_bool &cancelRequested,
+                         QString &errorMessage, bool includePointData) {
+  // Pieces of partitioned files are read concurrently and merged; appended
+  // files are memory-mapped and decoded in parallel; any other layout goes
+  // through the VTK XML reader
+  if (header.isPartitioned()) {
+    PerfTrace::Scope readScope("load", "Read partitioned pieces");
+    return PvtuReader::readGrid(header, progressCallback, cancelRequested,
+                                errorMessage, includePointData);
+  }
+  if (VtuAppendedReader::canRead(header)) {
+    PerfTrace::Scope readScope("load", "Decode appended data");
+    VtuAppendedReader appendedReader(filePath, header);
+    if (!appendedReader.open(errorMessage)) {
+      return nullptr;
+    }
+    progressCallback(0.0, "Decoding mesh and point data");
+    vtkSmartPointer<vtkUnstructuredGrid> grid = appendedReader.readGrid(
+        progressCallback, cancelRequested, errorMessage, includePointData);
+    if (grid != nullptr || !appendedReader.hasUnsupportedLayout()) {
+      return grid;
+    }
+    errorMessage.clear();
+  }
+  PerfTrace::Scope readScope("load", "Read with XML reader");
+  return readGridWithXmlReader(filePath, progressCallback, cancelRequested,
+                               errorMessage, includePointData);
+}
+
+vtkSmartPointer<vtkDataArray>
+VtuModelLoader::readPointArray(const QString &filePath, const VtuHeader &header,
+                               const QString &arrayName,
+                               QString &errorMessage) {
+  if (header.isPartitioned()) {
+    return PvtuReader::readPointArray(header, arrayName, errorMessage);
+  }
+  const VtuDataArrayDescriptor *descriptor =
+      header.findPointDataArray(arrayName);
+  if (descriptor != nullptr && VtuAppendedReader::canRead(header)) {
+    // Direct offset read of this array only
+    VtuAppendedReader appendedReader(filePath, header);
+    if (!appendedReader.open(errorMessage)) {
+      return nullptr;
+    }
+    return appendedReader.readPointArray(*descriptor, errorMessage);
+  }
+  const std::atomic_bool notCancelled(false);
+  QVector<vtkSmartPointer<vtkDataArray>> arrays;
+  if (!readPointArraysWithXmlReader(filePath, {arrayName}, nullptr,
+                                    notCancelled, arrays, errorMessage)) {
+    return nullptr;
+  }
+  return arrays.first();
+}
+
+bool VtuModelLoader::readsPointArraysDirectly(const VtuHeader &header,
+                                              const QStringList &arrayNames) {
+  if (header.isPartitioned()) {
+    return true;
+  }
+  return VtuAppendedReader::canRead(header) &&
+         std::all_of(arrayNames.cbegin(), arrayNames.cend(),
+                     [&header](const QString &arrayName) {
+                       return header.findPointDataArray(arrayName) != nullptr;
+                     });
+}
+
+bool VtuModelLoader::readPointArrays(
+    const QString &filePath, const VtuHeader &header,
+    const QStringList &arrayNames, const ProgressCallback &progressCallback,
+    const std::atomic_bool &cancelRequested,
+    QVector<vtkSmartPointer<vtkDataArray>> &arrays, QString &errorMessage) {
+  PerfTrace::Scope scope("load", "Decode point arrays");
+  arrays.clear();
+  if (arrayNames.isEmpty()) {
+    return true;
+  }
+  if (!readsPointArraysDirectly(header, arrayNames)) {
+    return readPointArraysWithXmlReader(filePath, arrayNames,
+                                        progressCallback, cancelRequested,
+                                        arrays, errorMessage);
+  }
+
+  // Pieces and appended arrays are read by offset, one array at a time
+  for (int i = 0; i < arrayNames.size(); ++i) {
+    if (cancelRequested.load()) {
+      arrays.clear();
+      return false;
+    }
+    if (progressCallback) {
+      progressCallback(static_cast<double>(i) / arrayNames.size(),
+                       "Decoding point arrays");
+    }
+    vtkSmartPointer<vtkDataArray> array =
+        readPointArray(filePath, header, arrayNames[i], errorMessage);
+    if (array == nullptr) {
+      arrays.clear();
+      return false;
+    }
+    arrays.push_back(array);
+  }
+  return true;
+}
+
+LoadedVtuModel *VtuModelLoader::readModelCached(
+    const QString &filePath, const VtuLoadOptions &options,
+    const ProgressCallback &progressCallback,
+    const std::atomic_bool &cancelRequested, QString &errorMessage,
+    std::unique_ptr<DecodedModelSnapshot> &cacheSnapshot) {
+  if (options.decodedModelCacheDirectory.isEmpty()) {
+    return readModel(filePath, options, progressCallback, cancelRequested,
+                     errorMessage);
+  }
+
+  DecodedModelCache cache(options.decodedModelCacheDirectory,
+                          options.decodedModelCacheBudget);
+  if (progressCallback) {
+    progressCallback(0.0, "Opening cached model");
+  }
+  // A damaged entry is dropped by the cache and rewritten below
+  QString cacheErrorMessage;
+  if (LoadedVtuModel *cachedModel =
+          cache.open(filePath, options, cacheErrorMessage)) {
+    // Entries only hold the arrays that were decoded when they were written
+    QScopedPointer<LoadedVtuModel> model(cachedModel);
+    QVector<int> arrayIndices;
+    for (int i = 0; i < model->pointArraysInfo.size(); ++i) {
+      arrayIndices.push_back(i);
+    }
+    const QStringList arrayNames = missingPointArrays(*model, arrayIndices);
+    if (!options.lazyPointArrays && !arrayNames.isEmpty()) {
+      QVector<vtkSmartPointer<vtkDataArray>> arrays;
+      if (!readPointArrays(filePath, model->header, arrayNames,
+                           progressCallback, cancelRequested, arrays,
+                           errorMessage)) {
+        return nullptr;
+      }
+      for (vtkDataArray *array : arrays) {
+        addPointArray(*model, array);
       }
     }
-    file.close();
+    return model.take();
+  }
+
+  LoadedVtuModel *model = readModel(filePath, options, progressCallback,
+                                    cancelRequested, errorMessage);
+  if (model != nullptr) {
+    cacheSnapshot = std::make_unique<DecodedModelSnapshot>(
+        DecodedModelCache::snapshot(*model));
+  }
+  return model;
+}
+
+void VtuModelLoader::storeInCache(const VtuLoadOptions &options,
+                                  const DecodedModelSnapshot *cacheSnapshot,
+                                  const std::atomic_bool &cancelRequested) {
+  if (cacheSnapshot == nullptr || cancelRequested.load()) {
+    return;
+  }
+  // Caching is best effort: a failed write only means a slower next open
+  DecodedModelCache cache(options.decodedModelCacheDirectory,
+                          options.decodedModelCacheBudget);
+  QString errorMessage;
+  cache.store(*cacheSnapshot, cancelRequested, errorMessage);
+}
+
+vtkDataArray *VtuModelLoader::addPointArray(LoadedVtuModel &model,
+                                            vtkDataArray *array) {
+  // Exact ranges of all components and the magnitude, one parallel pass
+  model.pointArrayRanges.compute(array);
+  vtkPointData *pointData = model.grid->GetPointData();
+  if (array->GetName() != nullptr &&
+      model.options.float32.includesPointArray(array->GetName())) {
+    PerfTrace::Scope scope("load", "Convert to Float32");
+    if (vtkSmartPointer<vtkFloatArray> floatArray =
+            Float32Conversion::convert(array)) {
+      // Replaces a double array of the same name in place
+      pointData->AddArray(floatArray);
+      return floatArray;
+    }
+  }
+  if (pointData->GetArray(array->GetName()) != array) {
+    pointData->AddArray(array);
+  }
+  return array;
+}
+
+void VtuModelLoader::addDerivedPointArrays(
+    LoadedVtuModel &model,
+    const QVector<vtkSmartPointer<vtkDataArray>> &arrays) {
+  vtkPointData *pointData = model.grid->GetPointData();
+  for (vtkDataArray *array : arrays) {
+    const QString arrayName = QString::fromStdString(array->GetName());
+    model.pointArrayRanges.compute(array);
+    model.pointArrayHistograms.remove(arrayName);
+    pointData->AddArray(array);
+    if (!model.derivedPointArrays.contains(arrayName)) {
+      model.derivedPointArrays.push_back(arrayName);
+      model.pointArraysInfo.push_back(makePointArrayInfo(
+          arrayName, array->GetNumberOfComponents(), array, nullptr));
+    }
+  }
+}
+
+void VtuModelLoader::removeDerivedPointArrays(LoadedVtuModel &model) {
+  vtkPointData *pointData = model.grid->GetPointData();
+  for (const QString &arrayName : model.derivedPointArrays) {
+    pointData->RemoveArray(arrayName.toStdString().c_str());
+    model.pointArrayRanges.remove(arrayName);
+    model.pointArrayHistograms.remove(arrayName);
+    model.recentlyUsedPointArrays.removeAll(arrayName);
+  }
+  model.pointArraysInfo.erase(
+      std::remove_if(model.pointArraysInfo.begin(),
+                     model.pointArraysInfo.end(),
+                     [&model](const PointArrayInfo &arrayInfo) {
+                       return model.derivedPointArrays.contains(arrayInfo.name);
+                     }),
+      model.pointArraysInfo.end());
+  model.derivedPointArrays.clear();
+}
+
+void VtuModelLoader::setMemoryBudget(LoadedVtuModel &model,
+                                     qint64 memoryBudget) {
+  model.options.memoryBudget = memoryBudget;
+  evictPointArrays(model);
+}
+
+void VtuModelLoader::evictPointArrays(LoadedVtuModel &model) {
+  if (model.grid == nullptr || model.mappedFromCache ||
+      model.options.memoryBudget <= 0) {
+    return;
+  }
+  const ModelMemoryUsage usage = ModelMemoryUsage::measure(model);
+  qint64 totalBytes = usage.modelBytes();
+  if (totalBytes <= model.options.memoryBudget) {
+    return;
+  }
+
+  // Arrays never colored by (e.g. decoded eagerly) go first, then the least
+  // recently used ones; the most recently used array always stays resident
+  QList<QString> evictionOrder;
+  for (const QPair<QString, qint64> &pointArray : usage.pointArrays) {
+    if (!model.recentlyUsedPointArrays.contains(pointArray.first)) {
+      evictionOrder.push_back(pointArray.first);
+    }
+  }
+  for (int i = model.recentlyUsedPointArrays.size() - 1; i > 0; --i) {
+    evictionOrder.push_back(model.recentlyUsedPointArrays[i]);
+  }
+  for (const QString &arrayName : model.derivedPointArrays) {
+    evictionOrder.removeAll(arrayName);
+  }
+
+  vtkPointData *pointData = model.grid->GetPointData();
+  for (const QString &arrayName : evictionOrder) {
+    if (totalBytes <= model.options.memoryBudget) {
+      break;
+    }
+    const std::string name = arrayName.toStdString();
+    totalBytes -=
+        ModelMemoryUsage::arrayBytes(pointData->GetArray(name.c_str()));
+    pointData->RemoveArray(name.c_str());
+    model.recentlyUsedPointArrays.removeAll(arrayName);
+  }
+}
+
+QVector<PointArrayInfo>
+VtuModelLoader::catalogPointArrays(const VtuHeader &header) {
+  QVector<PointArrayInfo> pointArraysInfo;
+  for (const VtuDataArrayDescriptor &descriptor : header.pointDataArrays) {
+    if (descriptor.isNumeric() && !descriptor.name.isEmpty()) {
+      pointArraysInfo.push_back(makePointArrayInfo(
+          descriptor.name, descriptor.numberOfComponents, nullptr,
+          &descriptor));
+    }
+  }
+  return pointArraysInfo;
+}
+
+void VtuModelLoader::catalogCellArrays(LoadedVtuModel &model) {
+  model.cellArraysInfo.clear();
+  model.cellArrayRanges.clear();
+  model.cellArrayHistograms.clear();
+  model.cellToPointArrays.clear();
+  if (model.grid == nullptr) {
+    return;
+  }
+  model.cellArrayRanges.seedFromHeader(model.header.cellDataArrays);
+  vtkCellData *cellData = model.grid->GetCellData();
+  for (int i = 0; i < cellData->GetNumberOfArrays(); ++i) {
+    vtkDataArray *array = cellData->GetArray(i);
+    // Ghost flags of partitioned files are no field to color by
+    if (array == nullptr || array->GetName() == nullptr ||
+        std::strcmp(array->GetName(),
+                    vtkDataSetAttributes::GhostArrayName()) == 0) {
+      continue;
+    }
+    const QString arrayName = QString::fromStdString(array->GetName());
+    model.cellArraysInfo.push_back(makePointArrayInfo(
+        arrayName, array->GetNumberOfComponents(), array,
+        model.header.findCellDataArray(arrayName)));
+  }
+}
+
+bool VtuModelLoader::extractSurface(LoadedVtuModel &model,
+                                    const ProgressCallback &progressCallback,
+                                    const std::atomic_bool &cancelRequested,
+                                    QString &errorMessage) {
+  PerfTrace::Scope scope("load", "Extract surface");
+
+  // Extract from the bare structure so no point or cell data is copied
+  vtkNew<vtkUnstructuredGrid> structure;
+  structure->CopyStructure(model.grid);
+
+  // vtkGeometryFilter runs its unstructured grid path on the SMP thread pool
+  vtkNew<vtkGeometryFilter> geometryFilter;
+  geometryFilter->SetInputData(structure);
+  geometryFilter->MergingOff();
+  geometryFilter->PassThroughPointIdsOn();
+  geometryFilter->PassThroughCellIdsOn();
+
+  AlgorithmProgressContext progressContext{geometryFilter.GetPointer(),
+                                           &cancelRequested, progressCallback,
+                                           "Extracting surface"};
+  vtkNew<vtkCallbackCommand> progressCommand;
+  progressCommand->SetCallback(onAlgorithmProgress);
+  progressCommand->SetClientData(&progressContext);
+  geometryFilter->AddObserver(vtkCommand::ProgressEvent,
+                              progressCommand.GetPointer());
+
+  progressCallback(0.0, "Extracting surface");
+  geometryFilter->Update();
+  geometryFilter->RemoveObserver(progressCommand.GetPointer());
+  if (cancelRequested.load()) {
+    return false;
   }
 
+  vtkPolyData *output = geometryFilter->GetOutput();
+  vtkIdTypeArray *originalPointIds =
+      (output != nullptr)
+          ? vtkIdTypeArray::SafeDownCast(output->GetPointData()->GetArray(
+                geometryFilter->GetOriginalPointIdsName()))
+          : nullptr;
+  vtkIdTypeArray *originalCellIds =
+      (output != nullptr)
+          ? vtkIdTypeArray::SafeDownCast(output->GetCellData()->GetArray(
+                geometryFilter->GetOriginalCellIdsName()))
+          : nullptr;
+  if (originalPointIds == nullptr || originalCellIds == nullptr) {
+    errorMessage = "Failed to extract the model surface:\n" + model.filePath;
+    return false;
+  }
+
+  model.surfacePointIds = originalPointIds;
+  model.surfaceCellIds = originalCellIds;
+  model.surface = vtkSmartPointer<vtkPolyData>::New();
+  model.surface->CopyStructure(output);
+  return true;
+}
+
+LoadedVtuModel *
+VtuModelLoader::readModel(const QString &filePath,
+                          const VtuLoadOptions &options,
+                          const ProgressCallback &progressCallback,
+                          const std::atomic_bool &cancelRequested,
+                          QString &errorMessage) {
+  PerfTrace::Scope scope("load", "Load model");
+
+  // Forward only whole-percent changes to keep the receiver's queue light
+  int lastReportedPercent = -1;
+  auto reportProgress = [&progressCallback, &lastReportedPercent](
+                            double progress, const QString &stage) {
+    const int percent = static_cast<int>(progress * 100.0);
+    if (!progressCallback || percent == lastReportedPercent) {
+      return;
+    }
+    lastReportedPercent = percent;
+    progressCallback(progress, stage);
+  };
+
+  // Allocate a new model instance; ownership is transferred to the caller
+  QScopedPointer<LoadedVtuModel> outModel(new LoadedVtuModel());
+
+  // The header carries the array catalog; its scan stops before the payload
+  reportProgress(0.0, "Reading header");
+  {
+    PerfTrace::Scope scanScope("load", "Scan header");
+    if (!VtuHeaderScanner::scan(filePath, outModel->header, errorMessage)) {
+      return nullptr;
+    }
+  }
+  if (cancelRequested.load()) {
+    return nullptr;
+  }
+
+  outModel->grid =
+      readGrid(filePath, outModel->header, reportProgress, cancelRequested,
+               errorMessage, !options.lazyPointArrays);
+  if (outModel->grid == nullptr || cancelRequested.load()) {
+    return nullptr;
+  }
+
+  if (outModel->grid->GetNumberOfPoints() == 0) {
+    errorMessage = "Failed to read VTU file (no points):\n" + filePath;
+    return nullptr;
+  }
+
+  outModel->filePath = filePath;
+  outModel->options = options;
+
+  if (options.float32.points) {
+    PerfTrace::Scope convertScope("load", "Convert to Float32");
+    vtkPoints *points = outModel->grid->GetPoints();
+    if (vtkSmartPointer<vtkFloatArray> floatPoints =
+            Float32Conversion::convert(points->GetData())) {
+      points->SetData(floatPoints);
+    }
+  }
+
+  // Only the exterior surface is rendered; extract it once here so that
+  // recoloring never runs geometry extraction again
+  if (!extractSurface(*outModel, reportProgress, cancelRequested,
+                      errorMessage)) {
+    return nullptr;
+  }
+
+  // Cell arrays are always decoded with the mesh
+  catalogCellArrays(*outModel);
+
+  // Array catalog: decoded arrays in eager mode, header descriptors in lazy
+  // mode (their data is decoded on first use)
+  outModel->pointArrayRanges.seedFromHeader(outModel->header.pointDataArrays);
+  if (options.lazyPointArrays) {
+    outModel->pointArraysInfo = catalogPointArrays(outModel->header);
+    return outModel.take();
+  }
+
+  PerfTrace::Scope rangesScope("load", "Compute ranges");
   vtkPointData *pointData = outModel->grid->GetPointData();
   if (pointData != nullptr) {
     const int numArrays = pointData->GetNumberOfArrays();
@@ -78,47 +928,19 @@ void VtuModelLoader::load(const QString &filePath) {
       if (arr == nullptr || arr->GetName() == nullptr) {
         continue;
       }
-      int numberOfComponents = arr->GetNumberOfComponents();
-      QString arrayName = QString::fromStdString(arr->GetName());
-
-      QVector<QString> componentNames;
-
-      // For multi-component arrays, add "Magnitude" as first option (maps to
-      // componentIndex -1)
-      if (numberOfComponents > 1) {
-        componentNames.push_back("Magnitude");
-      }
-
-      // Use component names from XML if available, otherwise try VTK, otherwise
-      // default
-      QVector<QString> xmlComponentNames = arrayComponentNames.value(arrayName);
-      for (int j = 0; j < numberOfComponents; ++j) {
-        QString componentName;
-        if (j < xmlComponentNames.size()) {
-          // Use name from XML
-          componentName = xmlComponentNames[j];
-        } else {
-          // Try VTK's GetComponentName
-          const char *vtkComponentName = arr->GetComponentName(j);
-          if (vtkComponentName != nullptr) {
-            componentName = QString::fromStdString(vtkComponentName);
-          } else {
-            // Default naming
-            if (numberOfComponents == 1) {
-              componentName = "Magnitude";
-            } else {
-              componentName = QString("Component %1").arg(j);
-            }
-          }
-        }
-        componentNames.push_back(componentName);
+      if (cancelRequested.load()) {
+        return nullptr;
       }
-      outModel->pointArraysInfo.push_back(PointArrayInfo(
-          arrayName, QVector<QString>::fromVector(componentNames)));
+      const QString arrayName = QString::fromStdString(arr->GetName());
+      reportProgress(static_cast<double>(i) / numArrays, "Computing ranges");
+      arr = addPointArray(*outModel, arr);
+      outModel->pointArraysInfo.push_back(
+          makePointArrayInfo(arrayName, arr->GetNumberOfComponents(), arr,
+                             outModel->header.findPointDataArray(arrayName)));
     }
   }
 
-  emit modelLoaded(outModel.take(), filePath);
+  return outModel.take();
 }
 
 // Helper functions for component index mapping and name retrieval
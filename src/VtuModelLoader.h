@@ -1,29 +1,208 @@
 ﻿#ifndef VTU_MODEL_LOADER_H
 #define VTU_MODEL_LOADER_H
 
+#include <QList>
 #include <QObject>
 #include <QString>
+#include <QStringList>
 
+#include <vtkDataArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
 #include <vtkUnstructuredGrid.h>
 
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "ArrayHistogram.h"
+#include "ArrayRangeCache.h"
+#include "CellToPointCache.h"
+#include "Float32Conversion.h"
+#include "LatestRequestWorker.h"
 #include "PointArrayInfo.h"
+#include "VtuHeaderScanner.h"
+
+struct DecodedModelSnapshot;
+
+struct VtuLoadOptions {
+  // Load geometry, topology and the array catalog only; point arrays are
+  // decoded by VtuModelLoader::ensurePointArrayLoaded on first use
+  bool lazyPointArrays = false;
+  // Upper bound for the resident model (mesh, surface and point arrays, see
+  // ModelMemoryUsage) in bytes; least recently used point arrays are evicted
+  // beyond it and decoded again on their next use (0 keeps every array)
+  qint64 memoryBudget = 0;
+  // Float64 point coordinates and point arrays converted to Float32 once
+  // decoded, halving their memory and GPU upload size. Ranges are computed
+  // from the double values first, so the scalar bar stays exact.
+  Float32Selection float32;
+  // Directory of the decoded model cache; empty disables it. Unchanged files
+  // open from their cache entry, other files are written to the cache after
+  // loading (on the loading thread, once the model has been delivered).
+  QString decodedModelCacheDirectory;
+  qint64 decodedModelCacheBudget = 0; // Bytes; 0 keeps every entry
+};
 
 struct LoadedVtuModel {
   vtkSmartPointer<vtkUnstructuredGrid> grid;
   QVector<PointArrayInfo> pointArraysInfo;
+  VtuHeader header;
+  ArrayRangeCache pointArrayRanges;
+  ArrayHistogramCache pointArrayHistograms; // Computed on first selection
+
+  /* Rendered surface */
+  // Exterior surface extracted once at load time (structure only) and, per
+  // surface point and cell, the id of the grid point or cell it was taken
+  // from
+  vtkSmartPointer<vtkPolyData> surface;
+  vtkSmartPointer<vtkIdTypeArray> surfacePointIds;
+  vtkSmartPointer<vtkIdTypeArray> surfaceCellIds;
+
+  /* Cell arrays */
+  // Numeric cell data arrays; they are decoded with the mesh and stay
+  // resident
+  QVector<PointArrayInfo> cellArraysInfo;
+  ArrayRangeCache cellArrayRanges;
+  ArrayHistogramCache cellArrayHistograms;
+  CellToPointCache cellToPointArrays; // Computed on first use
+
+  /* Lazy point arrays */
+  QString filePath;
+  VtuLoadOptions options;
+  QList<QString> recentlyUsedPointArrays; // Most recently used first
+  // Arrays are mapped from a decoded model cache entry; they cost no memory
+  // until touched, so they are never evicted
+  bool mappedFromCache = false;
+  // Point arrays computed after loading (e.g. comparison fields); they
+  // cannot be decoded again, so they are never evicted
+  QStringList derivedPointArrays;
 };
 
 class VtuModelLoader : public QObject {
   Q_OBJECT
 
 public:
+  // Receives overall progress in [0, 1] and a short description of the stage
+  using ProgressCallback =
+      std::function<void(double progress, const QString &stage)>;
+
   explicit VtuModelLoader(QObject *parent = nullptr);
+  ~VtuModelLoader() override;
+
+  // Loads on the calling thread; signals are emitted before returning
   void load(const QString &filePath);
 
+  // Loads on a worker thread; signals are delivered on the loader's thread.
+  // Starting a new load cancels the one in progress.
+  void loadAsync(const QString &filePath);
+  void cancel(); // Cancels the load and the point array decode
+  bool isLoading() const;
+
+  // Decodes point arrays of a lazily loaded model on a worker thread,
+  // reporting progress like a load; the arrays are delivered by
+  // pointArraysDecoded. Starting a new decode cancels the one in progress.
+  void decodePointArraysAsync(const LoadedVtuModel &model,
+                              const QStringList &arrayNames);
+  void cancelPointArrayDecode();
+
+  // Options apply to loads started afterwards
+  void setLoadOptions(const VtuLoadOptions &options);
+  const VtuLoadOptions &loadOptions() const;
+
+  // Makes sure the point array is present in model.grid, decoding it if the
+  // model was loaded lazily, and enforces the model's point array budget
+  static bool ensurePointArrayLoaded(LoadedVtuModel &model, int arrayIndex,
+                                     QString &errorMessage);
+
+  // Names of the point arrays among arrayIndices that are not in model.grid
+  static QStringList missingPointArrays(const LoadedVtuModel &model,
+                                        const QVector<int> &arrayIndices);
+
+  // Adds point arrays decoded for the model as its most recently used ones.
+  // The budget is enforced by the next ensurePointArrayLoaded, so arrays
+  // decoded together stay resident until they are used.
+  static void installPointArrays(
+      LoadedVtuModel &model,
+      const QVector<vtkSmartPointer<vtkDataArray>> &arrays);
+
+  // Adds computed point arrays to the model's point data and catalog, or
+  // removes every such array again
+  static void addDerivedPointArrays(
+      LoadedVtuModel &model,
+      const QVector<vtkSmartPointer<vtkDataArray>> &arrays);
+  static void removeDerivedPointArrays(LoadedVtuModel &model);
+
+  // Changes the model's memory budget and evicts arrays beyond it
+  static void setMemoryBudget(LoadedVtuModel &model, qint64 memoryBudget);
+
+  // Points a model at another file with the same mesh (e.g. the next time
+  // step): its point arrays are dropped, the given already decoded array is
+  // installed and any other array is decoded from the new file on first use
+  static void switchPointDataFile(LoadedVtuModel &model,
+                                  const QString &filePath,
+                                  const VtuHeader &header,
+                                  vtkDataArray *pointArray);
+
+  // Compares the header of a rewritten file with the one the model was
+  // loaded from, matching arrays by name. Returns false unless the mesh and
+  // the set of point arrays are declared unchanged and there is no cell data
+  // (the file then has to be loaded again); otherwise lists the point arrays
+  // whose declared data changed, or every point array if none did.
+  static bool findChangedPointArrays(const VtuHeader &loadedHeader,
+                                     const VtuHeader &rewrittenHeader,
+                                     QStringList &changedPointArrays);
+
+  // Points a model at the rewritten version of its file, keeping the mesh,
+  // the unchanged point arrays and their caches. Changed arrays that are
+  // resident are decoded again right away, the others on first use. The
+  // model is left untouched on failure.
+  static bool reloadChangedPointArrays(LoadedVtuModel &model,
+                                       const VtuHeader &header,
+                                       const QStringList &changedPointArrays,
+                                       QString &errorMessage);
+
+  // Catalog of the numeric point arrays the header declares, as lazily
+  // loaded models list them
+  static QVector<PointArrayInfo> catalogPointArrays(const VtuHeader &header);
+
+  // Lists the numeric cell data arrays of model.grid in model.cellArraysInfo
+  // and seeds their ranges from the header
+  static void catalogCellArrays(LoadedVtuModel &model);
+
+  // Reads the grid of a file whose header was already scanned: partitioned
+  // files piece by piece, appended files with VtuAppendedReader and anything
+  // else with the VTK XML reader. Returns nullptr on failure (errorMessage
+  // set) or cancellation (empty).
+  static vtkSmartPointer<vtkUnstructuredGrid>
+  readGrid(const QString &filePath, const VtuHeader &header,
+           const ProgressCallback &progressCallback,
+           const std::atomic_bool &cancelRequested, QString &errorMessage,
+           bool includePointData);
+
+  // Decodes a single point array of a file whose header was already scanned
+  static vtkSmartPointer<vtkDataArray>
+  readPointArray(const QString &filePath, const VtuHeader &header,
+                 const QString &arrayName, QString &errorMessage);
+
+  // Whether the point arrays are read by offset, one at a time, rather than
+  // by the XML reader, which parses the whole file for every read
+  static bool readsPointArraysDirectly(const VtuHeader &header,
+                                       const QStringList &arrayNames);
+
+  // Decodes several point arrays; files left to the XML reader are read in
+  // a single pass for all of them. Returns false on failure (errorMessage
+  // set) or cancellation (empty).
+  static bool readPointArrays(const QString &filePath, const VtuHeader &header,
+                              const QStringList &arrayNames,
+                              const ProgressCallback &progressCallback,
+                              const std::atomic_bool &cancelRequested,
+                              QVector<vtkSmartPointer<vtkDataArray>> &arrays,
+                              QString &errorMessage);
+
   // Helper functions for component index mapping and name retrieval
   // These work with the componentNames structure created by load()
   static int comboIndexToVtkIndex(const PointArrayInfo &arrayInfo, int comboIndex);
@@ -35,6 +214,56 @@ public:
 signals:
   void modelLoaded(LoadedVtuModel *model, const QString &modelFilePath);
   void modelLoadingErrorOccured(const QString &errorMessage);
+  void modelLoadingProgressChanged(double progress, const QString &stage);
+  void modelLoadingCancelled(const QString &modelFilePath);
+  void pointArraysDecoded(const QString &modelFilePath,
+                          const QVector<vtkSmartPointer<vtkDataArray>> &arrays);
+  void pointArrayDecodingFailed(const QString &errorMessage);
+  void pointArrayDecodingCancelled();
+
+private:
+  // Returns nullptr on failure (errorMessage set) or cancellation (empty)
+  static LoadedVtuModel *readModel(const QString &filePath,
+                                   const VtuLoadOptions &options,
+                                   const ProgressCallback &progressCallback,
+                                   const std::atomic_bool &cancelRequested,
+                                   QString &errorMessage);
+
+  // Opens the file's decoded model cache entry if there is one, otherwise
+  // reads the file and, with the cache enabled, returns the snapshot to
+  // store once the model has been delivered
+  static LoadedVtuModel *
+  readModelCached(const QString &filePath, const VtuLoadOptions &options,
+                  const ProgressCallback &progressCallback,
+                  const std::atomic_bool &cancelRequested,
+                  QString &errorMessage,
+                  std::unique_ptr<DecodedModelSnapshot> &cacheSnapshot);
+  static void storeInCache(const VtuLoadOptions &options,
+                           const DecodedModelSnapshot *cacheSnapshot,
+                           const std::atomic_bool &cancelRequested);
+
+  // Computes the ranges of a decoded point array, converts it to Float32 if
+  // the model's options select it and adds it to the model's point data
+  static vtkDataArray *addPointArray(LoadedVtuModel &model,
+                                     vtkDataArray *array);
+  static void evictPointArrays(LoadedVtuModel &model);
+
+  // Extracts the exterior surface of model.grid into model.surface,
+  // model.surfacePointIds and model.surfaceCellIds
+  static bool extractSurface(LoadedVtuModel &model,
+                             const ProgressCallback &progressCallback,
+                             const std::atomic_bool &cancelRequested,
+                             QString &errorMessage);
+
+private:
+  VtuLoadOptions options;
+  // Set until the latest load is delivered; its job keeps running after
+  // that while it writes the cache entry
+  bool loading = false;
+  LatestRequestWorker worker{LatestRequestWorker::Policy::CancelRunning};
+  // Point array decodes run beside loads, so they do not cancel each other
+  LatestRequestWorker decodeWorker{
+      LatestRequestWorker::Policy::CancelRunning};
 };
 
 #endif
@@ -0,0 +1,196 @@
+#include "VtuTimeSeries.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QXmlStreamReader>
+
+#include <algorithm>
+#include <numeric>
+
+#include "PerfTrace.h"
+#include "VtuHeaderScanner.h"
+
+namespace {
+// Captures prefix, step number and extension of e.g. "run_0042.vtu"
+const QRegularExpression numberedFilePattern(
+    "^(.*?)(\\d+)(\\.vtu)$", QRegularExpression::CaseInsensitiveOption);
+
+QStringList numberedSiblings(const QFileInfo &fileInfo, QString &prefix,
+                             QString &extension) {
+  const QRegularExpressionMatch match =
+      numberedFilePattern.match(fileInfo.fileName());
+  if (!match.hasMatch()) {
+    return QStringList();
+  }
+  prefix = match.captured(1);
+  extension = match.captured(3);
+  const QRegularExpression siblingPattern(
+      "^" + QRegularExpression::escape(prefix) + "(\\d+)" +
+          QRegularExpression::escape(extension) + "$",
+      QRegularExpression::CaseInsensitiveOption);
+
+  QStringList siblings;
+  const QStringList candidates =
+      fileInfo.dir().entryList({prefix + "*" + extension}, QDir::Files);
+  for (const QString &candidate : candidates) {
+    if (siblingPattern.match(candidate).hasMatch()) {
+      siblings.push_back(candidate);
+    }
+  }
+  return siblings;
+}
+
+QString normalizedPath(const QString &filePath) {
+  return QDir::cleanPath(QFileInfo(filePath).absoluteFilePath());
+}
+
+// Whether every file declares the point and cell counts of the first one.
+// Only the headers are scanned; unreadable files share nothing.
+bool shareMeshCounts(const QVector<QString> &filePaths) {
+  PerfTrace::Scope scope("load", "Match numbered steps");
+  VtuHeader first;
+  QString errorMessage;
+  for (const QString &filePath : filePaths) {
+    VtuHeader header;
+    if (!VtuHeaderScanner::scan(filePath, header, errorMessage)) {
+      return false;
+    }
+    if (filePath == filePaths.first()) {
+      first = header;
+    } else if (header.numberOfPoints != first.numberOfPoints ||
+               header.numberOfCells != first.numberOfCells) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+int VtuTimeSeries::indexOf(const QString &filePath) const {
+  return filePaths.indexOf(normalizedPath(filePath));
+}
+
+bool VtuTimeSeries::isTimeSeriesPath(const QString &filePath) {
+  const QFileInfo fileInfo(filePath);
+  if (fileInfo.suffix().compare("pvd", Qt::CaseInsensitive) == 0) {
+    return true;
+  }
+  QString prefix;
+  QString extension;
+  return numberedSiblings(fileInfo, prefix, extension).size() > 1;
+}
+
+bool VtuTimeSeries::open(const QString &filePath, VtuTimeSeries &series,
+                         QString &errorMessage) {
+  series = VtuTimeSeries();
+  if (QFileInfo(filePath).suffix().compare("pvd", Qt::CaseInsensitive) != 0) {
+    return collectNumberedFiles(filePath, series, errorMessage);
+  }
+  if (!readCollection(filePath, series, errorMessage)) {
+    return false;
+  }
+  if (series.isEmpty()) {
+    errorMessage = "Time series has no steps:\n" + filePath;
+    return false;
+  }
+  return true;
+}
+
+bool VtuTimeSeries::readCollection(const QString &filePath,
+                                   VtuTimeSeries &series,
+                                   QString &errorMessage) {
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    errorMessage = "Failed to open PVD file:\n" + filePath;
+    return false;
+  }
+
+  // Only the first part is used; every step must be a .vtu or .pvtu file
+  struct Step {
+    double time;
+    QString filePath;
+  };
+  QVector<Step> steps;
+  QString firstPart;
+  const QDir baseDir = QFileInfo(filePath).dir();
+  QXmlStreamReader xml(&file);
+  while (xml.readNextStartElement()) {
+    const QStringView name = xml.name();
+    if (name == QLatin1String("VTKFile") ||
+        name == QLatin1String("Collection")) {
+      continue; // Descend
+    }
+    if (name == QLatin1String("DataSet")) {
+      const QXmlStreamAttributes attrs = xml.attributes();
+      const QString part = attrs.value("part").toString();
+      if (steps.isEmpty()) {
+        firstPart = part;
+      }
+      const QString stepFile = attrs.value("file").toString();
+      if (part == firstPart && !stepFile.isEmpty()) {
+        bool ok = false;
+        const double time = attrs.value("timestep").trimmed().toDouble(&ok);
+        steps.push_back(
+            {ok ? time : static_cast<double>(steps.size()),
+             normalizedPath(baseDir.absoluteFilePath(stepFile))});
+      }
+    }
+    xml.skipCurrentElement();
+  }
+  if (xml.hasError()) {
+    errorMessage = QString("Failed to parse PVD file:\n%1\n%2")
+                       .arg(filePath, xml.errorString());
+    return false;
+  }
+
+  std::stable_sort(steps.begin(), steps.end(),
+                   [](const Step &a, const Step &b) { return a.time < b.time; });
+  for (const Step &step : steps) {
+    series.filePaths.push_back(step.filePath);
+    series.times.push_back(step.time);
+  }
+  return true;
+}
+
+bool VtuTimeSeries::collectNumberedFiles(const QString &filePath,
+                                         VtuTimeSeries &series,
+                                         QString &errorMessage) {
+  const QFileInfo fileInfo(filePath);
+  QString prefix;
+  QString extension;
+  const QStringList siblings = numberedSiblings(fileInfo, prefix, extension);
+  if (siblings.isEmpty()) {
+    errorMessage = "File name has no step number:\n" + filePath;
+    return false;
+  }
+
+  // Order by step number, not by name, so unpadded numbers sort correctly
+  QVector<qint64> stepNumbers;
+  for (const QString &sibling : siblings) {
+    stepNumbers.push_back(
+        sibling.mid(prefix.size(), sibling.size() - prefix.size() -
+                                       extension.size())
+            .toLongLong());
+  }
+  QVector<int> order(siblings.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&stepNumbers](int a, int b) {
+    return stepNumbers[a] < stepNumbers[b];
+  });
+  QVector<QString> filePaths;
+  QVector<double> times;
+  for (int index : order) {
+    filePaths.push_back(
+        normalizedPath(fileInfo.dir().absoluteFilePath(siblings[index])));
+    times.push_back(static_cast<double>(stepNumbers[index]));
+  }
+
+  // Files that merely follow the same name pattern are no series
+  if (siblings.size() > 1 && shareMeshCounts(filePaths)) {
+    series.filePaths = filePaths;
+    series.times = times;
+  }
+  return true;
+}
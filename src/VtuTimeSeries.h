@@ -0,0 +1,36 @@
+#ifndef VTU_TIME_SERIES_H
+#define VTU_TIME_SERIES_H
+
+#include <QString>
+#include <QVector>
+
+// Ordered .vtu steps of a transient run that share one mesh
+struct VtuTimeSeries {
+  QVector<QString> filePaths;
+  QVector<double> times;
+
+  int size() const { return filePaths.size(); }
+  bool isEmpty() const { return filePaths.isEmpty(); }
+  // Step of the file, or -1 if it is not part of the series
+  int indexOf(const QString &filePath) const;
+
+  // Whether the path names a .pvd collection or a numbered .vtu with
+  // numbered siblings (e.g. run_0000.vtu, run_0001.vtu, ...)
+  static bool isTimeSeriesPath(const QString &filePath);
+
+  // Reads a .pvd collection or collects the numbered siblings of a .vtu.
+  // Numbered siblings only form a series when every header declares the
+  // point and cell counts of the given file; otherwise series is left empty
+  // and the file opens on its own. A .pvd groups steps explicitly.
+  static bool open(const QString &filePath, VtuTimeSeries &series,
+                   QString &errorMessage);
+
+private:
+  static bool readCollection(const QString &filePath, VtuTimeSeries &series,
+                             QString &errorMessage);
+  static bool collectNumberedFiles(const QString &filePath,
+                                   VtuTimeSeries &series,
+                                   QString &errorMessage);
+};
+
+#endif // VTU_TIME_SERIES_H